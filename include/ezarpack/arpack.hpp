@@ -15,6 +15,8 @@
 /// and their C++ wrappers.
 #pragma once
 
+#include <atomic>
+
 #include "common.hpp"
 
 namespace ezarpack {
@@ -442,4 +444,29 @@ inline void eupd(int rvec,
 
 } // namespace f77
 
+/// @internal Storage of the flag set by set_arpack_reentrant().
+inline std::atomic<bool>& arpack_reentrant_flag() {
+  static std::atomic<bool> flag(false);
+  return flag;
+}
+
+/// @brief Declares whether the linked ARPACK-NG library is reentrant.
+///
+/// Reference ARPACK-NG subroutines keep parts of their state in `SAVE`d
+/// variables between two Reverse Communication Interface calls. For this
+/// reason, two eigenproblems may not be solved simultaneously in one process
+/// (neither from different threads nor by interleaving RCI calls in a single
+/// thread), and facilities that would do so, such as @ref batch_solver, fall
+/// back to solving one eigenproblem at a time. Users linking against an
+/// ARPACK-NG build free of such state can lift this restriction by calling
+/// this function with `true` before starting any solves.
+///
+/// @param reentrant Whether ARPACK-NG is reentrant.
+inline void set_arpack_reentrant(bool reentrant) {
+  arpack_reentrant_flag().store(reentrant);
+}
+
+/// Returns the value set by set_arpack_reentrant(), `false` by default.
+inline bool arpack_reentrant() { return arpack_reentrant_flag().load(); }
+
 } // namespace ezarpack
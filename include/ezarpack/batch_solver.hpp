@@ -0,0 +1,152 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/batch_solver.hpp
+/// @brief Driver solving many independent eigenproblems of the same dimension.
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "arpack_solver.hpp"
+#include "thread_pool.hpp"
+
+namespace ezarpack {
+
+/// @brief Driver solving a batch of independent eigenproblems of the same
+/// dimension, such as a family of Hamiltonians parametrized by a momentum
+/// point.
+///
+/// The driver owns a @ref thread_pool and a set of `arpack_solver` objects.
+/// The solver objects are recycled from one eigenproblem to the next one, so
+/// that their working arrays are allocated only once per batch driver.
+///
+/// By default, the eigenproblems are solved one after another, and the pool
+/// executes parallel loops of the linear operators within each solve (see
+/// @ref parallel_context). This is the only safe mode with a reference build
+/// of ARPACK-NG: Its Reverse Communication Interface subroutines keep the state
+/// of a solve in `SAVE`d variables from one call to the next, so that
+/// interleaving calls made for different eigenproblems would corrupt this
+/// state even if every single call were serialized.
+///
+/// If ARPACK-NG has been declared reentrant with set_arpack_reentrant(), the
+/// eigenproblems are solved concurrently, one per thread of the pool, and each
+/// Reverse Communication Interface loop runs entirely in its thread.
+///
+/// @tparam OpKind Kind of eigenproblems to be solved.
+/// @tparam Backend Storage backend used by the solver objects.
+template<operator_kind OpKind, typename Backend> class batch_solver {
+public:
+  /// Type of the recycled solver objects.
+  using solver_t = arpack_solver<OpKind, Backend>;
+
+private:
+  unsigned int N_;   // Dimension of the eigenproblems
+  thread_pool pool_; // Thread pool
+
+  // Solver objects created so far
+  std::vector<std::unique_ptr<solver_t>> solvers_;
+  // Solver objects that are not used by any eigenproblem at the moment
+  std::vector<solver_t*> idle_solvers_;
+  std::mutex solvers_mutex_;
+
+public:
+  /// Constructs a batch driver.
+  /// @param N Dimension of the eigenproblems.
+  /// @param n_threads Number of threads in the pool, including the thread
+  /// calling @ref operator()(). A non-positive value stands for
+  /// `std::thread::hardware_concurrency()`.
+  explicit batch_solver(unsigned int N, int n_threads = 0)
+      : N_(N), pool_(n_threads) {}
+
+  batch_solver(batch_solver const&) = delete;
+  batch_solver& operator=(batch_solver const&) = delete;
+
+  /// Dimension of the eigenproblems.
+  unsigned int dim() const { return N_; }
+
+  /// Number of threads in the pool.
+  int n_threads() const { return pool_.size(); }
+
+  /// Number of solver objects created so far.
+  int n_solvers() const { return int(solvers_.size()); }
+
+  /// @brief Solves a batch of eigenproblems.
+  ///
+  /// For each `i` in `[0; n_problems)`, `solve_f(i, solver)` is called with
+  /// a recycled solver object. It is expected to run the solver on the `i`-th
+  /// eigenproblem. Then, `result_f(i, solver)` is called to extract results
+  /// from the solver object before it is reused. Both calls are made in the
+  /// same thread. Calls for different eigenproblems are concurrent only if
+  /// ARPACK-NG has been declared reentrant, see set_arpack_reentrant().
+  ///
+  /// If some of the calls throw, the first caught exception is rethrown after
+  /// all other eigenproblems have been processed.
+  ///
+  /// @param n_problems Number of eigenproblems in the batch.
+  /// @param solve_f Callable object with signature
+  /// `void(int i, solver_t & solver)`.
+  /// @param result_f Callable object with signature
+  /// `void(int i, solver_t const& solver)`.
+  template<typename SolveF, typename ResultF>
+  void operator()(int n_problems, SolveF&& solve_f, ResultF&& result_f) {
+    auto task = [&](int i) {
+      solver_t& solver = acquire_solver();
+      try {
+        solve_f(i, solver);
+        result_f(i, static_cast<solver_t const&>(solver));
+      } catch(...) {
+        release_solver(solver);
+        throw;
+      }
+      release_solver(solver);
+    };
+
+    if(arpack_reentrant()) {
+      pool_.run(n_problems, task);
+    } else {
+      parallel_context context(&pool_);
+      std::exception_ptr error;
+      for(int i = 0; i < n_problems; ++i) {
+        try {
+          task(i);
+        } catch(...) {
+          if(!error) error = std::current_exception();
+        }
+      }
+      if(error) std::rethrow_exception(error);
+    }
+  }
+
+private:
+  /// @internal Take an idle solver object or create a new one.
+  solver_t& acquire_solver() {
+    std::lock_guard<std::mutex> lock(solvers_mutex_);
+    if(idle_solvers_.empty()) {
+      solvers_.emplace_back(new solver_t(N_));
+      return *solvers_.back();
+    }
+    solver_t* solver = idle_solvers_.back();
+    idle_solvers_.pop_back();
+    return *solver;
+  }
+
+  /// @internal Return a solver object to the list of idle ones.
+  void release_solver(solver_t& solver) {
+    std::lock_guard<std::mutex> lock(solvers_mutex_);
+    idle_solvers_.push_back(&solver);
+  }
+};
+
+} // namespace ezarpack
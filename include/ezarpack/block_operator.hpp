@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/block_operator.hpp
+/// @brief Adaptor for linear operators that can act on blocks of vectors.
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+namespace ezarpack {
+
+/// @brief Adaptor for callable objects that apply a linear operator to
+/// a block of vectors at once.
+///
+/// The adapted callable `f` is invoked as `f(in, out, k)`, where `in` and `out`
+/// are storage-specific vector views of length `k * n`. They expose
+/// column-major `n x k` blocks (`n` being the dimension of the eigenproblem or
+/// the size of the MPI rank-local block) of input vectors
+/// @f$ \mathbf{x}_1, \ldots, \mathbf{x}_k @f$ and of output vectors
+/// @f$ \mathbf{y}_1, \ldots, \mathbf{y}_k @f$ respectively.
+///
+/// An adapted object can be passed wherever `arpack_solver` accepts
+/// a linear operator. The Reverse Communication Interface of ARPACK-NG
+/// requests one vector at a time, so such calls are made with `k = 1`.
+/// Post-processing steps that apply the operator to many independent vectors,
+/// such as
+/// ezarpack::arpack_solver<Asymmetric, Backend>::eigenvalues(A &&) const,
+/// do so in a single call with `k > 1`. This is beneficial for operators that
+/// are limited by memory bandwidth, e.g. sparse matrices.
+///
+/// @tparam F Type of the adapted callable object.
+template<typename F> class block_operator {
+  F f;
+
+public:
+  /// Constructs an adaptor object.
+  /// @param f Callable object to adapt.
+  explicit block_operator(F f) : f(std::move(f)) {}
+
+  /// Applies the linear operator to a single vector.
+  /// @param in View of the input vector.
+  /// @param out View of the output vector.
+  template<typename In, typename Out>
+  void operator()(In&& in, Out&& out) const {
+    f(std::forward<In>(in), std::forward<Out>(out), 1);
+  }
+
+  /// Applies the linear operator to a block of vectors.
+  /// @param in View of the input block.
+  /// @param out View of the output block.
+  /// @param k Number of vectors in the block.
+  template<typename In, typename Out>
+  void operator()(In&& in, Out&& out, int k) const {
+    f(std::forward<In>(in), std::forward<Out>(out), k);
+  }
+};
+
+/// Makes a @ref block_operator adaptor object.
+/// @param f Callable object to adapt.
+template<typename F>
+block_operator<typename std::decay<F>::type> make_block_operator(F&& f) {
+  return block_operator<typename std::decay<F>::type>(std::forward<F>(f));
+}
+
+/// Detects @ref block_operator types.
+template<typename T> struct is_block_operator : std::false_type {};
+template<typename F>
+struct is_block_operator<block_operator<F>> : std::true_type {};
+
+} // namespace ezarpack
@@ -0,0 +1,137 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/cancellation.hpp
+/// @brief Cooperative cancellation and wall-clock deadlines of solves.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+#include "common.hpp"
+
+namespace ezarpack {
+
+/// @brief Shared flag used to request cancellation of solves.
+///
+/// Copies of a token share the same flag, so that a solve running with one
+/// copy can be cancelled from any thread through another copy.
+class cancellation_token {
+  std::shared_ptr<std::atomic<bool>> flag_;
+
+public:
+  /// Constructs a new token that has not been cancelled.
+  cancellation_token() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+  /// Requests cancellation of all solves using this token.
+  void cancel() const { flag_->store(true, std::memory_order_relaxed); }
+
+  /// Has cancellation been requested?
+  bool cancelled() const { return flag_->load(std::memory_order_relaxed); }
+
+  /// Withdraws the cancellation request, so that the token can be reused.
+  void reset() const { flag_->store(false, std::memory_order_relaxed); }
+};
+
+/// What a solver does when a solve is interrupted.
+enum interruption_mode {
+  ThrowOnInterruption, /**< Throw ezarpack::solve_interrupted right away. */
+  PartialResults       /**< Stop the iteration as soon as the current
+                            Lanczos/Arnoldi factorization has been
+                            extended, and compute the Ritz pairs that have
+                            converged at that point. This takes at most
+                            @f$ ncv @f$ further applications of
+                            @f$ \hat O @f$. */
+};
+
+/// Conditions under which a solve is interrupted before it converges.
+///
+/// The conditions are checked every time ARPACK-NG's Reverse Communication
+/// Interface returns control to the solver.
+struct interruption_policy {
+  /// Type of clock used to measure deadlines and time limits.
+  using clock = std::chrono::steady_clock;
+
+  /// Cancellation token.
+  cancellation_token token;
+
+  /// Point in time after which solves are interrupted.
+  clock::time_point deadline = clock::time_point::max();
+
+  /// Maximal duration of a single solve.
+  clock::duration time_limit = clock::duration::max();
+
+  /// What to do when a solve is interrupted.
+  interruption_mode mode = PartialResults;
+};
+
+/// @brief Exception: A solve has been cancelled or has run past its deadline
+/// or time limit.
+///
+/// This exception is thrown by `arpack_solver` if the
+/// @ref interruption_policy::mode is ezarpack::ThrowOnInterruption.
+struct solve_interrupted : public std::runtime_error {
+  solve_interrupted()
+      : ARPACK_SOLVER_ERROR("The solve has been interrupted") {}
+};
+
+/// @internal Tracks interruption conditions of the solves performed by
+/// a solver object.
+class interruption_monitor {
+  using clock = interruption_policy::clock;
+
+  interruption_policy policy_;
+  clock::time_point deadline_ = clock::time_point::max(); // Of the solve
+  bool timed_ = false;       // Is there a deadline?
+  bool interrupted_ = false; // Has the solve been interrupted?
+
+public:
+  /// Interruption policy.
+  interruption_policy const& policy() const { return policy_; }
+
+  /// Sets interruption policy.
+  void set_policy(interruption_policy const& policy) { policy_ = policy; }
+
+  /// Has the last solve been interrupted?
+  bool interrupted() const { return interrupted_; }
+
+  /// Start monitoring a new solve.
+  void start() {
+    interrupted_ = false;
+    deadline_ = policy_.deadline;
+    if(policy_.time_limit != clock::duration::max()) {
+      clock::time_point now = clock::now();
+      if(policy_.time_limit < deadline_ - now)
+        deadline_ = now + policy_.time_limit;
+    }
+    timed_ = deadline_ != clock::time_point::max();
+  }
+
+  /// Check interruption conditions.
+  ///
+  /// @return `true` if the solve has to be interrupted now and has not been
+  /// interrupted before.
+  /// @throws ezarpack::solve_interrupted The solve has to be interrupted, and
+  /// the mode is ezarpack::ThrowOnInterruption.
+  bool check() {
+    if(interrupted_) return false;
+    if(!policy_.token.cancelled() && !(timed_ && clock::now() >= deadline_))
+      return false;
+    interrupted_ = true;
+    if(policy_.mode == ThrowOnInterruption) throw solve_interrupted();
+    return true;
+  }
+};
+
+} // namespace ezarpack
@@ -0,0 +1,305 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/convergence_trace.hpp
+/// @brief Recorder of Ritz values and Ritz estimates at implicit restarts.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <ios>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include "common.hpp"
+
+namespace ezarpack {
+
+/// @brief Recorder of the convergence history of Implicitly Restarted
+/// Lanczos/Arnoldi runs.
+///
+/// A trace is attached to a solver with `arpack_solver::set_trace()`. In the
+/// course of a run, the solver then records Ritz values and Ritz estimates
+/// computed by ARPACK-NG at every implicit restart, and once more at the end
+/// of the iteration. This works with the default
+/// @ref arpack_solver::exact_shifts_f "Exact Shift Strategy" as well as with
+/// user-supplied shift functors. Each run discards records of the previous
+/// one.
+///
+/// The history can be exported in CSV and JSON formats.
+class convergence_trace {
+public:
+  /// State of the iteration at an implicit restart.
+  struct record {
+    /// Index of the record, starting from 1. The last record of a run
+    /// describes the state at the end of the iteration.
+    int iteration;
+    /// Number of @f$ \hat O \mathbf{x} @f$ operations performed so far.
+    int n_op_x_operations;
+    /// Number of wanted Ritz values that satisfy the convergence criterion.
+    int nconv;
+    /// Largest Ritz estimate among the wanted Ritz values. A Ritz estimate is
+    /// the residual norm @f$ \|\hat O\mathbf{x} - \theta\mathbf{x}\| @f$ of
+    /// a Ritz pair @f$ (\theta, \mathbf{x}) @f$.
+    double residual_norm;
+    /// All @f$ ncv @f$ Ritz values, in the order used internally by
+    /// ARPACK-NG. Imaginary parts are zero for symmetric eigenproblems.
+    std::vector<dcomplex> ritz_values;
+    /// Ritz estimates of the Ritz values.
+    std::vector<double> ritz_estimates;
+  };
+
+private:
+  std::vector<record> records_;
+  int n_op_x_operations_ = 0;
+
+public:
+  /// Records of the last run.
+  std::vector<record> const& records() const { return records_; }
+
+  /// Number of records.
+  std::size_t size() const { return records_.size(); }
+
+  /// Is the trace empty?
+  bool empty() const { return records_.empty(); }
+
+  /// Discards all records.
+  void clear() {
+    records_.clear();
+    n_op_x_operations_ = 0;
+  }
+
+  /// Writes the trace in CSV format, one line per Ritz value.
+  ///
+  /// The columns are `iteration`, `n_op_x_operations`, `nconv`,
+  /// `residual_norm`, `index` (position of the Ritz value within its record),
+  /// `ritz_value_re`, `ritz_value_im` and `ritz_estimate`.
+  /// @param os Output stream.
+  void write_csv(std::ostream& os) const {
+    stream_state state(os);
+    os << "iteration,n_op_x_operations,nconv,residual_norm,index,"
+          "ritz_value_re,ritz_value_im,ritz_estimate\n";
+    for(auto const& r : records_) {
+      for(std::size_t i = 0; i < r.ritz_values.size(); ++i) {
+        os << r.iteration << ',' << r.n_op_x_operations << ',' << r.nconv
+           << ',' << r.residual_norm << ',' << i << ','
+           << r.ritz_values[i].real() << ',' << r.ritz_values[i].imag() << ','
+           << r.ritz_estimates[i] << '\n';
+      }
+    }
+  }
+
+  /// Writes the trace in JSON format, as an array of objects with keys
+  /// `iteration`, `n_op_x_operations`, `nconv`, `residual_norm`,
+  /// `ritz_values` (array of `[re, im]` pairs) and `ritz_estimates`.
+  /// Non-finite numbers are written as `null`.
+  /// @param os Output stream.
+  void write_json(std::ostream& os) const {
+    stream_state state(os);
+    os << '[';
+    for(std::size_t n = 0; n < records_.size(); ++n) {
+      record const& r = records_[n];
+      os << (n == 0 ? "\n" : ",\n") << "  {\"iteration\": " << r.iteration
+         << ", \"n_op_x_operations\": " << r.n_op_x_operations
+         << ", \"nconv\": " << r.nconv << ", \"residual_norm\": ";
+      write_json_number(os, r.residual_norm);
+      os << ",\n   \"ritz_values\": [";
+      for(std::size_t i = 0; i < r.ritz_values.size(); ++i) {
+        os << (i == 0 ? "[" : ", [");
+        write_json_number(os, r.ritz_values[i].real());
+        os << ", ";
+        write_json_number(os, r.ritz_values[i].imag());
+        os << ']';
+      }
+      os << "],\n   \"ritz_estimates\": [";
+      for(std::size_t i = 0; i < r.ritz_estimates.size(); ++i) {
+        if(i != 0) os << ", ";
+        write_json_number(os, r.ritz_estimates[i]);
+      }
+      os << "]}";
+    }
+    os << (records_.empty() ? "]\n" : "\n]\n");
+  }
+
+  /// @internal Observe the state of a real symmetric eigenproblem solve
+  /// after a call to `dsaupd()`.
+  ///
+  /// @param ido Request made by the Reverse Communication Interface.
+  /// @param iparam IPARAM parameter of `dsaupd()`.
+  /// @param ncv Number of Lanczos vectors.
+  /// @param nev Number of wanted Ritz values.
+  /// @param tol Relative tolerance of Ritz values.
+  /// @param ritz Ritz values stored in WORKL.
+  /// @param bounds Ritz estimates stored in WORKL.
+  void observe(rci_flag ido,
+               int const* iparam,
+               int ncv,
+               int nev,
+               double tol,
+               double const* ritz,
+               double const* bounds) {
+    observe_impl(
+        ido, iparam, ncv, nev, tol, [ritz](int i) { return dcomplex(ritz[i]); },
+        [bounds](int i) { return std::abs(bounds[i]); });
+  }
+
+  /// @internal Observe the state of a real nonsymmetric eigenproblem solve
+  /// after a call to `dnaupd()`.
+  ///
+  /// @param ido Request made by the Reverse Communication Interface.
+  /// @param iparam IPARAM parameter of `dnaupd()`.
+  /// @param ncv Number of Arnoldi vectors.
+  /// @param nev Number of wanted Ritz values.
+  /// @param tol Relative tolerance of Ritz values.
+  /// @param ritzr Real parts of Ritz values stored in WORKL.
+  /// @param ritzi Imaginary parts of Ritz values stored in WORKL.
+  /// @param bounds Ritz estimates stored in WORKL.
+  void observe(rci_flag ido,
+               int const* iparam,
+               int ncv,
+               int nev,
+               double tol,
+               double const* ritzr,
+               double const* ritzi,
+               double const* bounds) {
+    observe_impl(
+        ido, iparam, ncv, nev, tol,
+        [ritzr, ritzi](int i) { return dcomplex(ritzr[i], ritzi[i]); },
+        [bounds](int i) { return std::abs(bounds[i]); });
+  }
+
+  /// @internal Observe the state of a complex eigenproblem solve after
+  /// a call to `znaupd()`.
+  ///
+  /// @param ido Request made by the Reverse Communication Interface.
+  /// @param iparam IPARAM parameter of `znaupd()`.
+  /// @param ncv Number of Arnoldi vectors.
+  /// @param nev Number of wanted Ritz values.
+  /// @param tol Relative tolerance of Ritz values.
+  /// @param ritz Ritz values stored in WORKL.
+  /// @param bounds Ritz estimates stored in WORKL.
+  void observe(rci_flag ido,
+               int const* iparam,
+               int ncv,
+               int nev,
+               double tol,
+               dcomplex const* ritz,
+               dcomplex const* bounds) {
+    observe_impl(
+        ido, iparam, ncv, nev, tol, [ritz](int i) { return ritz[i]; },
+        [bounds](int i) { return std::abs(bounds[i]); });
+  }
+
+private:
+  /// @internal Restores formatting state of an output stream upon
+  /// destruction, and sets the precision required to represent doubles
+  /// exactly.
+  class stream_state {
+    std::ostream& os_;
+    std::ios_base::fmtflags flags_;
+    std::streamsize precision_;
+
+  public:
+    explicit stream_state(std::ostream& os)
+        : os_(os), flags_(os.flags()), precision_(os.precision()) {
+      os.unsetf(std::ios_base::floatfield);
+      os.precision(std::numeric_limits<double>::max_digits10);
+    }
+    stream_state(stream_state const&) = delete;
+    stream_state& operator=(stream_state const&) = delete;
+    ~stream_state() {
+      os_.flags(flags_);
+      os_.precision(precision_);
+    }
+  };
+
+  /// @internal Write a number as a JSON value.
+  static void write_json_number(std::ostream& os, double x) {
+    if(std::isfinite(x))
+      os << x;
+    else
+      os << "null";
+  }
+
+  /// @internal Implementation of observe().
+  ///
+  /// WORKL is zeroed by the first call to `*aupd()`, and the Ritz values and
+  /// estimates stored in it are refreshed by every implicit restart. With
+  /// the exact shifts, a restart is followed by a request for
+  /// @f$ \hat O \mathbf{x} @f$ and is detected by a change in the stored
+  /// values. With user-supplied shifts, it is preceded by a request for
+  /// the shifts.
+  template<typename RitzF, typename BoundF>
+  void observe_impl(rci_flag ido,
+                    int const* iparam,
+                    int ncv,
+                    int nev,
+                    double tol,
+                    RitzF ritz,
+                    BoundF bound) {
+    bool const exact_shifts = (iparam[0] == 1);
+    bool const apply_op = (ido == ApplyOpInit || ido == ApplyOp);
+    if((apply_op && exact_shifts && changed(ncv, ritz, bound)) ||
+       ido == Shifts || ido == Done) {
+      record r;
+      r.iteration = int(records_.size()) + 1;
+      r.n_op_x_operations = n_op_x_operations_;
+      r.ritz_values.resize(ncv);
+      r.ritz_estimates.resize(ncv);
+      for(int i = 0; i < ncv; ++i) {
+        r.ritz_values[i] = ritz(i);
+        r.ritz_estimates[i] = bound(i);
+      }
+
+      // Wanted Ritz values are at the tail end of the arrays during
+      // the iteration, and at the front after its completion
+      int const first = (ido == Done) ? 0 : ncv - nev;
+      double const eps = std::numeric_limits<double>::epsilon() / 2;
+      double const eps23 = std::pow(eps, 2.0 / 3);
+      if(tol <= 0) tol = eps;
+      r.nconv = 0;
+      r.residual_norm = 0;
+      for(int i = first; i < first + nev; ++i) {
+        double const estimate = r.ritz_estimates[i];
+        r.residual_norm = std::max(r.residual_norm, estimate);
+        if(estimate <= tol * std::max(eps23, std::abs(r.ritz_values[i])))
+          ++r.nconv;
+      }
+      if(ido == Done) r.nconv = iparam[4];
+
+      records_.push_back(std::move(r));
+    }
+    if(apply_op) ++n_op_x_operations_;
+  }
+
+  /// @internal Do the Ritz values or estimates differ from the last
+  /// recorded ones (or from zero if nothing has been recorded)?
+  template<typename RitzF, typename BoundF>
+  bool changed(int ncv, RitzF& ritz, BoundF& bound) const {
+    if(records_.empty()) {
+      for(int i = 0; i < ncv; ++i) {
+        if(ritz(i) != 0.0 || bound(i) != 0) return true;
+      }
+      return false;
+    }
+    record const& last = records_.back();
+    for(int i = 0; i < ncv; ++i) {
+      if(ritz(i) != last.ritz_values[i] || bound(i) != last.ritz_estimates[i])
+        return true;
+    }
+    return false;
+  }
+};
+
+} // namespace ezarpack
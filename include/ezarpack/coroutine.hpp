@@ -0,0 +1,379 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/coroutine.hpp
+/// @brief C++20 coroutine adaptors for solvers with asynchronous linear
+/// operators.
+///
+/// The contents of this header are only available in C++20 mode.
+#pragma once
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+
+#include <algorithm>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "arpack_solver.hpp"
+
+namespace ezarpack {
+
+/// @internal Serializes coroutine-based solves while ARPACK-NG is not
+/// reentrant.
+///
+/// Suspended solves wait in a FIFO queue. A released turn is passed to the
+/// next solve in the queue, which becomes pending. The pending solve is never
+/// resumed from within release(), so that handing over the turn does not nest
+/// solves on the stack. Instead, it is resumed through symmetric transfer by
+/// a completing task, or by resume_waiting_solves().
+///
+/// Every solve is identified by the flag in its promise object that tells
+/// whether the solve holds the turn. The flag is only accessed under the lock
+/// of the gate.
+class async_arpack_gate {
+  // Suspended solve
+  struct waiter {
+    std::coroutine_handle<> handle;
+    bool* holds_turn;
+  };
+
+  std::mutex mutex_;
+  bool busy_ = false;
+  std::deque<waiter> waiting_;
+  waiter pending_ = {nullptr, nullptr};
+
+public:
+  /// Gate shared by all solves in the process.
+  static async_arpack_gate& instance() {
+    static async_arpack_gate gate;
+    return gate;
+  }
+
+  /// Awaitable that suspends the calling coroutine until it is its turn to
+  /// use ARPACK-NG. The promise of the coroutine is marked as holding the turn
+  /// once the turn has been given to it.
+  struct acquire_awaiter {
+    async_arpack_gate& gate;
+    bool await_ready() noexcept { return false; }
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> h) {
+      std::lock_guard<std::mutex> lock(gate.mutex_);
+      if(!gate.busy_) {
+        gate.busy_ = true;
+        h.promise().holds_turn = true;
+        return false;
+      }
+      gate.waiting_.push_back({h, &h.promise().holds_turn});
+      return true;
+    }
+    void await_resume() noexcept {}
+  };
+
+  /// Returns an awaitable that waits for the turn to use ARPACK-NG.
+  acquire_awaiter acquire() { return acquire_awaiter{*this}; }
+
+  /// Passes the turn held by a solve to the next waiting solve, if any, and
+  /// makes the latter pending.
+  /// @param holds_turn Flag of the releasing solve.
+  void release(bool& holds_turn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    release_locked(holds_turn);
+  }
+
+  /// Withdraws a solve destroyed before completion from the gate. Its turn,
+  /// if any, is passed on.
+  /// @param holds_turn Flag of the withdrawn solve.
+  void withdraw(bool& holds_turn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    waiting_.erase(std::remove_if(waiting_.begin(), waiting_.end(),
+                                  [&](waiter const& w) {
+                                    return w.holds_turn == &holds_turn;
+                                  }),
+                   waiting_.end());
+    if(pending_.holds_turn == &holds_turn) pending_ = {nullptr, nullptr};
+    release_locked(holds_turn);
+  }
+
+  /// Takes the pending coroutine, which is to be resumed by the caller.
+  std::coroutine_handle<> take_pending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::exchange(pending_, {nullptr, nullptr}).handle;
+  }
+
+private:
+  /// Implementation of release() to be called under the lock.
+  void release_locked(bool& holds_turn) {
+    if(!holds_turn) return;
+    holds_turn = false;
+    if(waiting_.empty()) {
+      busy_ = false;
+      return;
+    }
+    pending_ = waiting_.front();
+    waiting_.pop_front();
+    *pending_.holds_turn = true;
+  }
+};
+
+/// @brief Resumes solves that have been given the turn to use a non-reentrant
+/// ARPACK-NG library, but have not been resumed yet.
+///
+/// When a solve started by async_solve() completes, the turn passes to the
+/// next waiting solve. If no coroutine awaits the completed task, the next
+/// solve is resumed right away. Otherwise, the awaiting coroutine is resumed
+/// first, and the next solve continues once the awaiting coroutine completes,
+/// once solve_task::start() returns, or once this function is called.
+inline void resume_waiting_solves() {
+  async_arpack_gate& gate = async_arpack_gate::instance();
+  while(auto h = gate.take_pending())
+    h.resume();
+}
+
+/// @brief Coroutine type of an eigenproblem solve started by async_solve().
+///
+/// A task is created suspended. It is either started with @ref start() and
+/// then resumed by the awaitables returned from the linear operators, or
+/// awaited from another coroutine with `co_await`. Once the task is
+/// @ref done(), @ref get() reports the outcome of the solve.
+///
+/// A task destroyed while it is waiting for its turn to access
+/// a non-reentrant ARPACK-NG library (see async_solve()) leaves the queue of
+/// waiting solves. Destroying a task that holds the turn passes the turn on.
+class solve_task {
+public:
+  /// @internal Promise type of the coroutine.
+  struct promise_type {
+    std::exception_ptr error;             // Exception thrown by the solve
+    std::coroutine_handle<> continuation; // Coroutine awaiting the task
+    bool holds_turn = false;              // Does the solve hold the turn?
+
+    // Withdraw a task destroyed before completion from the gate
+    ~promise_type() { async_arpack_gate::instance().withdraw(holds_turn); }
+
+    solve_task get_return_object() {
+      return solve_task(handle_t::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Release the turn and transfer control to the awaiting coroutine, or
+    // to the pending solve if nobody awaits this task
+    struct final_awaiter {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+        async_arpack_gate& gate = async_arpack_gate::instance();
+        promise_type& promise = h.promise();
+        gate.release(promise.holds_turn);
+        if(promise.continuation) return promise.continuation;
+        if(auto pending = gate.take_pending()) return pending;
+        return std::noop_coroutine();
+      }
+      void await_resume() noexcept {}
+    };
+    final_awaiter final_suspend() noexcept { return {}; }
+
+    void return_void() {}
+    void unhandled_exception() { error = std::current_exception(); }
+  };
+
+private:
+  using handle_t = std::coroutine_handle<promise_type>;
+  handle_t handle_;
+  bool started_ = false;
+
+  explicit solve_task(handle_t handle) : handle_(handle) {}
+
+public:
+  solve_task(solve_task const&) = delete;
+  solve_task& operator=(solve_task const&) = delete;
+
+  solve_task(solve_task&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)),
+        started_(other.started_) {}
+  solve_task& operator=(solve_task&& other) noexcept {
+    if(this != &other) {
+      if(handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+      started_ = other.started_;
+    }
+    return *this;
+  }
+
+  ~solve_task() {
+    if(handle_) handle_.destroy();
+  }
+
+  /// Runs the solve until its first suspension point, then resumes solves
+  /// that have been given the turn in the meantime (see
+  /// resume_waiting_solves()).
+  /// @throws std::runtime_error The task has already been started.
+  void start() {
+    check_not_started();
+    started_ = true;
+    handle_.resume();
+    resume_waiting_solves();
+  }
+
+  /// Has the solve been completed (successfully or not)?
+  bool done() const { return handle_ && handle_.done(); }
+
+  /// Rethrows the exception thrown by a completed solve, if any.
+  /// @throws std::runtime_error The solve has not been completed yet.
+  void get() const {
+    if(!done())
+      throw std::runtime_error("solve_task: The solve has not been completed");
+    if(handle_.promise().error)
+      std::rethrow_exception(handle_.promise().error);
+  }
+
+  /// Makes a task awaitable from another coroutine. The awaiting coroutine
+  /// starts the task, and it is resumed upon completion of the solve.
+  /// Exceptions thrown by the solve are propagated to the awaiting coroutine.
+  auto operator co_await() {
+    check_not_started();
+    started_ = true;
+    struct awaiter {
+      handle_t handle;
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      void await_resume() {
+        if(handle.promise().error)
+          std::rethrow_exception(handle.promise().error);
+      }
+    };
+    return awaiter{handle_};
+  }
+
+private:
+  /// @internal Make sure that the task can be started.
+  void check_not_started() const {
+    if(!handle_ || started_)
+      throw std::runtime_error("solve_task: The task has already been "
+                               "started");
+  }
+};
+
+/// @internal Call a linear operator and turn its result into an awaitable.
+///
+/// Operators returning `void` complete synchronously.
+template<typename F, typename In, typename Out>
+auto make_operator_awaitable(F& f, In in, Out out) {
+  if constexpr(std::is_void_v<decltype(f(in, out))>) {
+    f(in, out);
+    return std::suspend_never{};
+  } else
+    return f(in, out);
+}
+
+/// @internal Coroutine serving requests of a step-wise solve.
+///
+/// @param solver Solver object.
+/// @param begin Callable object starting the step-wise solve.
+/// @param op Linear operator @f$ \hat O @f$.
+/// @param b Linear operator @f$ \hat B @f$.
+template<typename Solver, typename Begin, typename OP, typename B>
+solve_task run_async_solve(Solver& solver, Begin begin, OP op, B b) {
+  if(!arpack_reentrant()) co_await async_arpack_gate::instance().acquire();
+
+  begin(solver);
+  while(true) {
+    auto s = solver.step();
+    if(s.request == Done) break;
+    if(s.request == ApplyB)
+      co_await make_operator_awaitable(b, s.in, s.out);
+    else
+      co_await make_operator_awaitable(op, s.in, s.out);
+  }
+  solver.finish();
+}
+
+/// @brief Solves a standard eigenproblem
+/// @f$ \hat A\mathbf{x} = \lambda\mathbf{x}@f$ in a coroutine.
+///
+/// The solve is driven by the step-wise interface of `arpack_solver` (see
+/// `arpack_solver::begin()`). Every time the Reverse Communication Interface
+/// requests an application of the linear operator, the coroutine calls
+/// @code
+/// a(vector_view_t in, vector_view_t out)
+/// @endcode
+/// where `in` must not be modified. If `a` returns an awaitable, the
+/// coroutine `co_await`s it and can be suspended until the product is ready,
+/// for instance while it is being computed by a remote process or read from
+/// disk. If `a` returns `void`, the product is considered ready immediately.
+/// This way, one thread can interleave many solves whose linear operators are
+/// latency-bound.
+///
+/// ARPACK-NG keeps parts of its state between two Reverse Communication
+/// Interface calls, so unless it has been declared reentrant with
+/// set_arpack_reentrant(), coroutine-based solves run one at a time. A solve
+/// started while another one is in progress is suspended until the latter
+/// completes. See resume_waiting_solves() for when it is resumed.
+///
+/// @param solver Solver object. It must outlive the returned task.
+/// @param a Linear operator @f$ \hat A @f$. It is stored in the coroutine.
+/// @param params Set of input parameters for the solver.
+/// @return Suspended task performing the solve.
+template<operator_kind OpKind, typename Backend, typename A>
+solve_task
+async_solve(arpack_solver<OpKind, Backend>& solver,
+            A a,
+            typename arpack_solver<OpKind, Backend>::params_t params) {
+  using solver_t = arpack_solver<OpKind, Backend>;
+  return run_async_solve(
+      solver, [params](solver_t& s) { s.begin(params); }, std::move(a),
+      [](typename solver_t::vector_view_t,
+         typename solver_t::vector_view_t) {});
+}
+
+/// @brief Solves a generalized eigenproblem
+/// @f$ \hat A\mathbf{x} = \lambda\hat M\mathbf{x}@f$ in a coroutine.
+///
+/// See async_solve() for standard eigenproblems. The linear operators
+/// @f$ \hat O @f$ and @f$ \hat B @f$ are called as
+/// @code
+/// op(vector_view_t in, vector_view_t out)
+/// b(vector_view_t in, vector_view_t out)
+/// @endcode
+/// and have the same meaning as in the generalized version of
+/// `arpack_solver::operator()`. Each of them may return an awaitable.
+///
+/// @param solver Solver object. It must outlive the returned task.
+/// @param op Linear operator @f$ \hat O @f$. It is stored in the coroutine.
+/// @param b Linear operator @f$ \hat B @f$. It is stored in the coroutine.
+/// @param mode Computational mode to be used.
+/// @param params Set of input parameters for the solver.
+/// @return Suspended task performing the solve.
+template<operator_kind OpKind, typename Backend, typename OP, typename B>
+solve_task
+async_solve(arpack_solver<OpKind, Backend>& solver,
+            OP op,
+            B b,
+            typename arpack_solver<OpKind, Backend>::Mode mode,
+            typename arpack_solver<OpKind, Backend>::params_t params) {
+  using solver_t = arpack_solver<OpKind, Backend>;
+  return run_async_solve(
+      solver, [mode, params](solver_t& s) { s.begin(mode, params); },
+      std::move(op), std::move(b));
+}
+
+} // namespace ezarpack
+
+#endif
@@ -0,0 +1,282 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/csr_operator.hpp
+/// @brief Linear operators defined by sparse matrices in the Compressed Sparse
+/// Row (CSR) format.
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "view_data.hpp"
+
+namespace ezarpack {
+
+/// Structure of a sparse matrix stored in the CSR format.
+enum csr_structure {
+  CSRGeneral,        /**< All non-zero matrix elements are stored.          */
+  CSRUpperSymmetric, /**< Symmetric matrix, only the upper triangle
+                          (including the main diagonal) is stored.         */
+  CSRUpperHermitian  /**< Hermitian matrix, only the upper triangle
+                          (including the main diagonal) is stored.         */
+};
+
+/// @brief Linear operator defined by a square sparse matrix in the Compressed
+/// Sparse Row (CSR) format.
+///
+/// Objects of this class can be passed as linear operators to
+/// `arpack_solver::operator()` for all kinds of eigenproblems. Rows of the
+/// matrix are split into contiguous parts with approximately equal numbers of
+/// stored elements, and the matrix-vector product is computed part-wise with
+/// parallel_for(), i.e. on the current @ref thread_pool or in parallel when
+/// OpenMP is enabled.
+///
+/// For the CSRUpperSymmetric and CSRUpperHermitian structures, contributions
+/// of the lower triangle are accumulated in per-part buffers. A buffer covers
+/// only the rows reached by the transposed elements of its part, which makes
+/// the extra memory and the reduction work small for banded matrices. The
+/// buffers are allocated on the first application and reused afterwards. Such
+/// operators must not be applied from concurrent threads.
+///
+/// @note Vector views passed to the operator must reference whole vectors.
+/// Therefore, it is not suitable for `mpi::arpack_solver`, which works with
+/// MPI rank-local blocks of vectors.
+///
+/// @tparam T Type of matrix elements, `double` or `std::complex<double>`.
+template<typename T> class csr_operator {
+
+  int n_;                    // Dimension of the matrix
+  std::vector<int> row_ptr_; // Row pointers
+  std::vector<int> col_ind_; // Column indices of stored elements
+  std::vector<T> values_;    // Values of stored elements
+  csr_structure structure_;  // Structure of the matrix
+  int n_parts_;              // Number of parts, 0 for automatic choice
+
+  // Partition used by the last application to a vector (CSRUpper* only).
+  // Rows [parts_[p]; parts_[p + 1]) form the p-th part of the matrix, and its
+  // transposed elements reach rows [parts_[p]; ends_[p]).
+  mutable std::vector<int> parts_;
+  mutable std::vector<int> ends_;
+  // Offsets of per-part buffers within real_buffer_/complex_buffer_
+  mutable std::vector<std::size_t> buffer_offsets_;
+
+  // Buffers for contributions of the lower triangle
+  mutable std::vector<double> real_buffer_;
+  mutable std::vector<std::complex<double>> complex_buffer_;
+
+public:
+  /// Constructs a CSR operator.
+  ///
+  /// @param n Dimension of the matrix.
+  /// @param row_ptr Row pointers, an array of size `n + 1`. Stored elements
+  /// of the `i`-th row occupy positions `[row_ptr[i]; row_ptr[i + 1])` in
+  /// `col_ind` and `values`.
+  /// @param col_ind Column indices of the stored elements.
+  /// @param values Values of the stored elements.
+  /// @param structure Structure of the matrix.
+  /// @param n_parts Number of parts to split rows of the matrix into.
+  /// A non-positive value stands for the number of threads available to
+  /// parallel_for() at the time of application, see parallel_concurrency().
+  /// @throws std::runtime_error Invalid or inconsistent CSR data.
+  csr_operator(int n,
+               std::vector<int> row_ptr,
+               std::vector<int> col_ind,
+               std::vector<T> values,
+               csr_structure structure = CSRGeneral,
+               int n_parts = 0)
+      : n_(n),
+        row_ptr_(std::move(row_ptr)),
+        col_ind_(std::move(col_ind)),
+        values_(std::move(values)),
+        structure_(structure),
+        n_parts_(std::max(n_parts, 0)) {
+    validate();
+  }
+
+  /// Dimension of the matrix.
+  int dim() const { return n_; }
+
+  /// Number of stored matrix elements.
+  int nnz() const { return row_ptr_[n_]; }
+
+  /// Structure of the matrix.
+  csr_structure structure() const { return structure_; }
+
+  /// Number of parts the rows of the matrix are split into when the operator
+  /// is applied from the calling thread.
+  int n_parts() const {
+    return std::min(n_parts_ > 0 ? n_parts_ : parallel_concurrency(), n_);
+  }
+
+  /// Computes the matrix-vector product @f$ \mathbf{y} = \hat A \mathbf{x} @f$
+  /// for vectors stored in plain arrays.
+  ///
+  /// @param x Input array of length @ref dim().
+  /// @param y Output array of length @ref dim().
+  template<typename X, typename Y> void apply(X const* x, Y* y) const {
+    if(structure_ == CSRGeneral)
+      apply_general(x, y);
+    else
+      apply_upper(x, y, structure_ == CSRUpperHermitian);
+  }
+
+  /// Applies the linear operator to a vector.
+  /// @param in View of the input vector.
+  /// @param out View of the output vector.
+  template<typename In, typename Out>
+  void operator()(In&& in, Out&& out) const {
+    apply(view_data(in), view_data(out));
+  }
+
+private:
+  /// @internal Check consistency of the CSR data.
+  void validate() const {
+    if(n_ < 1)
+      throw std::runtime_error("csr_operator: Dimension must be positive");
+    if(int(row_ptr_.size()) != n_ + 1)
+      throw std::runtime_error("csr_operator: row_ptr must be of size " +
+                               std::to_string(n_ + 1));
+    if(row_ptr_[0] != 0)
+      throw std::runtime_error("csr_operator: row_ptr[0] must be zero");
+    for(int i = 0; i < n_; ++i) {
+      if(row_ptr_[i + 1] < row_ptr_[i])
+        throw std::runtime_error("csr_operator: row_ptr must not decrease");
+    }
+    if(int(col_ind_.size()) != nnz() || int(values_.size()) != nnz())
+      throw std::runtime_error("csr_operator: col_ind and values must be of "
+                               "size " + std::to_string(nnz()));
+    for(int i = 0; i < n_; ++i) {
+      int j_min = (structure_ == CSRGeneral) ? 0 : i;
+      for(int k = row_ptr_[i]; k < row_ptr_[i + 1]; ++k) {
+        if(col_ind_[k] < j_min || col_ind_[k] >= n_)
+          throw std::runtime_error("csr_operator: Column index in row " +
+                                   std::to_string(i) + " must be within [" +
+                                   std::to_string(j_min) + ";" +
+                                   std::to_string(n_) + ")");
+      }
+    }
+  }
+
+  /// @internal First row of the p-th out of `n_parts` parts with balanced
+  /// numbers of stored elements.
+  int part_begin(int p, int n_parts) const {
+    if(p == n_parts) return n_;
+    long long target = (long long)(nnz()) * p / n_parts;
+    return int(std::lower_bound(row_ptr_.begin(), row_ptr_.end(), target) -
+               row_ptr_.begin());
+  }
+
+  /// @internal Split rows into parts and find rows reached by the transposed
+  /// elements of each part.
+  void partition(int n_parts) const {
+    parts_.resize(n_parts + 1);
+    ends_.resize(n_parts);
+    for(int p = 0; p <= n_parts; ++p)
+      parts_[p] = part_begin(p, n_parts);
+    for(int p = 0; p < n_parts; ++p) {
+      int end = parts_[p + 1];
+      for(int k = row_ptr_[parts_[p]]; k < row_ptr_[parts_[p + 1]]; ++k)
+        end = std::max(end, col_ind_[k] + 1);
+      ends_[p] = end;
+    }
+
+    // The first part accumulates directly into the output vector, while
+    // a buffer of the p-th part covers rows [parts_[p]; ends_[p]).
+    buffer_offsets_.resize(n_parts + 1);
+    buffer_offsets_[0] = buffer_offsets_[1] = 0;
+    for(int p = 1; p < n_parts; ++p)
+      buffer_offsets_[p + 1] = buffer_offsets_[p] + (ends_[p] - parts_[p]);
+  }
+
+  /// @internal Matrix-vector product, all elements stored.
+  template<typename X, typename Y>
+  void apply_general(X const* x, Y* y) const {
+    int const n_parts = this->n_parts();
+    parallel_for(n_parts, [&](int p) {
+      int const end = part_begin(p + 1, n_parts);
+      for(int i = part_begin(p, n_parts); i < end; ++i) {
+        Y sum = 0;
+        for(int k = row_ptr_[i]; k < row_ptr_[i + 1]; ++k)
+          sum += values_[k] * x[col_ind_[k]];
+        y[i] = sum;
+      }
+    });
+  }
+
+  /// @internal Matrix-vector product, only the upper triangle stored.
+  template<typename X, typename Y>
+  void apply_upper(X const* x, Y* y, bool hermitian) const {
+    int const n_parts = this->n_parts();
+    if(int(parts_.size()) != n_parts + 1) partition(n_parts);
+    std::vector<Y>& buffer = lower_buffer(y);
+    if(buffer.size() < buffer_offsets_.back())
+      buffer.resize(buffer_offsets_.back());
+
+    parallel_for(n_parts, [&](int p) {
+      int const r0 = parts_[p];
+      // acc[j - r0] accumulates the j-th component of the product
+      Y* acc = (p == 0) ? y : buffer.data() + buffer_offsets_[p];
+      std::fill(acc, acc + (ends_[p] - r0), Y(0));
+      for(int i = r0; i < parts_[p + 1]; ++i) {
+        Y sum = 0;
+        X const xi = x[i];
+        for(int k = row_ptr_[i]; k < row_ptr_[i + 1]; ++k) {
+          int const j = col_ind_[k];
+          T const a = values_[k];
+          sum += a * x[j];
+          if(j != i) acc[j - r0] += (hermitian ? csr_conj(a) : a) * xi;
+        }
+        acc[i - r0] += sum;
+      }
+    });
+
+    if(n_parts == 1) return;
+
+    // Add up contributions accumulated in the buffers
+    parallel_for(n_parts, [&](int q) {
+      int const q0 = parts_[q], q1 = parts_[q + 1];
+      // Rows not reached by the first part
+      if(ends_[0] < q1) std::fill(y + std::max(q0, ends_[0]), y + q1, Y(0));
+      for(int p = 1; p <= q; ++p) {
+        Y const* acc = buffer.data() + buffer_offsets_[p];
+        int const r0 = parts_[p];
+        int const end = std::min(q1, ends_[p]);
+        for(int i = q0; i < end; ++i)
+          y[i] += acc[i - r0];
+      }
+    });
+  }
+
+  /// @internal Buffer for real output vectors.
+  std::vector<double>& lower_buffer(double*) const { return real_buffer_; }
+  /// @internal Buffer for complex output vectors.
+  std::vector<std::complex<double>>&
+  lower_buffer(std::complex<double>*) const {
+    return complex_buffer_;
+  }
+
+  /// @internal Complex conjugate of a real number.
+  static double csr_conj(double a) { return a; }
+  /// @internal Complex conjugate of a complex number.
+  static std::complex<double> csr_conj(std::complex<double> const& a) {
+    return std::conj(a);
+  }
+};
+
+} // namespace ezarpack
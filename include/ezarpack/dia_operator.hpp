@@ -0,0 +1,159 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/dia_operator.hpp
+/// @brief Linear operators defined by banded matrices in the diagonal (DIA)
+/// format.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "view_data.hpp"
+
+namespace ezarpack {
+
+/// @brief Linear operator defined by a square banded matrix in the diagonal
+/// (DIA) format.
+///
+/// The matrix is stored as a set of diagonals, each identified by its offset
+/// from the main diagonal. Rows of the matrix-vector product are processed in
+/// blocks distributed among threads with parallel_for(), and the contribution
+/// of each diagonal to a block is computed in a unit-stride loop that is
+/// vectorized by the compiler (explicitly so when OpenMP is enabled).
+///
+/// Objects of this class can be passed as linear operators to
+/// `arpack_solver::operator()` for all kinds of eigenproblems. Method
+/// @ref apply_rows() computes a range of rows of the product. It serves as
+/// the local kernel in mpi::halo_operator, which makes the operator usable
+/// with `mpi::arpack_solver`.
+///
+/// @tparam T Type of matrix elements, `double` or `std::complex<double>`.
+template<typename T> class dia_operator {
+
+  int n_;                    // Dimension of the matrix
+  std::vector<int> offsets_; // Offsets of the stored diagonals
+  std::vector<T> values_;    // Elements of the stored diagonals
+  int lower_bandwidth_ = 0;  // Number of subdiagonals
+  int upper_bandwidth_ = 0;  // Number of superdiagonals
+
+  // Number of rows of the product processed by one task
+  static constexpr int block_rows = 1 << 12;
+
+public:
+  /// Constructs a DIA operator.
+  ///
+  /// @param n Dimension of the matrix.
+  /// @param offsets Offsets of the stored diagonals. The main diagonal has
+  /// offset 0, superdiagonals have positive offsets and subdiagonals have
+  /// negative offsets. The offsets must be distinct.
+  /// @param values Elements of the stored diagonals, an array of size
+  /// `offsets.size() * n`. The matrix element
+  /// @f$ A_{i, i + \mathrm{offsets}[d]} @f$ is stored in `values[d * n + i]`.
+  /// Array elements corresponding to positions outside the matrix are
+  /// ignored.
+  /// @throws std::runtime_error Invalid or inconsistent DIA data.
+  dia_operator(int n, std::vector<int> offsets, std::vector<T> values)
+      : n_(n), offsets_(std::move(offsets)), values_(std::move(values)) {
+    if(n_ < 1)
+      throw std::runtime_error("dia_operator: Dimension must be positive");
+    if(values_.size() != offsets_.size() * std::size_t(n_))
+      throw std::runtime_error("dia_operator: values must be of size " +
+                               std::to_string(offsets_.size() * n_));
+    std::vector<int> sorted_offsets(offsets_);
+    std::sort(sorted_offsets.begin(), sorted_offsets.end());
+    if(std::adjacent_find(sorted_offsets.begin(), sorted_offsets.end()) !=
+       sorted_offsets.end())
+      throw std::runtime_error("dia_operator: Offsets must be distinct");
+    for(int offset : offsets_) {
+      if(offset <= -n_ || offset >= n_)
+        throw std::runtime_error("dia_operator: Offsets must be within ]" +
+                                 std::to_string(-n_) + ";" +
+                                 std::to_string(n_) + "[");
+      lower_bandwidth_ = std::max(lower_bandwidth_, -offset);
+      upper_bandwidth_ = std::max(upper_bandwidth_, offset);
+    }
+  }
+
+  /// Dimension of the matrix.
+  int dim() const { return n_; }
+
+  /// Number of stored diagonals.
+  int n_diagonals() const { return int(offsets_.size()); }
+
+  /// Offsets of the stored diagonals.
+  std::vector<int> const& offsets() const { return offsets_; }
+
+  /// Number of subdiagonals, @f$ \max_{A_{ij} \neq 0} (i - j) @f$.
+  int lower_bandwidth() const { return lower_bandwidth_; }
+
+  /// Number of superdiagonals, @f$ \max_{A_{ij} \neq 0} (j - i) @f$.
+  int upper_bandwidth() const { return upper_bandwidth_; }
+
+  /// Computes the matrix-vector product @f$ \mathbf{y} = \hat A \mathbf{x} @f$
+  /// for vectors stored in plain arrays.
+  ///
+  /// @param x Input array of length @ref dim().
+  /// @param y Output array of length @ref dim().
+  template<typename X, typename Y> void apply(X const* x, Y* y) const {
+    apply_rows(x, y, 0, n_);
+  }
+
+  /// Computes components `[row_begin; row_end)` of the matrix-vector product
+  /// @f$ \mathbf{y} = \hat A \mathbf{x} @f$.
+  ///
+  /// @param x Pointer to the component @f$ x_\mathrm{row\_begin} @f$.
+  /// Components @f$ x_j @f$ with `j` in
+  /// `[max(0, row_begin - lower_bandwidth()); min(dim(), row_end +
+  /// upper_bandwidth()))` must be accessible as `x[j - row_begin]`.
+  /// @param y Output array of length `row_end - row_begin`.
+  /// @param row_begin First computed component.
+  /// @param row_end Past-the-end computed component.
+  template<typename X, typename Y>
+  void apply_rows(X const* x, Y* y, int row_begin, int row_end) const {
+    int const n_blocks = (row_end - row_begin + block_rows - 1) / block_rows;
+    parallel_for(n_blocks, [&](int b) {
+      int const i_begin = row_begin + b * block_rows;
+      int const i_end = std::min(i_begin + block_rows, row_end);
+      std::fill(y + (i_begin - row_begin), y + (i_end - row_begin), Y(0));
+      for(std::size_t d = 0; d < offsets_.size(); ++d) {
+        int const offset = offsets_[d];
+        int const lo = std::max(i_begin, -offset);
+        int const hi = std::min(i_end, n_ - offset);
+        if(lo >= hi) continue;
+        T const* a = values_.data() + d * n_ + lo;
+        X const* xd = x + (lo + offset - row_begin);
+        Y* yd = y + (lo - row_begin);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+        for(int k = 0; k < hi - lo; ++k)
+          yd[k] += a[k] * xd[k];
+      }
+    });
+  }
+
+  /// Applies the linear operator to a vector.
+  /// @param in View of the input vector.
+  /// @param out View of the output vector.
+  template<typename In, typename Out>
+  void operator()(In&& in, Out&& out) const {
+    apply(view_data(in), view_data(out));
+  }
+};
+
+} // namespace ezarpack
@@ -0,0 +1,338 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/interleaved_solver.hpp
+/// @brief Solver advancing several standard eigenproblems in lockstep and
+/// batching their linear operator applications.
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "arpack_solver.hpp"
+#include "thread_pool.hpp"
+#include "view_data.hpp"
+
+namespace ezarpack {
+
+/// @brief Solver advancing several standard eigenproblems of the same
+/// dimension in lockstep.
+///
+/// Each eigenproblem is handled by its own `arpack_solver` object. Whenever
+/// the Reverse Communication Interface loops of the eigenproblems request
+/// applications of their linear operators, the requests are collected, and
+/// the input vectors are packed into columns of a block. A single call to
+/// a user-supplied block operator then computes all requested products at
+/// once. For eigenproblems sharing a matrix (for example, with different
+/// shifts or different starting vectors), this replaces a sequence of
+/// memory-bound matrix-vector products with one matrix-block product.
+///
+/// The lockstep mode requires a reentrant ARPACK-NG library (see
+/// set_arpack_reentrant()), in which case the Reverse Communication Interface
+/// loops run in separate threads. At most @ref n_threads() eigenproblems are
+/// advanced in lockstep at a time, and larger sets of eigenproblems are split
+/// into consecutive groups. Otherwise, eigenproblems are solved one after
+/// another, and every call to the block operator computes a single product.
+///
+/// @tparam OpKind Kind of eigenproblems to be solved.
+/// @tparam Backend Storage backend used by the solver objects.
+template<operator_kind OpKind, typename Backend> class interleaved_solver {
+public:
+  /// Type of the solver objects.
+  using solver_t = arpack_solver<OpKind, Backend>;
+  /// Input parameters of the solver objects.
+  using params_t = typename solver_t::params_t;
+  /// View of a block of vectors.
+  using vector_view_t = typename solver_t::vector_view_t;
+  /// Constant view of a block of vectors.
+  using vector_const_view_t = typename solver_t::vector_const_view_t;
+
+private:
+  using storage = storage_traits<Backend>;
+  using scalar_t =
+      typename std::conditional<OpKind == Complex, dcomplex, double>::type;
+  using block_t =
+      typename std::conditional<OpKind == Complex,
+                                typename storage::complex_vector_type,
+                                typename storage::real_vector_type>::type;
+
+  unsigned int N_;                                 // Dimension
+  int n_threads_;                                  // Maximal number of threads
+  std::vector<std::unique_ptr<solver_t>> solvers_; // Solver objects
+
+  // Blocks of input and output vectors
+  block_t in_block_;
+  block_t out_block_;
+
+  // Pending request for application of a linear operator
+  struct request {
+    int problem;        // Index of the eigenproblem
+    scalar_t const* in; // Input vector
+    scalar_t* out;      // Output vector
+  };
+  std::vector<request> pending_;
+  std::vector<request> batch_;
+  std::vector<int> problems_;
+
+  int n_active_ = 0;          // Number of eigenproblems still being solved
+  unsigned long round_ = 0;   // Number of dispatched batches in this run
+  std::exception_ptr failed_; // Exception thrown by the block operator
+  int n_block_applications_ = 0;
+  std::mutex mutex_;
+  std::condition_variable dispatched_;
+
+public:
+  /// Constructs a solver for a given number of eigenproblems.
+  /// @param N Dimension of the eigenproblems.
+  /// @param n_problems Number of eigenproblems.
+  /// @param n_threads Maximal number of threads running Reverse Communication
+  /// Interface loops in lockstep, including the thread calling
+  /// @ref operator()(). A non-positive value stands for
+  /// `std::thread::hardware_concurrency()`.
+  interleaved_solver(unsigned int N, int n_problems, int n_threads = 0)
+      : N_(N),
+        n_threads_(n_threads > 0
+                       ? n_threads
+                       : std::max(1, int(std::thread::hardware_concurrency()))),
+        in_block_(make_block(N * n_problems)),
+        out_block_(make_block(N * n_problems)) {
+    for(int i = 0; i < n_problems; ++i)
+      solvers_.emplace_back(new solver_t(N));
+    pending_.reserve(n_problems);
+    batch_.reserve(n_problems);
+    problems_.reserve(n_problems);
+  }
+
+  interleaved_solver(interleaved_solver const&) = delete;
+  interleaved_solver& operator=(interleaved_solver const&) = delete;
+
+  ~interleaved_solver() {
+    storage::destroy(in_block_);
+    storage::destroy(out_block_);
+  }
+
+  /// Dimension of the eigenproblems.
+  unsigned int dim() const { return N_; }
+
+  /// Number of eigenproblems.
+  int size() const { return int(solvers_.size()); }
+
+  /// Maximal number of eigenproblems advanced in lockstep at a time.
+  int n_threads() const { return n_threads_; }
+
+  /// Solver object of the `i`-th eigenproblem. It can be used to adjust
+  /// settings of the solver before a run and to access results after it.
+  /// @param i Index of the eigenproblem.
+  solver_t& solver(int i) { return *solvers_.at(i); }
+  /// Solver object of the `i`-th eigenproblem.
+  /// @param i Index of the eigenproblem.
+  solver_t const& solver(int i) const { return *solvers_.at(i); }
+
+  /// Number of calls to the block operator made in the last run.
+  int n_block_applications() const { return n_block_applications_; }
+
+  /// @brief Solves the standard eigenproblems.
+  ///
+  /// @param a A callable object representing the linear operators of all
+  /// eigenproblems. It must take three arguments,
+  /// @code
+  /// a(vector_const_view_t in, vector_view_t out,
+  ///   std::vector<int> const& problems)
+  /// @endcode
+  /// `in` and `out` are views of column-major blocks with @ref dim() rows
+  /// and `problems.size()` columns. `a` is expected to act with the linear
+  /// operator of eigenproblem `problems[j]` on the `j`-th column of `in` and
+  /// write the result into the `j`-th column of `out`. The indices in
+  /// `problems` are sorted in ascending order.
+  /// @param params Input parameters, one element per eigenproblem.
+  /// @throws std::runtime_error Size of `params` is not @ref size().
+  /// @throws std::exception The first exception thrown by a solver object or
+  /// by `a`. Solving the remaining eigenproblems is interrupted if `a` throws.
+  template<typename A>
+  void operator()(A&& a, std::vector<params_t> const& params) {
+    if(params.size() != solvers_.size())
+      throw std::runtime_error("interleaved_solver: Size of 'params' must be " +
+                               std::to_string(solvers_.size()));
+    solve_in_lockstep(a, arpack_reentrant() ? n_threads_ : 1,
+                      solver_run{this, &params});
+  }
+
+protected:
+  /// @internal Solves the eigenproblems in consecutive groups of up to
+  /// `group_size` eigenproblems advanced in lockstep.
+  ///
+  /// `solve(i, op)` is called from a separate thread for each eigenproblem of
+  /// a group and is expected to run the Reverse Communication Interface loop
+  /// of the `i`-th eigenproblem with the linear operator `op`. Calls of `op`
+  /// block until the block operator has been applied to the pending requests
+  /// of all eigenproblems of the group.
+  template<typename A, typename SolveF>
+  void solve_in_lockstep(A& a, int group_size, SolveF solve) {
+    n_block_applications_ = 0;
+    std::exception_ptr error;
+    for(int begin = 0; begin < size(); begin += group_size) {
+      try {
+        run_group(a, solve, begin, std::min(begin + group_size, size()));
+      } catch(...) {
+        if(!error) error = std::current_exception();
+        if(failed_) break;
+      }
+    }
+    if(error) std::rethrow_exception(error);
+  }
+
+private:
+  // Runs a solver object with a given linear operator
+  struct solver_run {
+    interleaved_solver* self;
+    std::vector<params_t> const* params;
+    template<typename Op> void operator()(int i, Op& op) const {
+      (*self->solvers_[i])(op, (*params)[i]);
+    }
+  };
+
+  /// @internal Create a block of vectors.
+  static block_t make_block(int size) {
+    return make_block(size, std::integral_constant<bool, OpKind == Complex>());
+  }
+  /// @internal Create a block of real vectors.
+  static block_t make_block(int size, std::false_type) {
+    return storage::make_real_vector(size);
+  }
+  /// @internal Create a block of complex vectors.
+  static block_t make_block(int size, std::true_type) {
+    return storage::make_complex_vector(size);
+  }
+
+  /// @internal Solve eigenproblems [begin; end) in lockstep.
+  template<typename A, typename SolveF>
+  void run_group(A& a, SolveF& solve, int begin, int end) {
+    n_active_ = end - begin;
+    round_ = 0;
+    failed_ = nullptr;
+    pending_.clear();
+
+    // Linear operators see the thread pool installed by the caller
+    thread_pool* pool = thread_pool::current();
+    std::vector<std::exception_ptr> errors(end - begin);
+
+    auto run = [&](int i) {
+      parallel_context context(pool);
+      std::exception_ptr& error = errors[i - begin];
+      try {
+        auto proxy = [&a, this, i](vector_const_view_t in, vector_view_t out) {
+          request_apply(a, i, view_data(in), view_data(out));
+        };
+        solve(i, proxy);
+      } catch(...) {
+        error = std::current_exception();
+      }
+      try {
+        finish_problem(a);
+      } catch(...) {
+        if(!error) error = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for(int i = begin + 1; i < end; ++i)
+      threads.emplace_back(run, i);
+    run(begin);
+    for(auto& t : threads)
+      t.join();
+
+    if(failed_) std::rethrow_exception(failed_);
+    for(auto const& error : errors) {
+      if(error) std::rethrow_exception(error);
+    }
+  }
+
+  /// @internal Post a request and wait until it has been served.
+  template<typename A>
+  void request_apply(A& a, int problem, scalar_t const* in, scalar_t* out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(failed_) throw_failed();
+    pending_.push_back({problem, in, out});
+    if(int(pending_.size()) == n_active_)
+      dispatch(a, lock);
+    else {
+      unsigned long const round = round_;
+      dispatched_.wait(lock, [&] { return round_ != round; });
+      if(failed_) throw_failed();
+    }
+  }
+
+  /// @internal Take an eigenproblem out of the lockstep.
+  template<typename A> void finish_problem(A& a) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    --n_active_;
+    // The remaining eigenproblems may all be waiting
+    if(!failed_ && !pending_.empty() && int(pending_.size()) == n_active_)
+      dispatch(a, lock);
+  }
+
+  /// @internal Apply the block operator to all pending requests.
+  template<typename A>
+  void dispatch(A& a, std::unique_lock<std::mutex>& lock) {
+    batch_.swap(pending_);
+    pending_.clear();
+    lock.unlock();
+
+    try {
+      std::sort(batch_.begin(), batch_.end(),
+                [](request const& r1, request const& r2) {
+                  return r1.problem < r2.problem;
+                });
+      int const k = int(batch_.size());
+      scalar_t* in_data = storage::get_data_ptr(in_block_);
+      problems_.clear();
+      for(int j = 0; j < k; ++j) {
+        std::copy(batch_[j].in, batch_[j].in + N_, in_data + j * N_);
+        problems_.push_back(batch_[j].problem);
+      }
+
+      a(storage::make_vector_const_view(in_block_, 0, N_ * k),
+        storage::make_vector_view(out_block_, 0, N_ * k),
+        static_cast<std::vector<int> const&>(problems_));
+
+      scalar_t const* out_data = storage::get_data_ptr(out_block_);
+      for(int j = 0; j < k; ++j)
+        std::copy(out_data + j * N_, out_data + (j + 1) * N_, batch_[j].out);
+    } catch(...) {
+      lock.lock();
+      failed_ = std::current_exception();
+      ++round_;
+      dispatched_.notify_all();
+      throw;
+    }
+
+    lock.lock();
+    ++round_;
+    ++n_block_applications_;
+    dispatched_.notify_all();
+  }
+
+  /// @internal Interrupt a solve after failure of the block operator.
+  [[noreturn]] static void throw_failed() {
+    throw std::runtime_error("interleaved_solver: Block operator has failed");
+  }
+};
+
+} // namespace ezarpack
@@ -0,0 +1,879 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/iterative_shift_invert.hpp
+/// @brief Spectral transformations of generalized eigenproblems with inexact
+/// inversion by preconditioned Krylov subspace methods.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "convergence_trace.hpp"
+#include "view_data.hpp"
+
+namespace ezarpack {
+
+/// Krylov subspace method used to solve inner linear systems.
+enum inner_solver_method {
+  InnerCG,     /**< Preconditioned Conjugate Gradient. The matrix and the
+                    preconditioner must be Hermitian positive definite. */
+  InnerMINRES, /**< Preconditioned MINRES. The matrix must be Hermitian
+                    and the preconditioner Hermitian positive definite. */
+  InnerGMRES   /**< Restarted GMRES with right preconditioning. */
+};
+
+/// Parameters of the inner linear solver of `iterative_shift_invert`.
+///
+/// The inner tolerance bounds the residual norm of an inner solve relative to
+/// the norm of its right-hand side. Unless a convergence trace is attached
+/// with `iterative_shift_invert::set_trace()`, it equals @ref tol.
+struct inner_solver_params {
+  /// Krylov subspace method.
+  inner_solver_method method = InnerGMRES;
+  /// Tightest inner tolerance.
+  double tol = 1e-12;
+  /// Loosest inner tolerance.
+  double max_tol = 1e-6;
+  /// Ratio of the inner tolerance to the relative Ritz estimate of the outer
+  /// iteration.
+  double tol_factor = 1e-3;
+  /// Maximal number of iterations per inner solve.
+  int max_iterations = 1000;
+  /// Dimension of the Krylov subspace after which GMRES is restarted.
+  int gmres_restart = 30;
+  /// Start each inner solve from the solution of the previous one?
+  bool warm_start = true;
+};
+
+/// Statistics of inner solves performed by `iterative_shift_invert`.
+struct inner_solver_stats {
+  /// Number of inner solves.
+  int n_solves = 0;
+  /// Total number of inner iterations.
+  int n_iterations = 0;
+  /// Number of inner solves that have reached the maximal number of
+  /// iterations without meeting the inner tolerance.
+  int n_unconverged = 0;
+  /// Number of iterations of the last inner solve.
+  int last_iterations = 0;
+  /// Inner tolerance of the last inner solve.
+  double last_tol = 0;
+  /// Relative residual norm reached by the last inner solve.
+  double last_residual = 0;
+};
+
+/// @internal Preconditioned Krylov subspace solver of linear systems
+/// @f$ \hat K \mathbf{x} = \mathbf{b} @f$.
+///
+/// Working arrays and the last solution are kept between solves.
+/// @tparam T Type of vector elements, `double` or `std::complex<double>`.
+template<typename T> class krylov_solver {
+
+  int n_ = 0;              // Dimension
+  std::vector<T> x_;       // Solution, also used as the next initial guess
+  bool has_guess_ = false; // Is x_ a valid initial guess?
+
+  // Working vectors
+  std::vector<T> r_, z_, p_, q_, v_, w_, w1_, w2_, r2_;
+
+  std::vector<T> basis_;  // GMRES Krylov basis
+  std::vector<T> h_;      // GMRES Hessenberg matrix
+  std::vector<T> g_;      // GMRES right-hand side of the least squares problem
+  std::vector<double> c_; // GMRES Givens rotations (cosines)
+  std::vector<T> s_;      // GMRES Givens rotations (sines)
+
+public:
+  /// Result of a solve.
+  struct result {
+    int iterations;  // Number of iterations
+    double residual; // Relative residual norm
+    bool converged;  // Has the tolerance been met?
+  };
+
+  /// Discards the last solution.
+  void reset() { has_guess_ = false; }
+
+  /// Solution of the last solve.
+  T const* solution() const { return x_.data(); }
+
+  /// Solves a linear system.
+  ///
+  /// @param method Krylov subspace method.
+  /// @param n Dimension of the system.
+  /// @param K Callable computing @f$ \hat K\mathbf{x} @f$ as `K(x, y)`.
+  /// @param P Preconditioner called as `P(r, z)`.
+  /// @param b Right-hand side.
+  /// @param tol Tolerance of the relative residual norm.
+  /// @param max_iterations Maximal number of iterations.
+  /// @param restart Restart length of GMRES.
+  /// @param warm_start Start from the last solution?
+  template<typename KOp, typename POp>
+  result solve(inner_solver_method method,
+               int n,
+               KOp&& K,
+               POp&& P,
+               T const* b,
+               double tol,
+               int max_iterations,
+               int restart,
+               bool warm_start) {
+    resize(n);
+
+    double const b_norm = norm(b);
+    if(b_norm == 0) {
+      std::fill(x_.begin(), x_.end(), T(0));
+      return {0, 0, true};
+    }
+
+    // Initial residual. The last solution is only used as an initial guess
+    // if it is better than the zero vector.
+    bool zero_guess = true;
+    if(warm_start && has_guess_) {
+      K(x_.data(), r_.data());
+      for(int i = 0; i < n_; ++i)
+        r_[i] = b[i] - r_[i];
+      zero_guess = !(norm(r_.data()) < b_norm);
+    }
+    if(zero_guess) {
+      std::fill(x_.begin(), x_.end(), T(0));
+      std::copy(b, b + n_, r_.begin());
+    }
+    has_guess_ = true;
+
+    switch(method) {
+      case InnerCG: return cg(K, P, b_norm, tol, max_iterations);
+      case InnerMINRES: return minres(K, P, b_norm, tol, max_iterations);
+      default: return gmres(K, P, b, b_norm, tol, max_iterations, restart);
+    }
+  }
+
+private:
+  /// @internal Allocate working arrays.
+  void resize(int n) {
+    if(n != n_) {
+      n_ = n;
+      has_guess_ = false;
+    }
+    for(auto* v : {&x_, &r_, &z_, &p_, &q_, &v_, &w_, &w1_, &w2_, &r2_})
+      v->resize(n_);
+  }
+
+  /// @internal Complex conjugate of a real number.
+  static double conj(double x) { return x; }
+  /// @internal Complex conjugate of a complex number.
+  static dcomplex conj(dcomplex const& x) { return std::conj(x); }
+
+  /// @internal Inner product of two vectors.
+  T dot(T const* x, T const* y) const {
+    T s = 0;
+    for(int i = 0; i < n_; ++i)
+      s += conj(x[i]) * y[i];
+    return s;
+  }
+
+  /// @internal Inner product of two vectors.
+  T dot(T const* x, std::vector<T> const& y) const { return dot(x, y.data()); }
+
+  /// @internal 2-norm of a vector.
+  double norm(T const* x) const {
+    double s = 0;
+    for(int i = 0; i < n_; ++i)
+      s += std::norm(x[i]);
+    return std::sqrt(s);
+  }
+
+  /// @internal Preconditioned Conjugate Gradient.
+  template<typename KOp, typename POp>
+  result cg(KOp& K, POp& P, double b_norm, double tol, int max_iterations) {
+    double res = norm(r_.data()) / b_norm;
+    if(res <= tol) return {0, res, true};
+
+    P(r_.data(), z_.data());
+    p_ = z_;
+    double rz = std::real(dot(r_.data(), z_.data()));
+    for(int it = 1; it <= max_iterations; ++it) {
+      K(p_.data(), q_.data());
+      double const pq = std::real(dot(p_.data(), q_.data()));
+      if(pq == 0) return {it, res, false};
+      double const alpha = rz / pq;
+      for(int i = 0; i < n_; ++i) {
+        x_[i] += alpha * p_[i];
+        r_[i] -= alpha * q_[i];
+      }
+      res = norm(r_.data()) / b_norm;
+      if(res <= tol) return {it, res, true};
+
+      P(r_.data(), z_.data());
+      double const rz_new = std::real(dot(r_.data(), z_.data()));
+      double const beta = rz_new / rz;
+      rz = rz_new;
+      for(int i = 0; i < n_; ++i)
+        p_[i] = z_[i] + beta * p_[i];
+    }
+    return {max_iterations, res, false};
+  }
+
+  /// @internal Preconditioned MINRES (C. C. Paige and M. A. Saunders,
+  /// SIAM J. Numer. Anal. 12, 617 (1975)).
+  ///
+  /// The reported residual norm is measured in the norm induced by the
+  /// preconditioner.
+  template<typename KOp, typename POp>
+  result minres(KOp& K, POp& P, double b_norm, double tol, int max_iterations) {
+    // r_ and r2_ hold the last two unnormalized Lanczos vectors, z_ holds
+    // the preconditioned one.
+    P(r_.data(), z_.data());
+    double const beta1 = std::sqrt(std::abs(std::real(dot(r_.data(), z_))));
+    if(beta1 == 0) return {0, 0, true};
+    // Converts reduction of the residual norm into a relative residual norm
+    double const scale = norm(r_.data()) / b_norm;
+
+    r2_ = r_;
+    std::fill(w_.begin(), w_.end(), T(0));
+    std::fill(w2_.begin(), w2_.end(), T(0));
+    double old_beta = 0, beta = beta1, dbar = 0, epsln = 0, phibar = beta1;
+    double cs = -1, sn = 0;
+    double res = 1;
+    for(int it = 1; it <= max_iterations; ++it) {
+      double const s = 1 / beta;
+      for(int i = 0; i < n_; ++i)
+        v_[i] = s * z_[i];
+      K(v_.data(), z_.data());
+      if(it >= 2) {
+        for(int i = 0; i < n_; ++i)
+          z_[i] -= (beta / old_beta) * r_[i];
+      }
+      double const alpha = std::real(dot(v_.data(), z_.data()));
+      for(int i = 0; i < n_; ++i)
+        z_[i] -= (alpha / beta) * r2_[i];
+      std::swap(r_, r2_);
+      r2_ = z_;
+      P(r2_.data(), z_.data());
+      old_beta = beta;
+      beta = std::sqrt(std::abs(std::real(dot(r2_.data(), z_))));
+
+      // Apply the previous rotation and compute a new one
+      double const old_eps = epsln;
+      double const delta = cs * dbar + sn * alpha;
+      double const gbar = sn * dbar - cs * alpha;
+      epsln = sn * beta;
+      dbar = -cs * beta;
+      double const gamma =
+          std::max(std::hypot(gbar, beta), std::numeric_limits<double>::min());
+      cs = gbar / gamma;
+      sn = beta / gamma;
+      double const phi = cs * phibar;
+      phibar = sn * phibar;
+
+      // Update the solution
+      std::swap(w1_, w2_);
+      std::swap(w2_, w_);
+      for(int i = 0; i < n_; ++i) {
+        w_[i] = (v_[i] - old_eps * w1_[i] - delta * w2_[i]) / gamma;
+        x_[i] += phi * w_[i];
+      }
+
+      res = phibar / beta1 * scale;
+      if(res <= tol || beta == 0) return {it, res, true};
+    }
+    return {max_iterations, res, false};
+  }
+
+  /// @internal Restarted GMRES with right preconditioning.
+  template<typename KOp, typename POp>
+  result gmres(KOp& K,
+               POp& P,
+               T const* b,
+               double b_norm,
+               double tol,
+               int max_iterations,
+               int restart) {
+    int const m = std::max(1, std::min(restart, n_));
+    basis_.resize(std::size_t(n_) * (m + 1));
+    h_.resize(std::size_t(m + 1) * m);
+    g_.resize(m + 1);
+    c_.resize(m);
+    s_.resize(m);
+    auto V = [&](int j) { return basis_.data() + std::size_t(j) * n_; };
+    auto H = [&](int i, int j) -> T& {
+      return h_[std::size_t(j) * (m + 1) + i];
+    };
+
+    double beta = norm(r_.data());
+    double res = beta / b_norm;
+    int it = 0;
+    while(res > tol && it < max_iterations) {
+      for(int i = 0; i < n_; ++i)
+        V(0)[i] = r_[i] / beta;
+      std::fill(g_.begin(), g_.end(), T(0));
+      g_[0] = beta;
+
+      int k = 0;
+      while(k < m && it < max_iterations) {
+        // Arnoldi process with modified Gram-Schmidt
+        P(V(k), z_.data());
+        K(z_.data(), w_.data());
+        for(int i = 0; i <= k; ++i) {
+          H(i, k) = dot(V(i), w_.data());
+          for(int l = 0; l < n_; ++l)
+            w_[l] -= H(i, k) * V(i)[l];
+        }
+        double const h_next = norm(w_.data());
+
+        // Apply the previous rotations and compute a new one
+        for(int i = 0; i < k; ++i) {
+          T const h1 = H(i, k), h2 = H(i + 1, k);
+          H(i, k) = c_[i] * h1 + s_[i] * h2;
+          H(i + 1, k) = -conj(s_[i]) * h1 + c_[i] * h2;
+        }
+        T const a = H(k, k);
+        double const t = std::hypot(std::abs(a), h_next);
+        if(std::abs(a) == 0) {
+          c_[k] = 0;
+          s_[k] = 1;
+          H(k, k) = h_next;
+        } else {
+          T const phase = a / std::abs(a);
+          c_[k] = std::abs(a) / t;
+          s_[k] = phase * h_next / t;
+          H(k, k) = phase * t;
+        }
+        g_[k + 1] = -conj(s_[k]) * g_[k];
+        g_[k] = c_[k] * g_[k];
+
+        ++k;
+        ++it;
+        res = std::abs(g_[k]) / b_norm;
+        if(res <= tol || h_next == 0) break;
+        if(k < m) {
+          for(int l = 0; l < n_; ++l)
+            V(k)[l] = w_[l] / h_next;
+        }
+      }
+
+      // Solve the triangular least squares problem and update the solution
+      for(int i = k - 1; i >= 0; --i) {
+        T y = g_[i];
+        for(int j = i + 1; j < k; ++j)
+          y -= H(i, j) * g_[j];
+        g_[i] = y / H(i, i);
+      }
+      std::fill(q_.begin(), q_.end(), T(0));
+      for(int j = 0; j < k; ++j) {
+        for(int l = 0; l < n_; ++l)
+          q_[l] += g_[j] * V(j)[l];
+      }
+      P(q_.data(), z_.data());
+      for(int l = 0; l < n_; ++l)
+        x_[l] += z_[l];
+
+      // True residual
+      K(x_.data(), r_.data());
+      for(int l = 0; l < n_; ++l)
+        r_[l] = b[l] - r_[l];
+      beta = norm(r_.data());
+      res = beta / b_norm;
+      if(beta == 0) break;
+    }
+    return {it, res, res <= tol};
+  }
+};
+
+/// @brief Linear operators @f$ \hat O @f$ and @f$ \hat B @f$ of
+/// a spectral transformation of a generalized eigenproblem
+/// @f$ \hat A\mathbf{x} = \lambda\hat M\mathbf{x} @f$, with the inverse
+/// applied by a preconditioned Krylov subspace method.
+///
+/// This class is a matrix-free counterpart of `sparse_shift_invert` for
+/// eigenproblems too large to factorize @f$ \hat A - \sigma\hat M @f$.
+/// @f$ \hat A @f$, @f$ \hat M @f$ and an optional preconditioner are given as
+/// callable objects acting on plain arrays, so that objects such as
+/// `csr_operator` can be used directly. Memory requirements are those of
+/// the matrix-vector products plus a few vectors (@f$ m+1 @f$ vectors for
+/// GMRES restarted every @f$ m @f$ iterations).
+///
+/// | OpKind     | Mode                 | Inner system matrix               |
+/// |------------|----------------------|-----------------------------------|
+/// | Symmetric  | `Inverse`            | @f$ \hat M @f$                    |
+/// | Symmetric  | `ShiftAndInvert`     | @f$ \hat A - \sigma\hat M @f$     |
+/// | Symmetric  | `Buckling`           | @f$ \hat A - \sigma\hat M @f$     |
+/// | Symmetric  | `Cayley`             | @f$ \hat A - \sigma\hat M @f$     |
+/// | Asymmetric | `Inverse`            | @f$ \hat M @f$                    |
+/// | Asymmetric | `ShiftAndInvertReal` | @f$ \hat A - \sigma\hat M @f$     |
+/// | Asymmetric | `ShiftAndInvertImag` | @f$ \hat A - \sigma\hat M @f$     |
+/// | Complex    | `Inverse`            | @f$ \hat M @f$                    |
+/// | Complex    | `ShiftAndInvert`     | @f$ \hat A - \sigma\hat M @f$     |
+///
+/// The roles of @f$ \hat A @f$ and @f$ \hat M @f$ in the Buckling mode are
+/// the same as for `sparse_shift_invert`. For the asymmetric eigenproblems
+/// with a complex shift, inner systems are solved in complex arithmetic, and
+/// the real operators (including the preconditioner) are applied to real and
+/// imaginary parts of vectors separately. CG and MINRES can only be used
+/// when the inner system matrix is Hermitian.
+///
+/// Each inner solve starts from the solution of the previous one, unless
+/// the zero vector is a better initial guess. When a @ref convergence_trace
+/// is attached to both the solver and this object, the inner tolerance is
+/// tied to the outer iteration: it is set to
+/// `tol_factor` @f$ \times\ r @f$ clamped to [`tol`; `max_tol`], where
+/// @f$ r @f$ is the largest Ritz estimate of the wanted Ritz values relative
+/// to the largest Ritz value magnitude (see @ref inner_solver_params). Early
+/// Lanczos/Arnoldi vectors are then computed cheaply, and the inner solves
+/// are tightened as the Ritz pairs converge. Errors of the inner solves
+/// remain in the retained Krylov basis, so `max_tol` also bounds the
+/// attainable accuracy of the eigenpairs.
+///
+/// The operators refer to the object, which must outlive them. They use
+/// internal buffers and must not be applied from concurrent threads.
+///
+/// Example:
+/// @code
+/// using solver_t = arpack_solver<Symmetric, eigen_storage>;
+/// csr_operator<double> A(...), M(...);
+/// iterative_shift_invert<Symmetric> si(N, A, M, solver_t::ShiftAndInvert,
+///                                      sigma);
+/// convergence_trace trace;
+/// solver.set_trace(&trace);
+/// si.set_trace(&trace);
+/// params.sigma = sigma;
+/// solver(si.op(), si.b(), solver_t::ShiftAndInvert, params);
+/// @endcode
+///
+/// @tparam OpKind Kind of eigenproblems to be solved.
+template<operator_kind OpKind> class iterative_shift_invert {
+public:
+  /// Type of vector elements.
+  using scalar_type =
+      typename std::conditional<OpKind == Complex, dcomplex, double>::type;
+  /// Type of the spectral shift.
+  using shift_type =
+      typename std::conditional<OpKind == Symmetric, double, dcomplex>::type;
+  /// Type of linear operators @f$ \hat A @f$, @f$ \hat M @f$ and of
+  /// the preconditioner. They are called as `f(x, y)` to compute
+  /// @f$ \mathbf{y} = \hat F\mathbf{x} @f$ for arrays of size @ref dim().
+  using operator_type =
+      std::function<void(scalar_type const*, scalar_type*)>;
+
+private:
+  template<operator_kind K>
+  using kind = std::integral_constant<operator_kind, K>;
+
+  int n_;                      // Dimension
+  operator_type A_;            // Operator A
+  operator_type M_;            // Operator M (identity if empty)
+  operator_type P_;            // Preconditioner (identity if empty)
+  int mode_;                   // Computational mode
+  shift_type sigma_;           // Spectral shift
+  inner_solver_params params_; // Parameters of the inner solver
+
+  // Convergence trace of the outer iteration
+  convergence_trace const* trace_ = nullptr;
+
+  mutable inner_solver_stats stats_;
+  mutable krylov_solver<scalar_type> solver_;
+  mutable krylov_solver<dcomplex> complex_solver_;
+
+  // Temporary vectors
+  mutable std::vector<scalar_type> tmp_, tmp2_, tmp3_;
+  mutable std::vector<double> re_, im_, re2_, im2_;
+  mutable std::vector<dcomplex> complex_rhs_, complex_x_;
+
+public:
+  /// Linear operator @f$ \hat O @f$.
+  class op_type {
+    iterative_shift_invert const* parent_;
+
+  public:
+    /// @internal
+    explicit op_type(iterative_shift_invert const* parent)
+        : parent_(parent) {}
+
+    /// Acts with @f$ \hat O @f$ on `in` and writes the result into `out`.
+    template<typename In, typename Out>
+    void operator()(In&& in, Out&& out) const {
+      parent_->apply_op(view_data(in), view_data(out), kind<OpKind>());
+    }
+  };
+
+  /// Linear operator @f$ \hat B @f$.
+  class b_type {
+    iterative_shift_invert const* parent_;
+
+  public:
+    /// @internal
+    explicit b_type(iterative_shift_invert const* parent) : parent_(parent) {}
+
+    /// Acts with @f$ \hat B @f$ on `in` and writes the result into `out`.
+    template<typename In, typename Out>
+    void operator()(In&& in, Out&& out) const {
+      parent_->apply_b(view_data(in), view_data(out));
+    }
+  };
+
+  /// Constructs operators of a generalized eigenproblem.
+  /// @param n Dimension of the eigenproblem.
+  /// @param A Linear operator @f$ \hat A @f$.
+  /// @param M Linear operator @f$ \hat M @f$.
+  /// @param mode Computational mode of `arpack_solver<OpKind, Backend>`, such
+  /// as `arpack_solver<OpKind, Backend>::ShiftAndInvert`.
+  /// @param sigma Spectral shift @f$ \sigma @f$. It is not used in
+  /// the Inverse mode.
+  /// @param params Parameters of the inner solver.
+  /// @throws std::runtime_error Invalid dimension, mode, shift or inner
+  /// solver parameters.
+  iterative_shift_invert(int n,
+                         operator_type A,
+                         operator_type M,
+                         int mode,
+                         shift_type sigma = shift_type(0),
+                         inner_solver_params const& params =
+                             inner_solver_params())
+      : n_(n),
+        A_(std::move(A)),
+        M_(std::move(M)),
+        mode_(mode),
+        sigma_(sigma),
+        params_(params) {
+    init();
+  }
+
+  /// Constructs operators of a standard eigenproblem
+  /// (@f$ \hat M @f$ is the identity matrix).
+  /// @param n Dimension of the eigenproblem.
+  /// @param A Linear operator @f$ \hat A @f$.
+  /// @param mode Computational mode of `arpack_solver<OpKind, Backend>`, such
+  /// as `arpack_solver<OpKind, Backend>::ShiftAndInvert`.
+  /// @param sigma Spectral shift @f$ \sigma @f$.
+  /// @param params Parameters of the inner solver.
+  /// @throws std::runtime_error Invalid dimension, mode, shift or inner
+  /// solver parameters.
+  iterative_shift_invert(int n,
+                         operator_type A,
+                         int mode,
+                         shift_type sigma = shift_type(0),
+                         inner_solver_params const& params =
+                             inner_solver_params())
+      : iterative_shift_invert(n,
+                               std::move(A),
+                               operator_type(),
+                               mode,
+                               sigma,
+                               params) {}
+
+  iterative_shift_invert(iterative_shift_invert const&) = delete;
+  iterative_shift_invert& operator=(iterative_shift_invert const&) = delete;
+
+  /// Dimension of the eigenproblem.
+  int dim() const { return n_; }
+
+  /// Computational mode.
+  int mode() const { return mode_; }
+
+  /// Spectral shift.
+  shift_type sigma() const { return sigma_; }
+
+  /// Changes the spectral shift. Solutions of the previous inner solves are
+  /// discarded.
+  /// @param sigma New spectral shift.
+  /// @throws std::runtime_error Invalid shift.
+  void set_sigma(shift_type sigma) {
+    sigma_ = sigma;
+    validate();
+    solver_.reset();
+    complex_solver_.reset();
+  }
+
+  /// Parameters of the inner solver.
+  inner_solver_params const& inner_params() const { return params_; }
+
+  /// Sets parameters of the inner solver.
+  /// @param params New parameters.
+  /// @throws std::runtime_error Invalid parameters.
+  void set_inner_params(inner_solver_params const& params) {
+    params_ = params;
+    validate();
+  }
+
+  /// Sets a preconditioner. It approximates the inverse of the inner system
+  /// matrix and must be Hermitian positive definite for CG and MINRES.
+  /// @param P Preconditioner. An empty object resets it to the identity.
+  void set_preconditioner(operator_type P) { P_ = std::move(P); }
+
+  /// Ties the inner tolerance to Ritz estimates recorded in a convergence
+  /// trace. The same trace should be attached to the solver with
+  /// `arpack_solver::set_trace()`.
+  /// @param trace Pointer to the trace. A null pointer unties the inner
+  /// tolerance.
+  void set_trace(convergence_trace const* trace) { trace_ = trace; }
+
+  /// Statistics of the inner solves performed so far.
+  inner_solver_stats const& inner_stats() const { return stats_; }
+
+  /// Resets statistics of the inner solves.
+  void reset_inner_stats() { stats_ = inner_solver_stats(); }
+
+  /// Inner tolerance to be used by the next inner solve.
+  double inner_tol() const {
+    if(!trace_) return params_.tol;
+    if(trace_->empty()) return params_.max_tol;
+    convergence_trace::record const& last = trace_->records().back();
+    double theta_max = 0;
+    for(auto const& theta : last.ritz_values)
+      theta_max = std::max(theta_max, std::abs(theta));
+    if(theta_max == 0) return params_.max_tol;
+    double const tol = params_.tol_factor * last.residual_norm / theta_max;
+    return std::min(params_.max_tol, std::max(params_.tol, tol));
+  }
+
+  /// Returns linear operator @f$ \hat O @f$ to be passed to
+  /// `arpack_solver::operator()` as `op`.
+  op_type op() const { return op_type(this); }
+
+  /// Returns linear operator @f$ \hat B @f$ to be passed to
+  /// `arpack_solver::operator()` as `b`.
+  b_type b() const { return b_type(this); }
+
+private:
+  /// @internal Check arguments and allocate temporary vectors.
+  void init() {
+    if(n_ < 1)
+      throw std::runtime_error(
+          "iterative_shift_invert: Dimension must be positive");
+    if(!A_)
+      throw std::runtime_error(
+          "iterative_shift_invert: Operator A must not be empty");
+    int const max_mode =
+        (OpKind == Symmetric) ? 5 : (OpKind == Asymmetric ? 4 : 3);
+    if(mode_ < 2 || mode_ > max_mode)
+      throw std::runtime_error("iterative_shift_invert: Unsupported mode " +
+                               std::to_string(mode_));
+    validate();
+    tmp_.resize(n_);
+    tmp2_.resize(n_);
+    tmp3_.resize(n_);
+  }
+
+  /// @internal Check the shift and the inner solver parameters.
+  void validate() const {
+    if(params_.tol <= 0 || params_.max_tol < params_.tol)
+      throw std::runtime_error("iterative_shift_invert: Inner tolerances "
+                               "must satisfy 0 < tol <= max_tol");
+    if(params_.max_iterations < 1 || params_.gmres_restart < 1)
+      throw std::runtime_error("iterative_shift_invert: Numbers of inner "
+                               "iterations must be positive");
+    if(OpKind == Asymmetric && mode_ == 4 && std::imag(sigma_) == 0)
+      throw std::runtime_error("iterative_shift_invert: ShiftAndInvertImag "
+                               "mode requires a shift with a non-zero "
+                               "imaginary part");
+    bool const hermitian =
+        (OpKind != Asymmetric || mode_ == 2) && std::imag(sigma_) == 0;
+    if(params_.method != InnerGMRES && !hermitian)
+      throw std::runtime_error("iterative_shift_invert: CG and MINRES "
+                               "require a Hermitian inner system matrix");
+  }
+
+  /// @internal Shift in the arithmetic of inner solves.
+  static double shift_as(dcomplex const& sigma, double*) {
+    return sigma.real();
+  }
+  /// @internal Shift in the arithmetic of inner solves.
+  static dcomplex shift_as(dcomplex const& sigma, dcomplex*) { return sigma; }
+
+  /// @internal Compute y = M x.
+  void apply_M(scalar_type const* x, scalar_type* y) const {
+    if(M_)
+      M_(x, y);
+    else
+      std::copy(x, x + n_, y);
+  }
+
+  /// @internal Compute y = K x, with K the inner system matrix
+  /// (arithmetic of the eigenproblem).
+  void apply_K(scalar_type const* x, scalar_type* y) const {
+    if(mode_ == 2) {
+      M_(x, y);
+      return;
+    }
+    auto const sigma =
+        shift_as(dcomplex(sigma_), static_cast<scalar_type*>(nullptr));
+    A_(x, y);
+    apply_M(x, tmp3_.data());
+    for(int i = 0; i < n_; ++i)
+      y[i] -= sigma * tmp3_[i];
+  }
+
+  /// @internal Compute y = K x in complex arithmetic for real A and M.
+  void apply_K(dcomplex const* x, dcomplex* y, std::false_type) const {
+    split(x);
+    A_(re_.data(), re2_.data());
+    A_(im_.data(), im2_.data());
+    for(int i = 0; i < n_; ++i)
+      y[i] = dcomplex(re2_[i], im2_[i]);
+    apply_M(re_.data(), re2_.data());
+    apply_M(im_.data(), im2_.data());
+    dcomplex const sigma(sigma_);
+    for(int i = 0; i < n_; ++i)
+      y[i] -= sigma * dcomplex(re2_[i], im2_[i]);
+  }
+
+  /// @internal Compute z = P r (arithmetic of the eigenproblem).
+  void apply_P(scalar_type const* r, scalar_type* z) const {
+    if(P_)
+      P_(r, z);
+    else
+      std::copy(r, r + n_, z);
+  }
+
+  /// @internal Compute z = P r in complex arithmetic for a real
+  /// preconditioner.
+  void apply_P(dcomplex const* r, dcomplex* z, std::false_type) const {
+    if(!P_) {
+      std::copy(r, r + n_, z);
+      return;
+    }
+    split(r);
+    P_(re_.data(), re2_.data());
+    P_(im_.data(), im2_.data());
+    for(int i = 0; i < n_; ++i)
+      z[i] = dcomplex(re2_[i], im2_[i]);
+  }
+
+  /// @internal Split a complex vector into real and imaginary parts.
+  void split(dcomplex const* x) const {
+    for(auto* v : {&re_, &im_, &re2_, &im2_})
+      v->resize(n_);
+    for(int i = 0; i < n_; ++i) {
+      re_[i] = x[i].real();
+      im_[i] = x[i].imag();
+    }
+  }
+
+  /// @internal Solve K y = rhs with the inner solver.
+  template<typename T, typename KOp, typename POp>
+  void inner_solve(krylov_solver<T>& solver,
+                   KOp&& K,
+                   POp&& P,
+                   T const* rhs,
+                   T* y) const {
+    double const tol = inner_tol();
+    auto res = solver.solve(params_.method, n_, K, P, rhs, tol,
+                            params_.max_iterations, params_.gmres_restart,
+                            params_.warm_start);
+    std::copy(solver.solution(), solver.solution() + n_, y);
+
+    ++stats_.n_solves;
+    stats_.n_iterations += res.iterations;
+    if(!res.converged) ++stats_.n_unconverged;
+    stats_.last_iterations = res.iterations;
+    stats_.last_tol = tol;
+    stats_.last_residual = res.residual;
+  }
+
+  /// @internal Solve K y = rhs in the arithmetic of the eigenproblem.
+  void solve(scalar_type const* rhs, scalar_type* y) const {
+    if(mode_ == 2 && !M_) {
+      std::copy(rhs, rhs + n_, y);
+      return;
+    }
+    inner_solve(
+        solver_,
+        [this](scalar_type const* x, scalar_type* Kx) { apply_K(x, Kx); },
+        [this](scalar_type const* r, scalar_type* z) { apply_P(r, z); }, rhs,
+        y);
+  }
+
+  /// @internal Act with O, symmetric eigenproblems.
+  ///
+  /// In the Inverse mode, the input vector is overwritten with
+  /// @f$ \hat A\mathbf{x} @f$ as required by `dsaupd()`.
+  void apply_op(scalar_type* in, scalar_type* out, kind<Symmetric>) const {
+    switch(mode_) {
+      case 2: // Inverse
+        A_(in, tmp_.data());
+        std::copy(tmp_.begin(), tmp_.end(), in);
+        solve(tmp_.data(), out);
+        break;
+      case 3: // ShiftAndInvert
+        apply_M(in, tmp_.data());
+        solve(tmp_.data(), out);
+        break;
+      case 4: // Buckling
+        A_(in, tmp_.data());
+        solve(tmp_.data(), out);
+        break;
+      case 5: // Cayley
+        apply_M(in, tmp_.data());
+        A_(in, tmp2_.data());
+        for(int i = 0; i < n_; ++i)
+          tmp_[i] = tmp2_[i] + sigma_ * tmp_[i];
+        solve(tmp_.data(), out);
+        break;
+    }
+  }
+
+  /// @internal Act with O, asymmetric eigenproblems.
+  void
+  apply_op(scalar_type const* in, scalar_type* out, kind<Asymmetric>) const {
+    if(mode_ == 2) { // Inverse
+      A_(in, tmp_.data());
+      solve(tmp_.data(), out);
+      return;
+    }
+    apply_M(in, tmp_.data());
+    if(sigma_.imag() == 0) {
+      solve(tmp_.data(), out);
+      return;
+    }
+    complex_rhs_.assign(tmp_.begin(), tmp_.end());
+    complex_x_.resize(n_);
+    inner_solve(
+        complex_solver_,
+        [this](dcomplex const* x, dcomplex* y) {
+          apply_K(x, y, std::false_type());
+        },
+        [this](dcomplex const* r, dcomplex* z) {
+          apply_P(r, z, std::false_type());
+        },
+        complex_rhs_.data(), complex_x_.data());
+    for(int i = 0; i < n_; ++i)
+      out[i] = (mode_ == 3) ? complex_x_[i].real() : complex_x_[i].imag();
+  }
+
+  /// @internal Act with O, complex eigenproblems.
+  void apply_op(scalar_type const* in, scalar_type* out, kind<Complex>) const {
+    if(mode_ == 2) // Inverse
+      A_(in, tmp_.data());
+    else // ShiftAndInvert
+      apply_M(in, tmp_.data());
+    solve(tmp_.data(), out);
+  }
+
+  /// @internal Act with B.
+  void apply_b(scalar_type const* in, scalar_type* out) const {
+    if(OpKind == Symmetric && mode_ == 4) // Buckling
+      A_(in, out);
+    else
+      apply_M(in, out);
+  }
+};
+
+} // namespace ezarpack
@@ -0,0 +1,226 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/mpi/halo_operator.hpp
+/// @brief Distributed application of banded linear operators with halo
+/// exchange between neighboring MPI ranks.
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mpi.h>
+
+#include "../view_data.hpp"
+#include "mpi_util.hpp"
+
+namespace ezarpack {
+namespace mpi {
+
+/// @brief Adaptor that applies a banded linear operator to vectors
+/// distributed among MPI ranks.
+///
+/// A banded operator couples a component @f$ y_i @f$ of the output vector only
+/// to components @f$ x_j @f$ of the input vector with
+/// @f$ i - l \leq j \leq i + u @f$, @f$ l @f$ and @f$ u @f$ being its lower and
+/// upper bandwidths. In order to compute the rank-local block of the output
+/// vector, this adaptor receives the missing components of the input vector
+/// (the halo) from the MPI ranks that own them, and then calls the local
+/// kernel.
+///
+/// The adapted kernel must provide methods `dim()`, `lower_bandwidth()`,
+/// `upper_bandwidth()` and `apply_rows(x, y, row_begin, row_end)` with the
+/// semantics of ezarpack::dia_operator and ezarpack::stencil_operator.
+///
+/// Objects of this class can be passed as linear operators to
+/// `mpi::arpack_solver::operator()`, provided that the distribution of vector
+/// blocks among MPI ranks is the same for the adaptor and the solver. The halo
+/// is received in a buffer owned by the adaptor, so an object must not be
+/// applied from concurrent threads.
+///
+/// @tparam Kernel Type of the local kernel.
+template<typename Kernel> class halo_operator {
+
+  Kernel kernel_;
+  MPI_Comm comm_;
+  int block_start_; // Index of the first component of the rank-local block
+  int block_size_;  // Size of the rank-local block
+  int halo_lower_;  // Number of halo components preceding the local block
+  int halo_upper_;  // Number of halo components following the local block
+
+  // Contiguous range of vector components sent to or received from a rank
+  struct transfer {
+    int rank;
+    int start;
+    int size;
+  };
+  std::vector<transfer> sends_;
+  std::vector<transfer> recvs_;
+  mutable std::vector<MPI_Request> requests_;
+
+  // Input vectors extended with the halo
+  mutable std::vector<double> real_buffer_;
+  mutable std::vector<std::complex<double>> complex_buffer_;
+
+public:
+  /// Constructs an adaptor for the most even distribution of vectors among
+  /// MPI ranks, which is also the default distribution used by
+  /// `mpi::arpack_solver`.
+  /// @param kernel Local kernel.
+  /// @param comm MPI communicator.
+  halo_operator(Kernel kernel, MPI_Comm const& comm)
+      : kernel_(std::move(kernel)), comm_(comm) {
+    int const comm_size = size(comm_);
+    int const n = kernel_.dim();
+    std::vector<int> starts(comm_size + 1);
+    for(int r = 0; r < comm_size; ++r)
+      starts[r] = compute_local_block_start(n, comm_size, r);
+    starts[comm_size] = n;
+    make_transfers(starts);
+  }
+
+  /// Constructs an adaptor for a given distribution of vectors among MPI
+  /// ranks.
+  /// @param kernel Local kernel.
+  /// @param block_sizes Sizes of MPI rank-local vector blocks, one element per
+  /// MPI rank.
+  /// @param comm MPI communicator.
+  /// @throws std::runtime_error Block sizes are inconsistent with the
+  /// communicator size or dimension of the kernel.
+  halo_operator(Kernel kernel,
+                std::vector<unsigned int> const& block_sizes,
+                MPI_Comm const& comm)
+      : kernel_(std::move(kernel)), comm_(comm) {
+    int const comm_size = size(comm_);
+    if(int(block_sizes.size()) != comm_size)
+      throw std::runtime_error("halo_operator: Size of 'block_sizes' must "
+                               "coincide with MPI communicator size");
+    std::vector<int> starts(comm_size + 1, 0);
+    std::partial_sum(block_sizes.begin(), block_sizes.end(),
+                     starts.begin() + 1);
+    if(starts[comm_size] != kernel_.dim())
+      throw std::runtime_error("halo_operator: Block sizes must add up to " +
+                               std::to_string(kernel_.dim()));
+    make_transfers(starts);
+  }
+
+  /// Local kernel.
+  Kernel const& kernel() const { return kernel_; }
+
+  /// Index of the first component of the rank-local vector block.
+  int local_block_start() const { return block_start_; }
+
+  /// Size of the rank-local vector block.
+  int local_block_size() const { return block_size_; }
+
+  /// Applies the linear operator to a distributed vector.
+  /// @param in View of the rank-local block of the input vector.
+  /// @param out View of the rank-local block of the output vector.
+  template<typename In, typename Out>
+  void operator()(In&& in, Out&& out) const {
+    apply(view_data(in), view_data(out));
+  }
+
+private:
+  /// @internal Compute ranges of vector components exchanged with other
+  /// ranks.
+  /// @param starts Starting indices of all blocks followed by the dimension.
+  void make_transfers(std::vector<int> const& starts) {
+    int const comm_size = int(starts.size()) - 1;
+    int const comm_rank = rank(comm_);
+    int const n = starts[comm_size];
+    int const lower = kernel_.lower_bandwidth();
+    int const upper = kernel_.upper_bandwidth();
+
+    // Range of input vector components needed to compute block r
+    auto empty = [&](int r) { return starts[r] == starts[r + 1]; };
+    auto needed_begin = [&](int r) {
+      return empty(r) ? starts[r] : std::max(0, starts[r] - lower);
+    };
+    auto needed_end = [&](int r) {
+      return empty(r) ? starts[r] : std::min(n, starts[r + 1] + upper);
+    };
+
+    block_start_ = starts[comm_rank];
+    block_size_ = starts[comm_rank + 1] - block_start_;
+    halo_lower_ = block_start_ - needed_begin(comm_rank);
+    halo_upper_ = needed_end(comm_rank) - starts[comm_rank + 1];
+
+    for(int r = 0; r < comm_size; ++r) {
+      if(r == comm_rank) continue;
+      // Components of block r needed by this rank
+      int begin = std::max(starts[r], needed_begin(comm_rank));
+      int end = std::min(starts[r + 1], needed_end(comm_rank));
+      if(begin < end) recvs_.push_back({r, begin, end - begin});
+      // Components of this rank's block needed by rank r
+      begin = std::max(block_start_, needed_begin(r));
+      end = std::min(block_start_ + block_size_, needed_end(r));
+      if(begin < end) sends_.push_back({r, begin, end - begin});
+    }
+    requests_.resize(recvs_.size() + sends_.size());
+  }
+
+  /// @internal Exchange the halo and call the local kernel.
+  template<typename X, typename Y> void apply(X const* x, Y* y) const {
+    std::vector<X>& buffer = halo_buffer(x);
+    buffer.resize(halo_lower_ + block_size_ + halo_upper_);
+    X* xb = buffer.data() + halo_lower_;
+    std::copy(x, x + block_size_, xb);
+
+    MPI_Request* request = requests_.data();
+    for(auto const& t : recvs_)
+      MPI_Irecv(xb + (t.start - block_start_), t.size, datatype(x), t.rank, 0,
+                comm_, request++);
+    for(auto const& t : sends_)
+      MPI_Isend(x + (t.start - block_start_), t.size, datatype(x), t.rank, 0,
+                comm_, request++);
+    MPI_Waitall(int(requests_.size()), requests_.data(), MPI_STATUSES_IGNORE);
+
+    kernel_.apply_rows(static_cast<X const*>(xb), y, block_start_,
+                       block_start_ + block_size_);
+  }
+
+  /// @internal Halo buffer for real vectors.
+  std::vector<double>& halo_buffer(double const*) const { return real_buffer_; }
+  /// @internal Halo buffer for complex vectors.
+  std::vector<std::complex<double>>&
+  halo_buffer(std::complex<double> const*) const {
+    return complex_buffer_;
+  }
+
+  /// @internal MPI datatype for real vectors.
+  static MPI_Datatype datatype(double const*) { return MPI_DOUBLE; }
+  /// @internal MPI datatype for complex vectors.
+  static MPI_Datatype datatype(std::complex<double> const*) {
+    return MPI_CXX_DOUBLE_COMPLEX;
+  }
+};
+
+/// Makes a @ref halo_operator adaptor object for the most even distribution
+/// of vectors among MPI ranks.
+/// @param kernel Local kernel.
+/// @param comm MPI communicator.
+template<typename Kernel>
+halo_operator<typename std::decay<Kernel>::type>
+make_halo_operator(Kernel&& kernel, MPI_Comm const& comm) {
+  return halo_operator<typename std::decay<Kernel>::type>(
+      std::forward<Kernel>(kernel), comm);
+}
+
+} // namespace mpi
+} // namespace ezarpack
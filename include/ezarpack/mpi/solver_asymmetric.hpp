@@ -16,6 +16,8 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <type_traits>
 #include <numeric>
 #include <utility>
 #include <vector>
@@ -100,11 +102,15 @@ private:
   real_vector_t resid;        // Residual vector
   real_vector_t workd;        // Working space
   int ncv = 0;                // Number of Lanczos vectors to be generated
+  int ncv_alloc = 0;          // Number of Arnoldi vectors allocated for
   real_matrix_t v;            // Matrix with Arnoldi basis vectors
   int ldv = 0;                // Leading dimension of v
   real_vector_t z;            // Flattened matrix with Ritz vectors
+  int z_size = 0;             // Allocated size of z
   int ldz = 0;                // Leading dimension of z
   real_vector_t dr, di;       // Ritz values (real and imaginary parts)
+  real_vector_t workl;        // Working space for the Arnoldi iteration
+  real_vector_t workev;       // WORKEV parameter of dneupd
   int iparam[11];             // Various input/output parameters
   int ipntr[14];              // Starting locations in workd and workl
   int info = 0;               // !=0 to use resid, 0 otherwise
@@ -114,6 +120,20 @@ private:
   double sigmar = 0;          // SIGMAR parameter of pdneupd
   double sigmai = 0;          // SIGMAI parameter of pdneupd
   bool Bx_available_ = false; // Has B*x already been computed?
+  int v_ncv = 0;              // Number of columns allocated in v
+
+  // User-supplied buffer for Arnoldi basis vectors (not owned)
+  double* v_buffer = nullptr;
+  int v_buffer_ncv = 0; // Number of columns in v_buffer
+
+  // Memory placement policy for resid, workd and v
+  placement_policy placement_;
+
+  // Wall time spent in different phases of the last run
+  phase_timings timings_;
+
+  // Recorder of the convergence history (not owned)
+  convergence_trace* trace_ = nullptr;
 
 public:
   /// Input parameters of the Implicitly Restarted Arnoldi Method (IRAM).
@@ -199,6 +219,8 @@ public:
         z(storage::make_real_vector(0)),
         dr(storage::make_real_vector(nev + 1)),
         di(storage::make_real_vector(nev + 1)),
+        workl(storage::make_real_vector(0)),
+        workev(storage::make_real_vector(0)),
         select(storage::make_int_vector(0)) {
     if(comm_size > N)
       throw ARPACK_SOLVER_ERROR("MPI communicator size cannot exceed dimension "
@@ -229,6 +251,8 @@ public:
         z(storage::make_real_vector(0)),
         dr(storage::make_real_vector(nev + 1)),
         di(storage::make_real_vector(nev + 1)),
+        workl(storage::make_real_vector(0)),
+        workev(storage::make_real_vector(0)),
         select(storage::make_int_vector(0)) {
     if(block_sizes.size() != comm_size)
       throw ARPACK_SOLVER_ERROR("Size of 'block_sizes' must coincide with MPI "
@@ -241,6 +265,8 @@ public:
                                 " has zero size");
     block_start = std::accumulate(block_sizes.begin(),
                                   block_sizes.begin() + comm_rank, 0);
+    storage::resize(resid, block_size);
+    storage::resize(workd, 3 * block_size);
 
     iparam[3] = 1;
   }
@@ -252,6 +278,8 @@ public:
     storage::destroy(z);
     storage::destroy(dr);
     storage::destroy(di);
+    storage::destroy(workl);
+    storage::destroy(workev);
     storage::destroy(select);
   }
 
@@ -283,33 +311,20 @@ private:
     which = wh[int(params.eigenvalues_select)];
 
     // Check ncv
-    ncv = params.ncv;
-    if(ncv == -1)
-      ncv = std::min(2 * int(params.n_eigenvalues) + 2, N);
-    else if(ncv <= int(params.n_eigenvalues + 2) || ncv > N)
-      throw ARPACK_SOLVER_ERROR("ncv must be within ]" +
-                                std::to_string(params.n_eigenvalues + 2) + ";" +
-                                std::to_string(N) + "]");
+    ncv = ncv_from_params(params);
+    if(v_buffer && ncv > v_buffer_ncv)
+      throw ARPACK_SOLVER_ERROR("ncv must not exceed the number of columns "
+                                "in the basis buffer (" +
+                                std::to_string(v_buffer_ncv) + ")");
 
-    storage::resize(v, block_size, ncv);
-    ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v)
-                                           : block_size;
+    allocate_workspace(ncv);
 
     // Eigenvectors
     rvec = (params.compute_vectors != params_t::None);
     howmny = params.compute_vectors == params_t::Schur ? 'P' : 'A';
-    storage::resize(select, ncv);
 
-    // According to pdneupd() docs, 'z' is not referenced if howmny == 'P'.
-    // In fact, however, passing a zero-size 'z' in the Schur vector mode
-    // results in a SEGFAULT.
-    if(rvec) {
-      storage::resize(z, block_size * (nev + 1));
-      ldz = block_size;
-    } else {
-      storage::resize(z, 1);
-      ldz = 1;
-    }
+    allocate_ritz_vectors(nev, rvec);
+    ldz = rvec ? block_size : 1;
 
     // Tolerance
     tol = std::max(.0, params.tolerance);
@@ -321,6 +336,80 @@ private:
     if(iparam[2] <= 0)
       throw ARPACK_SOLVER_ERROR(
           "Maximum number of Arnoldi update iterations must be positive");
+
+    timings_ = phase_timings();
+    if(trace_) trace_->clear();
+  }
+
+  /// @internal Grow containers whose size depends on the number of Arnoldi
+  /// vectors.
+  ///
+  /// The containers are never shrunk, so that subsequent runs with the same or
+  /// a smaller number of Arnoldi vectors require no memory allocations.
+  /// @param ncv_required Number of Arnoldi vectors to allocate memory for.
+  void allocate_workspace(int ncv_required) {
+    if(!v_buffer && ncv_required > v_ncv) {
+      storage::resize(v, block_size, ncv_required);
+      ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v)
+                                             : block_size;
+      v_ncv = ncv_required;
+      place_basis();
+    }
+
+    if(ncv_required <= ncv_alloc) return;
+
+    storage::resize(dr, ncv_required);
+    storage::resize(di, ncv_required);
+    storage::resize(workl,
+                    3 * ncv_required * ncv_required + 6 * ncv_required);
+    storage::resize(workev, 3 * ncv_required);
+    storage::resize(select, ncv_required);
+
+    ncv_alloc = ncv_required;
+  }
+
+  /// @internal Apply the memory placement policy to the internally allocated
+  /// matrix with Arnoldi basis vectors.
+  ///
+  /// @return `true` if the kernel has accepted all requested advice.
+  bool place_basis() {
+    std::size_t ld = storage::get_col_spacing(v) >= 0
+                         ? storage::get_col_spacing(v)
+                         : block_size;
+    return apply_placement(storage::get_data_ptr(v), ld * v_ncv, placement_);
+  }
+
+  /// @internal Validate params_t::ncv and substitute its default value if
+  /// necessary.
+  ///
+  /// @param params Set of input parameters for the IRAM.
+  /// @return Number of Arnoldi vectors to be generated.
+  int ncv_from_params(params_t const& params) const {
+    if(params.ncv == -1)
+      return std::min(2 * int(params.n_eigenvalues) + 2, N);
+    if(params.ncv <= int(params.n_eigenvalues + 2) || params.ncv > N)
+      throw ARPACK_SOLVER_ERROR("ncv must be within ]" +
+                                std::to_string(params.n_eigenvalues + 2) + ";" +
+                                std::to_string(N) + "]");
+    return params.ncv;
+  }
+
+  /// @internal Pointer to the storage of Arnoldi basis vectors.
+  double* v_data() { return v_buffer ? v_buffer : storage::get_data_ptr(v); }
+
+  /// @internal Grow the container for Ritz/Schur vectors.
+  ///
+  /// @param nev_required Number of eigenvalues to allocate memory for.
+  /// @param rvec_required Are Ritz/Schur vectors going to be computed?
+  void allocate_ritz_vectors(int nev_required, bool rvec_required) {
+    // According to pdneupd() docs, 'z' is not referenced if howmny == 'P'.
+    // In fact, however, passing a zero-size 'z' in the Schur vector mode
+    // results in a SEGFAULT.
+    int z_size_required = rvec_required ? block_size * (nev_required + 1) : 1;
+    if(z_size_required > z_size) {
+      storage::resize(z, z_size_required);
+      z_size = z_size_required;
+    }
   }
 
 public:
@@ -400,16 +489,17 @@ public:
     iparam[6] = 1; // Mode 1, standard eigenproblem
 
     const int workl_size = 3 * ncv * ncv + 6 * ncv;
-    real_vector_t workl = storage::make_real_vector(workl_size);
 
     rci_flag ido = Init;
     Bx_available_ = false;
+    stopwatch watch;
     do {
       f77::paupd<false>(comm, ido, "I", block_size, which, nev, tol,
-                        storage::get_data_ptr(resid), ncv,
-                        storage::get_data_ptr(v), ldv, iparam, ipntr,
-                        storage::get_data_ptr(workd),
+                        storage::get_data_ptr(resid), ncv, v_data(), ldv,
+                        iparam, ipntr, storage::get_data_ptr(workd),
                         storage::get_data_ptr(workl), workl_size, info);
+      if(trace_) observe_trace(ido);
+      watch.lap(timings_.aupd);
       switch(ido) {
         case ApplyOpInit:
         case ApplyOp: {
@@ -417,6 +507,7 @@ public:
           int out_pos = out_vector_n() * block_size;
           a(storage::make_vector_const_view(workd, in_pos, block_size),
             storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.op);
         } break;
         case Shifts: {
           int np = iparam[7];
@@ -425,31 +516,24 @@ public:
                    storage::make_vector_const_view(workl, ipntr[7] - 1, ncv),
                    storage::make_vector_view(workl, ipntr[13] - 1, np),
                    storage::make_vector_view(workl, ipntr[13] - 1 + np, np));
+          watch.lap(timings_.shifts);
         } break;
         case Done: break;
-        default: {
-          storage::destroy(workl);
+        default:
           throw ARPACK_SOLVER_ERROR("Reverse communication interface error");
-        }
       }
     } while(ido != Done);
 
-    handle_paupd_error_codes(info, workl);
-
-    storage::resize(dr, nev + 1);
-    storage::resize(di, nev + 1);
-    real_vector_t workev = storage::make_real_vector(3 * ncv);
+    handle_paupd_error_codes(info);
 
     f77::peupd(comm, rvec, &howmny, storage::get_data_ptr(select),
                storage::get_data_ptr(dr), storage::get_data_ptr(di),
                storage::get_data_ptr(z), ldz, sigmar, sigmai,
                storage::get_data_ptr(workev), "I", block_size, which, nev, tol,
-               storage::get_data_ptr(resid), ncv, storage::get_data_ptr(v), ldv,
-               iparam, ipntr, storage::get_data_ptr(workd),
-               storage::get_data_ptr(workl), workl_size, info);
-
-    storage::destroy(workev);
-    storage::destroy(workl);
+               storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam, ipntr,
+               storage::get_data_ptr(workd), storage::get_data_ptr(workl),
+               workl_size, info);
+    watch.lap(timings_.eupd);
 
     handle_peupd_error_codes(info);
   }
@@ -587,16 +671,17 @@ public:
     iparam[6] = mode; // Modes 2-4, generalized eigenproblem
 
     const int workl_size = 3 * ncv * ncv + 6 * ncv;
-    real_vector_t workl = storage::make_real_vector(workl_size);
 
     rci_flag ido = Init;
     Bx_available_ = false;
+    stopwatch watch;
     do {
       f77::paupd<false>(comm, ido, "G", block_size, which, nev, tol,
-                        storage::get_data_ptr(resid), ncv,
-                        storage::get_data_ptr(v), ldv, iparam, ipntr,
-                        storage::get_data_ptr(workd),
+                        storage::get_data_ptr(resid), ncv, v_data(), ldv,
+                        iparam, ipntr, storage::get_data_ptr(workd),
                         storage::get_data_ptr(workl), workl_size, info);
+      if(trace_) observe_trace(ido);
+      watch.lap(timings_.aupd);
       switch(ido) {
         case ApplyOpInit: {
           int in_pos = in_vector_n() * block_size;
@@ -604,6 +689,7 @@ public:
           Bx_available_ = false;
           op(storage::make_vector_const_view(workd, in_pos, block_size),
              storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.op);
         } break;
         case ApplyOp: {
           int in_pos = in_vector_n() * block_size;
@@ -612,12 +698,14 @@ public:
           Bx_available_ = true;
           op(storage::make_vector_const_view(workd, in_pos, block_size),
              storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.op);
         } break;
         case ApplyB: {
           int in_pos = in_vector_n() * block_size;
           int out_pos = out_vector_n() * block_size;
           b(storage::make_vector_const_view(workd, in_pos, block_size),
             storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.b);
         } break;
         case Shifts: {
           int np = iparam[7];
@@ -626,35 +714,29 @@ public:
                    storage::make_vector_const_view(workl, ipntr[7] - 1, ncv),
                    storage::make_vector_view(workl, ipntr[13] - 1, np),
                    storage::make_vector_view(workl, ipntr[13] - 1 + np, np));
+          watch.lap(timings_.shifts);
         } break;
         case Done: break;
-        default: {
-          storage::destroy(workl);
+        default:
           throw ARPACK_SOLVER_ERROR("Reverse communication interface error");
-        }
       }
     } while(ido != Done);
 
-    handle_paupd_error_codes(info, workl);
+    handle_paupd_error_codes(info);
 
-    storage::resize(dr, nev + 1);
-    storage::resize(di, nev + 1);
     if(mode != Inverse) {
       sigmar = params.sigma.real();
       sigmai = params.sigma.imag();
     }
-    real_vector_t workev = storage::make_real_vector(3 * ncv);
 
     f77::peupd(comm, rvec, &howmny, storage::get_data_ptr(select),
                storage::get_data_ptr(dr), storage::get_data_ptr(di),
                storage::get_data_ptr(z), ldz, sigmar, sigmai,
                storage::get_data_ptr(workev), "G", block_size, which, nev, tol,
-               storage::get_data_ptr(resid), ncv, storage::get_data_ptr(v), ldv,
-               iparam, ipntr, storage::get_data_ptr(workd),
-               storage::get_data_ptr(workl), workl_size, info);
-
-    storage::destroy(workev);
-    storage::destroy(workl);
+               storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam, ipntr,
+               storage::get_data_ptr(workd), storage::get_data_ptr(workl),
+               workl_size, info);
+    watch.lap(timings_.eupd);
 
     handle_peupd_error_codes(info);
   }
@@ -718,15 +800,17 @@ public:
   /// last run) and is primarily intended for use in the @ref ShiftAndInvertReal
   /// and @ref ShiftAndInvertImag modes.
   /// @param a A callable object representing the linear operator
-  /// @f$ \hat A @f$.
+  /// @f$ \hat A @f$. If it is a @ref block_operator, then @f$ \hat A @f$ is
+  /// applied to all Ritz vectors in a single call. If it is
+  /// a @ref thread_safe_operator, then the Ritz vectors are processed
+  /// concurrently.
   /// @throws std::runtime_error Ritz vectors have not been computed in the
   /// last IRAM run.
   template<typename A> complex_vector_t eigenvalues(A&& a) const {
     if((!rvec) || (howmny != 'A'))
       throw ARPACK_SOLVER_ERROR(
           "Invalid method call: Ritz vectors have not been computed");
-    auto eig = storage::make_asymm_eigenvalues(z, di, std::forward<A>(a),
-                                               block_size, nconv());
+    auto eig = rayleigh_quotients(a);
     MPI_Allreduce(MPI_IN_PLACE, storage::get_data_ptr(eig), nconv(),
                   MPI_CXX_DOUBLE_COMPLEX, MPI_SUM, comm);
     return eig;
@@ -743,14 +827,81 @@ public:
     return storage::make_asymm_eigenvectors(z, di, block_size, nconv());
   }
 
+  /// Returns a lazy view of MPI rank-local block of the `i`-th converged Ritz
+  /// vector (eigenvector).
+  ///
+  /// Components of the vector are computed on demand from ARPACK-NG's internal
+  /// representation of Ritz vectors, and no memory is allocated. The view is
+  /// invalidated by the next IRAM run.
+  /// @param i Index of the Ritz vector.
+  /// @throws std::runtime_error Ritz vectors have not been computed in the
+  /// last IRAM run.
+  /// @throws std::runtime_error `i` is not below @ref nconv().
+  ritz_vector_view eigenvector_view(unsigned int i) const {
+    if((!rvec) || (howmny != 'A'))
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Ritz vectors have not been computed");
+    if(i >= nconv())
+      throw ARPACK_SOLVER_ERROR("Index of a Ritz vector must be within [0;" +
+                                std::to_string(nconv()) + ")");
+    return asymm_ritz_vector(z_data(), di_data(), block_size, i);
+  }
+
+  /// Returns MPI rank-local block of the `i`-th converged Ritz vector
+  /// (eigenvector).
+  ///
+  /// Unlike @ref eigenvectors(), this method allocates memory for only one
+  /// vector.
+  /// @param i Index of the Ritz vector.
+  /// @throws std::runtime_error Ritz vectors have not been computed in the
+  /// last IRAM run.
+  /// @throws std::runtime_error `i` is not below @ref nconv().
+  complex_vector_t eigenvector(unsigned int i) const {
+    auto view = eigenvector_view(i);
+    complex_vector_t x = storage::make_complex_vector(block_size);
+    view.copy_to(storage::get_data_ptr(x));
+    return x;
+  }
+
+  /// Writes MPI rank-local blocks of all @ref nconv() converged Ritz vectors
+  /// (eigenvectors) into a caller-owned buffer.
+  ///
+  /// The buffer must accommodate a column-major matrix with
+  /// @ref local_block_size() rows and @ref nconv() columns.
+  /// @param dest Pointer to the first element of the buffer.
+  /// @param ld Leading dimension of the buffer. `-1` stands for
+  /// @ref local_block_size().
+  /// @throws std::runtime_error Ritz vectors have not been computed in the
+  /// last IRAM run.
+  /// @throws std::runtime_error Invalid buffer pointer or leading dimension.
+  void eigenvectors_into(dcomplex* dest, int ld = -1) const {
+    if((!rvec) || (howmny != 'A'))
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Ritz vectors have not been computed");
+    if(dest == nullptr)
+      throw ARPACK_SOLVER_ERROR("Destination pointer must not be null");
+    if(ld == -1)
+      ld = block_size;
+    else if(ld < block_size)
+      throw ARPACK_SOLVER_ERROR("Leading dimension of the destination must be "
+                                "at least " + std::to_string(block_size));
+    asymm_ritz_vectors(z_data(), di_data(), block_size, nconv(), dest, ld);
+  }
+
   /// Returns a view of a matrix, whose @ref nconv() columns are
   /// MPI rank-local blocks of Schur basis vectors.
   /// @throws std::runtime_error Schur vectors have not been computed in the
   /// last IRAM run.
+  /// @throws std::runtime_error Schur vectors have been written into
+  /// a user-supplied basis buffer.
   real_matrix_const_view_t schur_vectors() const {
     if(!rvec)
       throw ARPACK_SOLVER_ERROR(
           "Invalid method call: Schur vectors have not been computed");
+    if(v_buffer)
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Schur vectors have been written into "
+          "the basis buffer");
     return storage::make_matrix_const_view(v, block_size, nconv());
   }
 
@@ -783,6 +934,8 @@ public:
     unsigned int n_b_x_operations;
     /// Total number of steps of re-orthogonalization.
     unsigned int n_reorth_steps;
+    /// Wall time spent in different phases of the run.
+    phase_timings timings;
   };
 
   /// Returns computation statistics from the last IRAM run.
@@ -792,17 +945,297 @@ public:
     s.n_op_x_operations = iparam[8];
     s.n_b_x_operations = iparam[9];
     s.n_reorth_steps = iparam[10];
+    s.timings = timings_;
     return s;
   }
 
+  /// Sizes of internal data buffers (in bytes) required to run the IRAM.
+  ///
+  /// The sizes are computed from dimensions of the arrays passed to ARPACK-NG
+  /// routines and do not include padding that some storage backends may add
+  /// between matrix columns. Sizes of distributed arrays refer to
+  /// the local block stored by the calling MPI rank.
+  struct memory_footprint_t {
+    /// Residual vector.
+    std::size_t resid;
+    /// Working space of the reverse communication interface (WORKD).
+    std::size_t workd;
+    /// Matrix with Arnoldi basis vectors.
+    std::size_t v;
+    /// Real parts of Ritz values.
+    std::size_t dr;
+    /// Imaginary parts of Ritz values.
+    std::size_t di;
+    /// Matrix with Ritz vectors.
+    std::size_t z;
+    /// Working space of the Arnoldi iteration (WORKL).
+    std::size_t workl;
+    /// WORKEV parameter of pdneupd().
+    std::size_t workev;
+    /// SELECT parameter of pdneupd().
+    std::size_t select;
+
+    /// Total size of all buffers.
+    std::size_t total() const {
+      return resid + workd + v + dr + di + z + workl + workev + select;
+    }
+  };
+
+  /// Returns sizes of internal data buffers needed to run the IRAM with
+  /// a given set of input parameters.
+  ///
+  /// This method does not allocate memory. Since the buffers are never shrunk,
+  /// the actually allocated amount of memory is the maximum over all runs
+  /// performed so far.
+  /// A basis buffer supplied by the caller via set_basis_buffer() is not
+  /// counted.
+  /// @param params Set of input parameters for the Implicitly Restarted Arnoldi
+  /// Method.
+  /// @throws std::runtime_error Invalid value of params_t::ncv.
+  memory_footprint_t memory_footprint(params_t const& params) const {
+    const std::size_t n = block_size;
+    const std::size_t m = ncv_from_params(params);
+    const std::size_t k = params.n_eigenvalues + 1;
+    const bool rv = (params.compute_vectors != params_t::None);
+
+    memory_footprint_t f;
+    f.resid = n * sizeof(double);
+    f.workd = 3 * n * sizeof(double);
+    f.v = v_buffer ? 0 : n * m * sizeof(double);
+    f.dr = m * sizeof(double);
+    f.di = m * sizeof(double);
+    f.z = (rv ? n * k : 1) * sizeof(double);
+    f.workl = (3 * m * m + 6 * m) * sizeof(double);
+    f.workev = 3 * m * sizeof(double);
+    f.select = m * sizeof(int);
+    return f;
+  }
+
+  /// Allocates internal data buffers for up to `ncv_max` Arnoldi vectors.
+  ///
+  /// Subsequent runs with params_t::ncv not exceeding `ncv_max` will not
+  /// reallocate the working space of the IRAM.
+  /// @param ncv_max Maximal number of Arnoldi vectors to be generated.
+  /// @throws std::runtime_error `ncv_max` is not within [1;N].
+  void reserve(unsigned int ncv_max) {
+    if(ncv_max < 1 || int(ncv_max) > N)
+      throw ARPACK_SOLVER_ERROR("ncv_max must be within [1;" +
+                                std::to_string(N) + "]");
+    allocate_workspace(ncv_max);
+  }
+
+  /// Allocates all internal data buffers needed to run the IRAM with
+  /// a given set of input parameters.
+  ///
+  /// This method reserves working space for params_t::ncv Arnoldi vectors
+  /// and memory for Ritz/Schur vectors if they are requested by `params`.
+  /// @param params Set of input parameters for the Implicitly Restarted Arnoldi
+  /// Method.
+  /// @throws std::runtime_error Invalid value of params_t::ncv.
+  void reserve(params_t const& params) {
+    allocate_workspace(ncv_from_params(params));
+    allocate_ritz_vectors(params.n_eigenvalues,
+                          params.compute_vectors != params_t::None);
+  }
+
+  /// Makes the solver store Arnoldi basis vectors in a user-supplied buffer
+  /// instead of an internally allocated matrix.
+  ///
+  /// The buffer is used by all subsequent runs until @ref reset_basis_buffer()
+  /// is called. It must accommodate a column-major matrix with
+  /// @ref local_block_size() rows and `ncv_max` columns, and it must outlive
+  /// all runs that use it. Schur vectors computed by a run are written into its
+  /// first @ref nconv() columns.
+  /// Ritz and Schur vectors computed by earlier runs become unavailable.
+  ///
+  /// @param buffer Pointer to the first element of the buffer.
+  /// @param ncv_max Number of columns in the buffer. Runs with params_t::ncv
+  /// exceeding this number will be rejected.
+  /// @param ld Leading dimension of the buffer. `-1` stands for
+  /// @ref local_block_size().
+  /// @throws std::runtime_error Invalid buffer pointer or dimensions.
+  void set_basis_buffer(double* buffer, unsigned int ncv_max, int ld = -1) {
+    if(buffer == nullptr)
+      throw ARPACK_SOLVER_ERROR("Basis buffer pointer must not be null");
+    if(ncv_max < 1 || int(ncv_max) > N)
+      throw ARPACK_SOLVER_ERROR("ncv_max must be within [1;" +
+                                std::to_string(N) + "]");
+    if(ld == -1)
+      ld = block_size;
+    else if(ld < block_size)
+      throw ARPACK_SOLVER_ERROR("Leading dimension of the basis buffer must "
+                                "be at least " + std::to_string(block_size));
+
+    v_buffer = buffer;
+    v_buffer_ncv = ncv_max;
+    ldv = ld;
+    rvec = false;
+  }
+
+  /// Makes the solver store Arnoldi basis vectors in the internally allocated
+  /// matrix again.
+  ///
+  /// Ritz and Schur vectors computed by earlier runs become unavailable.
+  void reset_basis_buffer() {
+    v_buffer = nullptr;
+    v_buffer_ncv = 0;
+    ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v)
+                                           : block_size;
+    rvec = false;
+  }
+
+  /// Sets the memory placement policy for the residual vector, the working
+  /// space of the reverse communication interface (WORKD) and the matrix
+  /// with Arnoldi basis vectors.
+  ///
+  /// The policy is applied to the currently allocated buffers right away
+  /// and to the buffers allocated by subsequent runs. Pages that have
+  /// already been touched are migrated if the kernel allows it. A buffer
+  /// passed to @ref set_basis_buffer() is not affected.
+  /// @param policy Memory placement policy.
+  /// @return `true` if the kernel has accepted all requested advice.
+  bool set_placement(placement_policy const& policy) {
+    placement_ = policy;
+    bool ok = true;
+    ok &= apply_placement(storage::get_data_ptr(resid), block_size,
+                          placement_);
+    ok &= apply_placement(storage::get_data_ptr(workd), 3 * block_size,
+                          placement_);
+    ok &= place_basis();
+    return ok;
+  }
+
+  /// Returns the current memory placement policy.
+  placement_policy const& placement() const { return placement_; }
+
+  /// Attaches a recorder of the convergence history to the solver.
+  ///
+  /// During subsequent runs, Ritz values and Ritz estimates computed at every
+  /// implicit restart are stored in the recorder. The recorder is not owned by
+  /// the solver and must outlive all such runs.
+  /// @param trace Recorder, or `nullptr` to stop recording.
+  void set_trace(convergence_trace* trace) { trace_ = trace; }
+
+  /// Returns the recorder set by @ref set_trace().
+  convergence_trace* trace() const { return trace_; }
+
 private:
+  /// @internal Pass Ritz values and Ritz estimates stored in WORKL to
+  /// the convergence trace.
+  void observe_trace(rci_flag ido) {
+    double const* w = storage::get_data_ptr(workl);
+    trace_->observe(ido, iparam, ncv, nev, tol, w + ipntr[5] - 1,
+                    w + ipntr[6] - 1, w + ipntr[7] - 1);
+  }
+
+  /// @internal Pointer to the data array of z.
+  double const* z_data() const {
+    // get_data_ptr() is not required to accept constant containers
+    return storage::get_data_ptr(const_cast<real_vector_t&>(z));
+  }
+
+  /// @internal Pointer to the data array of di.
+  double const* di_data() const {
+    return storage::get_data_ptr(const_cast<real_vector_t&>(di));
+  }
+
+  /// @internal Compute eigenvalues as Rayleigh quotients of the Ritz vectors.
+  template<typename A> complex_vector_t rayleigh_quotients(A& a) const {
+    complex_vector_t lambda = storage::make_complex_vector(nconv());
+    rayleigh_quotients(a, storage::get_data_ptr(lambda),
+                       is_block_operator<typename std::decay<A>::type>());
+    return lambda;
+  }
+
+  /// @internal Apply a block operator to the first chunks of z in a single
+  /// call and compute the Rayleigh quotients.
+  template<typename A>
+  void rayleigh_quotients(A& a, dcomplex* lambda, std::true_type) const {
+    int const n_chunks = asymm_ritz_chunks(di_data(), nconv());
+    if(n_chunks == 0) return;
+    real_vector_t az = storage::make_real_vector(block_size * n_chunks);
+    try {
+      a(storage::make_vector_const_view(z, 0, block_size * n_chunks),
+        storage::make_vector_view(az, 0, block_size * n_chunks), n_chunks);
+    } catch(...) {
+      storage::destroy(az);
+      throw;
+    }
+    asymm_rayleigh_quotients(z_data(), storage::get_data_ptr(az), di_data(),
+                             block_size, nconv(), lambda);
+    storage::destroy(az);
+  }
+
+  /// @internal Apply an operator to the Ritz vectors one by one and compute
+  /// the Rayleigh quotients. Thread-safe operators are applied concurrently.
+  ///
+  /// Each thread copies chunks of z into its own scratch vector of the local
+  /// block size before applying the operator, so that the views passed to
+  /// the operator do not start at offsets that may exceed the range of `int`.
+  template<typename A>
+  void rayleigh_quotients(A& a, dcomplex* lambda, std::false_type) const {
+    // Chunks holding real Ritz vectors and real parts of complex Ritz vectors
+    int const n = nconv();
+    double const* di_ptr = di_data();
+    std::vector<int> starts;
+    for(int i = 0; i < n; i += (di_ptr[i] == 0) ? 1 : 2)
+      starts.push_back(i);
+    int const n_starts = int(starts.size());
+
+    int const n_threads =
+        is_thread_safe_operator<typename std::decay<A>::type>::value
+            ? std::min(parallel_concurrency(), n_starts)
+            : std::min(1, n_starts);
+    parallel_for(n_threads, [&](int t) {
+      real_vector_t x = storage::make_real_vector(block_size);
+      real_vector_t ax = storage::make_real_vector(block_size);
+      double* x_ptr = storage::get_data_ptr(x);
+      double const* ax_ptr = storage::get_data_ptr(ax);
+      // Apply the operator to a chunk of z and return scalar products of
+      // the result with chunks x1 and x2 of z
+      auto apply = [&](double const* chunk, double const* x1,
+                       double const* x2, double& s1, double& s2) {
+        std::copy(chunk, chunk + block_size, x_ptr);
+        a(storage::make_vector_const_view(x, 0, block_size),
+          storage::make_vector_view(ax, 0, block_size));
+        s1 = s2 = 0;
+        for(int k = 0; k < block_size; ++k) {
+          s1 += x1[k] * ax_ptr[k];
+          s2 += x2[k] * ax_ptr[k];
+        }
+      };
+      try {
+        for(int p = t; p < n_starts; p += n_threads) {
+          int const i = starts[p];
+          double const* x1 = z_data() + std::ptrdiff_t(i) * block_size;
+          double s11, s21, s12, s22;
+          if(di_ptr[i] == 0) {
+            apply(x1, x1, x1, s11, s21);
+            lambda[i] = s11;
+          } else {
+            double const* x2 = x1 + block_size;
+            apply(x1, x1, x2, s11, s21);
+            apply(x2, x1, x2, s12, s22);
+            lambda[i] = dcomplex(s11 + s22, s12 - s21);
+            if(i + 1 < n) lambda[i + 1] = std::conj(lambda[i]);
+          }
+        }
+      } catch(...) {
+        storage::destroy(x);
+        storage::destroy(ax);
+        throw;
+      }
+      storage::destroy(x);
+      storage::destroy(ax);
+    });
+  }
+
   /// @internal Translate pdnaupd's INFO codes into C++ exceptions.
   ///
   /// @param error_code pdnaupd's INFO code.
-  void handle_paupd_error_codes(int error_code, real_vector_t& workl) {
+  void handle_paupd_error_codes(int error_code) {
     if(error_code == 0) return;
 
-    storage::destroy(workl);
     switch(error_code) {
       case 1: throw(maxiter_reached(iparam[2]));
       case 3: throw(ncv_insufficient(ncv));
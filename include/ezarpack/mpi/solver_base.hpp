@@ -20,6 +20,12 @@
 
 #include "parpack.hpp"
 
+#include "../block_operator.hpp"
+#include "../convergence_trace.hpp"
+#include "../parallel.hpp"
+#include "../placement.hpp"
+#include "../ritz_kernels.hpp"
+#include "../timing.hpp"
 #include "../storages/base.hpp"
 
 namespace ezarpack {
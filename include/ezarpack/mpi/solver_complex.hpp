@@ -16,6 +16,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
 #include <numeric>
 #include <utility>
 #include <vector>
@@ -97,11 +98,17 @@ private:
   complex_vector_t resid;     // Residual vector
   complex_vector_t workd;     // Working space
   int ncv = 0;                // Number of Lanczos vectors to be generated
+  int ncv_alloc = 0;          // Number of Arnoldi vectors allocated for
   complex_matrix_t v;         // Matrix with Arnoldi basis vectors
   int ldv = 0;                // Leading dimension of v
   complex_matrix_t z;         // Matrix with Ritz vectors
+  int z_rows = 0;             // Allocated number of rows in z
+  int z_cols = 0;             // Allocated number of columns in z
   int ldz = 0;                // Leading dimension of z
   complex_vector_t d;         // Ritz values (real and imaginary parts)
+  complex_vector_t workl;     // Working space for the Arnoldi iteration
+  complex_vector_t workev;    // WORKEV parameter of pzneupd
+  real_vector_t rwork;        // RWORK parameter of znaupd and pzneupd
   int iparam[11];             // Various input/output parameters
   int ipntr[14];              // Starting locations in workd and workl
   int info = 0;               // !=0 to use resid, 0 otherwise
@@ -109,6 +116,24 @@ private:
   char howmny;                // HOWMNY parameter of pzneupd
   int_vector_t select;        // SELECT parameter of pzneupd
   bool Bx_available_ = false; // Has B*x already been computed?
+  int v_ncv = 0;              // Number of columns allocated in v
+
+  // User-supplied buffer for Arnoldi basis vectors (not owned)
+  dcomplex* v_buffer = nullptr;
+  int v_buffer_ncv = 0; // Number of columns in v_buffer
+
+  // User-supplied buffer for Ritz vectors (not owned)
+  dcomplex* z_buffer = nullptr;
+  int z_buffer_nev = 0; // Number of columns in z_buffer
+
+  // Memory placement policy for resid, workd and v
+  placement_policy placement_;
+
+  // Wall time spent in different phases of the last run
+  phase_timings timings_;
+
+  // Recorder of the convergence history (not owned)
+  convergence_trace* trace_ = nullptr;
 
 public:
   /// Input parameters of the Implicitly Restarted Arnoldi Method (IRAM).
@@ -193,6 +218,9 @@ public:
         v(storage::make_complex_matrix(block_size, 0)),
         z(storage::make_complex_matrix(0, 0)),
         d(storage::make_complex_vector(nev + 1)),
+        workl(storage::make_complex_vector(0)),
+        workev(storage::make_complex_vector(0)),
+        rwork(storage::make_real_vector(0)),
         select(storage::make_int_vector(0)) {
     if(comm_size > N)
       throw ARPACK_SOLVER_ERROR("MPI communicator size cannot exceed dimension "
@@ -222,6 +250,9 @@ public:
         v(storage::make_complex_matrix(block_size, 0)),
         z(storage::make_complex_matrix(0, 0)),
         d(storage::make_complex_vector(nev + 1)),
+        workl(storage::make_complex_vector(0)),
+        workev(storage::make_complex_vector(0)),
+        rwork(storage::make_real_vector(0)),
         select(storage::make_int_vector(0)) {
     if(block_sizes.size() != comm_size)
       throw ARPACK_SOLVER_ERROR("Size of 'block_sizes' must coincide with MPI "
@@ -234,6 +265,8 @@ public:
                                 " has zero size");
     block_start = std::accumulate(block_sizes.begin(),
                                   block_sizes.begin() + comm_rank, 0);
+    storage::resize(resid, block_size);
+    storage::resize(workd, 3 * block_size);
 
     iparam[3] = 1;
   }
@@ -244,6 +277,9 @@ public:
     storage::destroy(v);
     storage::destroy(z);
     storage::destroy(d);
+    storage::destroy(workl);
+    storage::destroy(workev);
+    storage::destroy(rwork);
     storage::destroy(select);
   }
 
@@ -275,33 +311,30 @@ private:
     which = wh[int(params.eigenvalues_select)];
 
     // Check ncv
-    ncv = params.ncv;
-    if(ncv == -1)
-      ncv = std::min(2 * int(params.n_eigenvalues) + 2, N);
-    else if(ncv <= int(params.n_eigenvalues + 1) || ncv > N)
-      throw ARPACK_SOLVER_ERROR("ncv must be within ]" +
-                                std::to_string(params.n_eigenvalues + 1) + ";" +
-                                std::to_string(N) + "]");
+    ncv = ncv_from_params(params);
+    if(v_buffer && ncv > v_buffer_ncv)
+      throw ARPACK_SOLVER_ERROR("ncv must not exceed the number of columns "
+                                "in the basis buffer (" +
+                                std::to_string(v_buffer_ncv) + ")");
 
-    storage::resize(v, block_size, ncv);
-    ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v)
-                                           : block_size;
+    allocate_workspace(ncv);
 
     // Eigenvectors
     rvec = (params.compute_vectors != params_t::None);
     howmny = params.compute_vectors == params_t::Schur ? 'P' : 'A';
-    storage::resize(select, ncv);
 
-    // According to pzneupd() docs, 'z' is not referenced if howmny == 'P'.
-    // In fact, however, passing a zero-size 'z' in the Schur vector mode
-    // results in a SEGFAULT.
-    if(rvec) {
-      storage::resize(z, block_size, nev + 1);
-      ldz = storage::get_col_spacing(z) >= 0 ? storage::get_col_spacing(z)
-                                             : block_size;
+    if(z_buffer) {
+      if(rvec && nev > z_buffer_nev)
+        throw ARPACK_SOLVER_ERROR("n_eigenvalues must not exceed the number "
+                                  "of columns in the eigenvector buffer (" +
+                                  std::to_string(z_buffer_nev) + ")");
     } else {
-      storage::resize(z, 1, 1);
-      ldz = 1;
+      allocate_ritz_vectors(nev, rvec);
+      if(rvec)
+        ldz = storage::get_col_spacing(z) >= 0 ? storage::get_col_spacing(z)
+                                               : block_size;
+      else
+        ldz = 1;
     }
 
     // Tolerance
@@ -314,6 +347,85 @@ private:
     if(iparam[2] <= 0)
       throw ARPACK_SOLVER_ERROR(
           "Maximum number of Arnoldi update iterations must be positive");
+
+    timings_ = phase_timings();
+    if(trace_) trace_->clear();
+  }
+
+  /// @internal Grow containers whose size depends on the number of Arnoldi
+  /// vectors.
+  ///
+  /// The containers are never shrunk, so that subsequent runs with the same or
+  /// a smaller number of Arnoldi vectors require no memory allocations.
+  /// @param ncv_required Number of Arnoldi vectors to allocate memory for.
+  void allocate_workspace(int ncv_required) {
+    if(!v_buffer && ncv_required > v_ncv) {
+      storage::resize(v, block_size, ncv_required);
+      ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v)
+                                             : block_size;
+      v_ncv = ncv_required;
+      place_basis();
+    }
+
+    if(ncv_required <= ncv_alloc) return;
+
+    storage::resize(d, ncv_required);
+    storage::resize(workl,
+                    3 * ncv_required * ncv_required + 5 * ncv_required);
+    storage::resize(workev, 2 * ncv_required);
+    storage::resize(rwork, ncv_required);
+    storage::resize(select, ncv_required);
+
+    ncv_alloc = ncv_required;
+  }
+
+  /// @internal Apply the memory placement policy to the internally allocated
+  /// matrix with Arnoldi basis vectors.
+  ///
+  /// @return `true` if the kernel has accepted all requested advice.
+  bool place_basis() {
+    std::size_t ld = storage::get_col_spacing(v) >= 0
+                         ? storage::get_col_spacing(v)
+                         : block_size;
+    return apply_placement(storage::get_data_ptr(v), ld * v_ncv, placement_);
+  }
+
+  /// @internal Validate params_t::ncv and substitute its default value if
+  /// necessary.
+  ///
+  /// @param params Set of input parameters for the IRAM.
+  /// @return Number of Arnoldi vectors to be generated.
+  int ncv_from_params(params_t const& params) const {
+    if(params.ncv == -1)
+      return std::min(2 * int(params.n_eigenvalues) + 2, N);
+    if(params.ncv <= int(params.n_eigenvalues + 1) || params.ncv > N)
+      throw ARPACK_SOLVER_ERROR("ncv must be within ]" +
+                                std::to_string(params.n_eigenvalues + 1) + ";" +
+                                std::to_string(N) + "]");
+    return params.ncv;
+  }
+
+  /// @internal Pointer to the storage of Arnoldi basis vectors.
+  dcomplex* v_data() { return v_buffer ? v_buffer : storage::get_data_ptr(v); }
+
+  /// @internal Pointer to the storage of Ritz vectors.
+  dcomplex* z_data() { return z_buffer ? z_buffer : storage::get_data_ptr(z); }
+
+  /// @internal Grow the container for Ritz/Schur vectors.
+  ///
+  /// @param nev_required Number of eigenvalues to allocate memory for.
+  /// @param rvec_required Are Ritz/Schur vectors going to be computed?
+  void allocate_ritz_vectors(int nev_required, bool rvec_required) {
+    // According to pzneupd() docs, 'z' is not referenced if howmny == 'P'.
+    // In fact, however, passing a zero-size 'z' in the Schur vector mode
+    // results in a SEGFAULT.
+    int z_rows_required = rvec_required ? block_size : 1;
+    int z_cols_required = rvec_required ? nev_required + 1 : 1;
+    if(z_rows_required > z_rows || z_cols_required > z_cols) {
+      z_rows = std::max(z_rows, z_rows_required);
+      z_cols = std::max(z_cols, z_cols_required);
+      storage::resize(z, z_rows, z_cols);
+    }
   }
 
 public:
@@ -386,17 +498,18 @@ public:
     iparam[6] = 1; // Mode 1, standard eigenproblem
 
     const int workl_size = 3 * ncv * ncv + 5 * ncv;
-    complex_vector_t workl = storage::make_complex_vector(workl_size);
-    real_vector_t rwork = storage::make_real_vector(ncv);
 
     rci_flag ido = Init;
     Bx_available_ = false;
+    stopwatch watch;
     do {
       f77::paupd(comm, ido, "I", block_size, which, nev, tol,
-                 storage::get_data_ptr(resid), ncv, storage::get_data_ptr(v),
-                 ldv, iparam, ipntr, storage::get_data_ptr(workd),
+                 storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam,
+                 ipntr, storage::get_data_ptr(workd),
                  storage::get_data_ptr(workl), workl_size,
                  storage::get_data_ptr(rwork), info);
+      if(trace_) observe_trace(ido);
+      watch.lap(timings_.aupd);
       switch(ido) {
         case ApplyOpInit:
         case ApplyOp: {
@@ -404,37 +517,29 @@ public:
           int out_pos = out_vector_n() * block_size;
           a(storage::make_vector_const_view(workd, in_pos, block_size),
             storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.op);
         } break;
         case Shifts: {
           shifts_f(storage::make_vector_const_view(workl, ipntr[5] - 1, ncv),
                    storage::make_vector_const_view(workl, ipntr[7] - 1, ncv),
                    storage::make_vector_view(workl, ipntr[13] - 1, iparam[7]));
+          watch.lap(timings_.shifts);
         } break;
         case Done: break;
-        default: {
-          storage::destroy(rwork);
-          storage::destroy(workl);
+        default:
           throw ARPACK_SOLVER_ERROR("Reverse communication interface error");
-        }
       }
     } while(ido != Done);
 
-    handle_paupd_error_codes(info, rwork, workl);
-
-    storage::resize(d, nev + 1);
-    complex_vector_t workev = storage::make_complex_vector(2 * ncv);
+    handle_paupd_error_codes(info);
 
     f77::peupd(comm, rvec, &howmny, storage::get_data_ptr(select),
-               storage::get_data_ptr(d), storage::get_data_ptr(z), ldz,
-               params.sigma, storage::get_data_ptr(workev), "I", block_size,
-               which, nev, tol, storage::get_data_ptr(resid), ncv,
-               storage::get_data_ptr(v), ldv, iparam, ipntr,
+               storage::get_data_ptr(d), z_data(), ldz, params.sigma,
+               storage::get_data_ptr(workev), "I", block_size, which, nev, tol,
+               storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam, ipntr,
                storage::get_data_ptr(workd), storage::get_data_ptr(workl),
                workl_size, storage::get_data_ptr(rwork), info);
-
-    storage::destroy(workev);
-    storage::destroy(rwork);
-    storage::destroy(workl);
+    watch.lap(timings_.eupd);
 
     handle_peupd_error_codes(info);
   }
@@ -532,17 +637,18 @@ public:
     iparam[6] = mode; // Modes 2-3, generalized eigenproblem
 
     const int workl_size = 3 * ncv * ncv + 5 * ncv;
-    complex_vector_t workl = storage::make_complex_vector(workl_size);
-    real_vector_t rwork = storage::make_real_vector(ncv);
 
     rci_flag ido = Init;
     Bx_available_ = false;
+    stopwatch watch;
     do {
       f77::paupd(comm, ido, "G", block_size, which, nev, tol,
-                 storage::get_data_ptr(resid), ncv, storage::get_data_ptr(v),
-                 ldv, iparam, ipntr, storage::get_data_ptr(workd),
+                 storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam,
+                 ipntr, storage::get_data_ptr(workd),
                  storage::get_data_ptr(workl), workl_size,
                  storage::get_data_ptr(rwork), info);
+      if(trace_) observe_trace(ido);
+      watch.lap(timings_.aupd);
       switch(ido) {
         case ApplyOpInit: {
           int in_pos = in_vector_n() * block_size;
@@ -550,6 +656,7 @@ public:
           Bx_available_ = false;
           op(storage::make_vector_const_view(workd, in_pos, block_size),
              storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.op);
         } break;
         case ApplyOp: {
           int in_pos = in_vector_n() * block_size;
@@ -558,43 +665,36 @@ public:
           Bx_available_ = true;
           op(storage::make_vector_const_view(workd, in_pos, block_size),
              storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.op);
         } break;
         case ApplyB: {
           int in_pos = in_vector_n() * block_size;
           int out_pos = out_vector_n() * block_size;
           b(storage::make_vector_const_view(workd, in_pos, block_size),
             storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.b);
         } break;
         case Shifts: {
           shifts_f(storage::make_vector_const_view(workl, ipntr[5] - 1, ncv),
                    storage::make_vector_const_view(workl, ipntr[7] - 1, ncv),
                    storage::make_vector_view(workl, ipntr[13] - 1, iparam[7]));
+          watch.lap(timings_.shifts);
         } break;
         case Done: break;
-        default: {
-          storage::destroy(rwork);
-          storage::destroy(workl);
+        default:
           throw ARPACK_SOLVER_ERROR("Reverse communication interface error");
-        }
       }
     } while(ido != Done);
 
-    handle_paupd_error_codes(info, rwork, workl);
-
-    storage::resize(d, nev + 1);
-    complex_vector_t workev = storage::make_complex_vector(2 * ncv);
+    handle_paupd_error_codes(info);
 
     f77::peupd(comm, rvec, &howmny, storage::get_data_ptr(select),
-               storage::get_data_ptr(d), storage::get_data_ptr(z), ldz,
-               params.sigma, storage::get_data_ptr(workev), "G", block_size,
-               which, nev, tol, storage::get_data_ptr(resid), ncv,
-               storage::get_data_ptr(v), ldv, iparam, ipntr,
+               storage::get_data_ptr(d), z_data(), ldz, params.sigma,
+               storage::get_data_ptr(workev), "G", block_size, which, nev, tol,
+               storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam, ipntr,
                storage::get_data_ptr(workd), storage::get_data_ptr(workl),
                workl_size, storage::get_data_ptr(rwork), info);
-
-    storage::destroy(workev);
-    storage::destroy(rwork);
-    storage::destroy(workl);
+    watch.lap(timings_.eupd);
 
     handle_peupd_error_codes(info);
   }
@@ -649,10 +749,16 @@ public:
   ///
   /// @throws std::runtime_error Ritz vectors have not been computed in the
   /// last IRAM run.
+  /// @throws std::runtime_error Ritz vectors have been written into
+  /// a user-supplied eigenvector buffer.
   complex_matrix_const_view_t eigenvectors() const {
     if((!rvec) || (howmny != 'A'))
       throw ARPACK_SOLVER_ERROR(
           "Invalid method call: Ritz vectors have not been computed");
+    if(z_buffer)
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Ritz vectors have been written into "
+          "the eigenvector buffer");
     return storage::make_matrix_const_view(z, block_size, nconv());
   }
 
@@ -660,10 +766,16 @@ public:
   /// MPI rank-local blocks of Schur basis vectors.
   /// @throws std::runtime_error Schur vectors have not been computed in the
   /// last IRAM run.
+  /// @throws std::runtime_error Schur vectors have been written into
+  /// a user-supplied basis buffer.
   complex_matrix_const_view_t schur_vectors() const {
     if(!rvec)
       throw ARPACK_SOLVER_ERROR(
           "Invalid method call: Schur vectors have not been computed");
+    if(v_buffer)
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Schur vectors have been written into "
+          "the basis buffer");
     return storage::make_matrix_const_view(v, block_size, nconv());
   }
 
@@ -696,6 +808,8 @@ public:
     unsigned int n_b_x_operations;
     /// Total number of steps of re-orthogonalization.
     unsigned int n_reorth_steps;
+    /// Wall time spent in different phases of the run.
+    phase_timings timings;
   };
 
   /// Returns computation statistics from the last IRAM run.
@@ -705,20 +819,244 @@ public:
     s.n_op_x_operations = iparam[8];
     s.n_b_x_operations = iparam[9];
     s.n_reorth_steps = iparam[10];
+    s.timings = timings_;
     return s;
   }
 
+  /// Sizes of internal data buffers (in bytes) required to run the IRAM.
+  ///
+  /// The sizes are computed from dimensions of the arrays passed to ARPACK-NG
+  /// routines and do not include padding that some storage backends may add
+  /// between matrix columns. Sizes of distributed arrays refer to
+  /// the local block stored by the calling MPI rank.
+  struct memory_footprint_t {
+    /// Residual vector.
+    std::size_t resid;
+    /// Working space of the reverse communication interface (WORKD).
+    std::size_t workd;
+    /// Matrix with Arnoldi basis vectors.
+    std::size_t v;
+    /// Ritz values.
+    std::size_t d;
+    /// Matrix with Ritz vectors.
+    std::size_t z;
+    /// Working space of the Arnoldi iteration (WORKL).
+    std::size_t workl;
+    /// WORKEV parameter of pzneupd().
+    std::size_t workev;
+    /// RWORK parameter of pznaupd() and pzneupd().
+    std::size_t rwork;
+    /// SELECT parameter of pzneupd().
+    std::size_t select;
+
+    /// Total size of all buffers.
+    std::size_t total() const {
+      return resid + workd + v + d + z + workl + workev + rwork + select;
+    }
+  };
+
+  /// Returns sizes of internal data buffers needed to run the IRAM with
+  /// a given set of input parameters.
+  ///
+  /// This method does not allocate memory. Since the buffers are never shrunk,
+  /// the actually allocated amount of memory is the maximum over all runs
+  /// performed so far.
+  /// Buffers supplied by the caller via set_basis_buffer() and
+  /// set_eigenvectors_buffer() are not counted.
+  /// @param params Set of input parameters for the Implicitly Restarted Arnoldi
+  /// Method.
+  /// @throws std::runtime_error Invalid value of params_t::ncv.
+  memory_footprint_t memory_footprint(params_t const& params) const {
+    const std::size_t n = block_size;
+    const std::size_t m = ncv_from_params(params);
+    const std::size_t k = params.n_eigenvalues + 1;
+    const bool rv = (params.compute_vectors != params_t::None);
+
+    memory_footprint_t f;
+    f.resid = n * sizeof(dcomplex);
+    f.workd = 3 * n * sizeof(dcomplex);
+    f.v = v_buffer ? 0 : n * m * sizeof(dcomplex);
+    f.d = m * sizeof(dcomplex);
+    f.z = z_buffer ? 0 : (rv ? n * k : 1) * sizeof(dcomplex);
+    f.workl = (3 * m * m + 5 * m) * sizeof(dcomplex);
+    f.workev = 2 * m * sizeof(dcomplex);
+    f.rwork = m * sizeof(double);
+    f.select = m * sizeof(int);
+    return f;
+  }
+
+  /// Allocates internal data buffers for up to `ncv_max` Arnoldi vectors.
+  ///
+  /// Subsequent runs with params_t::ncv not exceeding `ncv_max` will not
+  /// reallocate the working space of the IRAM.
+  /// @param ncv_max Maximal number of Arnoldi vectors to be generated.
+  /// @throws std::runtime_error `ncv_max` is not within [1;N].
+  void reserve(unsigned int ncv_max) {
+    if(ncv_max < 1 || int(ncv_max) > N)
+      throw ARPACK_SOLVER_ERROR("ncv_max must be within [1;" +
+                                std::to_string(N) + "]");
+    allocate_workspace(ncv_max);
+  }
+
+  /// Allocates all internal data buffers needed to run the IRAM with
+  /// a given set of input parameters.
+  ///
+  /// This method reserves working space for params_t::ncv Arnoldi vectors
+  /// and memory for Ritz/Schur vectors if they are requested by `params`.
+  /// @param params Set of input parameters for the Implicitly Restarted Arnoldi
+  /// Method.
+  /// @throws std::runtime_error Invalid value of params_t::ncv.
+  void reserve(params_t const& params) {
+    allocate_workspace(ncv_from_params(params));
+    allocate_ritz_vectors(params.n_eigenvalues,
+                          !z_buffer &&
+                              params.compute_vectors != params_t::None);
+  }
+
+  /// Makes the solver store Arnoldi basis vectors in a user-supplied buffer
+  /// instead of an internally allocated matrix.
+  ///
+  /// The buffer is used by all subsequent runs until @ref reset_basis_buffer()
+  /// is called. It must accommodate a column-major matrix with
+  /// @ref local_block_size() rows and `ncv_max` columns, and it must outlive
+  /// all runs that use it. Schur vectors computed by a run are written into its
+  /// first @ref nconv() columns.
+  /// Ritz and Schur vectors computed by earlier runs become unavailable.
+  ///
+  /// @param buffer Pointer to the first element of the buffer.
+  /// @param ncv_max Number of columns in the buffer. Runs with params_t::ncv
+  /// exceeding this number will be rejected.
+  /// @param ld Leading dimension of the buffer. `-1` stands for
+  /// @ref local_block_size().
+  /// @throws std::runtime_error Invalid buffer pointer or dimensions.
+  void set_basis_buffer(dcomplex* buffer, unsigned int ncv_max, int ld = -1) {
+    if(buffer == nullptr)
+      throw ARPACK_SOLVER_ERROR("Basis buffer pointer must not be null");
+    if(ncv_max < 1 || int(ncv_max) > N)
+      throw ARPACK_SOLVER_ERROR("ncv_max must be within [1;" +
+                                std::to_string(N) + "]");
+    if(ld == -1)
+      ld = block_size;
+    else if(ld < block_size)
+      throw ARPACK_SOLVER_ERROR("Leading dimension of the basis buffer must "
+                                "be at least " + std::to_string(block_size));
+
+    v_buffer = buffer;
+    v_buffer_ncv = ncv_max;
+    ldv = ld;
+    rvec = false;
+  }
+
+  /// Makes the solver store Arnoldi basis vectors in the internally allocated
+  /// matrix again.
+  ///
+  /// Ritz and Schur vectors computed by earlier runs become unavailable.
+  void reset_basis_buffer() {
+    v_buffer = nullptr;
+    v_buffer_ncv = 0;
+    ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v)
+                                           : block_size;
+    rvec = false;
+  }
+
+  /// Makes pzneupd() write Ritz vectors (eigenvectors) directly into
+  /// a user-supplied buffer instead of an internally allocated matrix.
+  ///
+  /// The buffer is used by all subsequent runs until
+  /// @ref reset_eigenvectors_buffer() is called. It must accommodate
+  /// a column-major matrix with @ref local_block_size() rows and `nev_max`
+  /// columns, and it must outlive all runs that use it. Ritz vectors computed
+  /// by a run are written into its first @ref nconv() columns, and
+  /// @ref eigenvectors() is not available.
+  /// Ritz and Schur vectors computed by earlier runs become unavailable.
+  ///
+  /// @param buffer Pointer to the first element of the buffer.
+  /// @param nev_max Number of columns in the buffer. Runs computing more than
+  /// this number of Ritz vectors will be rejected.
+  /// @param ld Leading dimension of the buffer. `-1` stands for
+  /// @ref local_block_size().
+  /// @throws std::runtime_error Invalid buffer pointer or dimensions.
+  void set_eigenvectors_buffer(dcomplex* buffer,
+                               unsigned int nev_max,
+                               int ld = -1) {
+    if(buffer == nullptr)
+      throw ARPACK_SOLVER_ERROR("Eigenvector buffer pointer must not be null");
+    if(nev_max < 1 || int(nev_max) > N)
+      throw ARPACK_SOLVER_ERROR("nev_max must be within [1;" +
+                                std::to_string(N) + "]");
+    if(ld == -1)
+      ld = block_size;
+    else if(ld < block_size)
+      throw ARPACK_SOLVER_ERROR(
+          "Leading dimension of the eigenvector buffer must be at least " +
+          std::to_string(block_size));
+
+    z_buffer = buffer;
+    z_buffer_nev = nev_max;
+    ldz = ld;
+    rvec = false;
+  }
+
+  /// Makes the solver store Ritz vectors (eigenvectors) in the internally
+  /// allocated matrix again.
+  ///
+  /// Ritz and Schur vectors computed by earlier runs become unavailable.
+  void reset_eigenvectors_buffer() {
+    z_buffer = nullptr;
+    z_buffer_nev = 0;
+    rvec = false;
+  }
+
+  /// Sets the memory placement policy for the residual vector, the working
+  /// space of the reverse communication interface (WORKD) and the matrix
+  /// with Arnoldi basis vectors.
+  ///
+  /// The policy is applied to the currently allocated buffers right away
+  /// and to the buffers allocated by subsequent runs. Pages that have
+  /// already been touched are migrated if the kernel allows it. A buffer
+  /// passed to @ref set_basis_buffer() is not affected.
+  /// @param policy Memory placement policy.
+  /// @return `true` if the kernel has accepted all requested advice.
+  bool set_placement(placement_policy const& policy) {
+    placement_ = policy;
+    bool ok = true;
+    ok &= apply_placement(storage::get_data_ptr(resid), block_size,
+                          placement_);
+    ok &= apply_placement(storage::get_data_ptr(workd), 3 * block_size,
+                          placement_);
+    ok &= place_basis();
+    return ok;
+  }
+
+  /// Returns the current memory placement policy.
+  placement_policy const& placement() const { return placement_; }
+
+  /// Attaches a recorder of the convergence history to the solver.
+  ///
+  /// During subsequent runs, Ritz values and Ritz estimates computed at every
+  /// implicit restart are stored in the recorder. The recorder is not owned by
+  /// the solver and must outlive all such runs.
+  /// @param trace Recorder, or `nullptr` to stop recording.
+  void set_trace(convergence_trace* trace) { trace_ = trace; }
+
+  /// Returns the recorder set by @ref set_trace().
+  convergence_trace* trace() const { return trace_; }
+
 private:
+  /// @internal Pass Ritz values and Ritz estimates stored in WORKL to
+  /// the convergence trace.
+  void observe_trace(rci_flag ido) {
+    dcomplex const* w = storage::get_data_ptr(workl);
+    trace_->observe(ido, iparam, ncv, nev, tol, w + ipntr[5] - 1,
+                    w + ipntr[7] - 1);
+  }
+
   /// @internal Translate pznaupd's INFO codes into C++ exceptions.
   ///
   /// @param error_code pznaupd's INFO code.
-  void handle_paupd_error_codes(int error_code,
-                                real_vector_t& rwork,
-                                complex_vector_t& workl) {
+  void handle_paupd_error_codes(int error_code) {
     if(error_code == 0) return;
 
-    storage::destroy(rwork);
-    storage::destroy(workl);
     switch(error_code) {
       case 1: throw(maxiter_reached(iparam[2]));
       case 3: throw(ncv_insufficient(ncv));
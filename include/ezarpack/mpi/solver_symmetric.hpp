@@ -16,6 +16,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
 #include <numeric>
 #include <utility>
 #include <vector>
@@ -104,15 +105,36 @@ private:
   real_vector_t resid;        // Residual vector
   real_vector_t workd;        // Working space
   int ncv = 0;                // Number of Lanczos vectors to be generated
+  int ncv_alloc = 0;          // Number of Lanczos vectors allocated for
   real_matrix_t v;            // Matrix with Lanczos basis vectors
   int ldv = 0;                // Leading dimension of v
   real_vector_t d;            // Ritz values
+  real_vector_t workl;        // Working space for the Lanczos iteration
   int iparam[11];             // Various input/output parameters
   int ipntr[11];              // Starting locations in workd and workl
   int info = 0;               // !=0 to use resid, 0 otherwise
   int rvec;                   // RVEC parameter of pdseupd
   int_vector_t select;        // SELECT parameter of pdseupd
   bool Bx_available_ = false; // Has B*x already been computed?
+  int v_ncv = 0;              // Number of columns allocated in v
+
+  // User-supplied buffer for Lanczos basis vectors (not owned)
+  double* v_buffer = nullptr;
+  int v_buffer_ncv = 0; // Number of columns in v_buffer
+
+  // User-supplied buffer for Ritz vectors (not owned)
+  double* z_buffer = nullptr;
+  int z_buffer_nev = 0; // Number of columns in z_buffer
+  int ldz = 0;          // Leading dimension of Ritz vectors
+
+  // Memory placement policy for resid, workd and v
+  placement_policy placement_;
+
+  // Wall time spent in different phases of the last run
+  phase_timings timings_;
+
+  // Recorder of the convergence history (not owned)
+  convergence_trace* trace_ = nullptr;
 
 public:
   /// Input parameters of the Implicitly Restarted Lanczos Method (IRLM).
@@ -189,6 +211,7 @@ public:
         workd(storage::make_real_vector(3 * block_size)),
         v(storage::make_real_matrix(block_size, 0)),
         d(storage::make_real_vector(nev)),
+        workl(storage::make_real_vector(0)),
         select(storage::make_int_vector(0)) {
     if(comm_size > N)
       throw ARPACK_SOLVER_ERROR("MPI communicator size cannot exceed dimension "
@@ -217,6 +240,7 @@ public:
         workd(storage::make_real_vector(3 * block_size)),
         v(storage::make_real_matrix(block_size, 0)),
         d(storage::make_real_vector(nev)),
+        workl(storage::make_real_vector(0)),
         select(storage::make_int_vector(0)) {
     if(block_sizes.size() != comm_size)
       throw ARPACK_SOLVER_ERROR("Size of 'block_sizes' must coincide with MPI "
@@ -229,6 +253,8 @@ public:
                                 " has zero size");
     block_start = std::accumulate(block_sizes.begin(),
                                   block_sizes.begin() + comm_rank, 0);
+    storage::resize(resid, block_size);
+    storage::resize(workd, 3 * block_size);
 
     iparam[3] = 1;
   }
@@ -238,6 +264,7 @@ public:
     storage::destroy(workd);
     storage::destroy(v);
     storage::destroy(d);
+    storage::destroy(workl);
     storage::destroy(select);
   }
 
@@ -268,21 +295,23 @@ private:
     which = wh[int(params.eigenvalues_select)];
 
     // Check ncv
-    ncv = params.ncv;
-    if(ncv == -1)
-      ncv = std::min(2 * int(params.n_eigenvalues) + 2, N);
-    else if(ncv <= int(params.n_eigenvalues) || ncv > N)
-      throw ARPACK_SOLVER_ERROR("ncv must be within ]" +
-                                std::to_string(params.n_eigenvalues) + ";" +
-                                std::to_string(N) + "]");
+    ncv = ncv_from_params(params);
+    if(v_buffer && ncv > v_buffer_ncv)
+      throw ARPACK_SOLVER_ERROR("ncv must not exceed the number of columns "
+                                "in the basis buffer (" +
+                                std::to_string(v_buffer_ncv) + ")");
 
-    storage::resize(v, block_size, ncv);
-    ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v)
-                                           : block_size;
+    allocate_workspace(ncv);
 
     // Eigenvectors
     rvec = params.compute_eigenvectors;
-    storage::resize(select, ncv);
+    if(z_buffer) {
+      if(rvec && nev > z_buffer_nev)
+        throw ARPACK_SOLVER_ERROR("n_eigenvalues must not exceed the number "
+                                  "of columns in the eigenvector buffer (" +
+                                  std::to_string(z_buffer_nev) + ")");
+    } else
+      ldz = ldv;
 
     // Tolerance
     tol = std::max(.0, params.tolerance);
@@ -294,8 +323,67 @@ private:
     if(iparam[2] <= 0)
       throw ARPACK_SOLVER_ERROR(
           "Maximum number of Arnoldi update iterations must be positive");
+
+    timings_ = phase_timings();
+    if(trace_) trace_->clear();
+  }
+
+  /// @internal Grow containers whose size depends on the number of Lanczos
+  /// vectors.
+  ///
+  /// The containers are never shrunk, so that subsequent runs with the same or
+  /// a smaller number of Lanczos vectors require no memory allocations.
+  /// @param ncv_required Number of Lanczos vectors to allocate memory for.
+  void allocate_workspace(int ncv_required) {
+    if(!v_buffer && ncv_required > v_ncv) {
+      storage::resize(v, block_size, ncv_required);
+      ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v)
+                                             : block_size;
+      v_ncv = ncv_required;
+      place_basis();
+    }
+
+    if(ncv_required <= ncv_alloc) return;
+
+    storage::resize(d, ncv_required);
+    storage::resize(workl, ncv_required * ncv_required + 8 * ncv_required);
+    storage::resize(select, ncv_required);
+
+    ncv_alloc = ncv_required;
   }
 
+  /// @internal Apply the memory placement policy to the internally allocated
+  /// matrix with Lanczos basis vectors.
+  ///
+  /// @return `true` if the kernel has accepted all requested advice.
+  bool place_basis() {
+    std::size_t ld = storage::get_col_spacing(v) >= 0
+                         ? storage::get_col_spacing(v)
+                         : block_size;
+    return apply_placement(storage::get_data_ptr(v), ld * v_ncv, placement_);
+  }
+
+  /// @internal Validate params_t::ncv and substitute its default value if
+  /// necessary.
+  ///
+  /// @param params Set of input parameters for the IRLM.
+  /// @return Number of Lanczos vectors to be generated.
+  int ncv_from_params(params_t const& params) const {
+    if(params.ncv == -1)
+      return std::min(2 * int(params.n_eigenvalues) + 2, N);
+    if(params.ncv <= int(params.n_eigenvalues) || params.ncv > N)
+      throw ARPACK_SOLVER_ERROR("ncv must be within ]" +
+                                std::to_string(params.n_eigenvalues) + ";" +
+                                std::to_string(N) + "]");
+    return params.ncv;
+  }
+
+  /// @internal Pointer to the storage of Lanczos basis vectors.
+  double* v_data() { return v_buffer ? v_buffer : storage::get_data_ptr(v); }
+
+  /// @internal Pointer to the storage of Ritz vectors.
+  double* z_data() { return z_buffer ? z_buffer : v_data(); }
+
 public:
   /// If this functor is used to provide shifts for implicit restart,
   /// then the default ARPACK-NG's shift strategy (Exact Shift Strategy)
@@ -366,16 +454,17 @@ public:
     iparam[6] = 1; // Mode 1, standard eigenproblem
 
     const int workl_size = ncv * ncv + 8 * ncv;
-    real_vector_t workl = storage::make_real_vector(workl_size);
 
     rci_flag ido = Init;
     Bx_available_ = false;
+    stopwatch watch;
     do {
       f77::paupd<true>(comm, ido, "I", block_size, which, nev, tol,
-                       storage::get_data_ptr(resid), ncv,
-                       storage::get_data_ptr(v), ldv, iparam, ipntr,
-                       storage::get_data_ptr(workd),
+                       storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam,
+                       ipntr, storage::get_data_ptr(workd),
                        storage::get_data_ptr(workl), workl_size, info);
+      if(trace_) observe_trace(ido);
+      watch.lap(timings_.aupd);
       switch(ido) {
         case ApplyOpInit:
         case ApplyOp: {
@@ -383,32 +472,28 @@ public:
           int out_pos = out_vector_n() * block_size;
           a(storage::make_vector_const_view(workd, in_pos, block_size),
             storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.op);
         } break;
         case Shifts:
           shifts_f(storage::make_vector_const_view(workl, ipntr[5] - 1, ncv),
                    storage::make_vector_const_view(workl, ipntr[6] - 1, ncv),
                    storage::make_vector_view(workl, ipntr[10] - 1, iparam[7]));
+          watch.lap(timings_.shifts);
           break;
         case Done: break;
-        default: {
-          storage::destroy(workl);
+        default:
           throw ARPACK_SOLVER_ERROR("Reverse communication interface error");
-        }
       }
     } while(ido != Done);
 
-    handle_paupd_error_codes(info, workl);
-
-    storage::resize(d, nev);
+    handle_paupd_error_codes(info);
 
     f77::peupd(comm, rvec, "A", storage::get_data_ptr(select),
-               storage::get_data_ptr(d), storage::get_data_ptr(v), ldv,
-               params.sigma, "I", block_size, which, nev, tol,
-               storage::get_data_ptr(resid), ncv, storage::get_data_ptr(v), ldv,
-               iparam, ipntr, storage::get_data_ptr(workd),
+               storage::get_data_ptr(d), z_data(), ldz, params.sigma, "I",
+               block_size, which, nev, tol, storage::get_data_ptr(resid), ncv,
+               v_data(), ldv, iparam, ipntr, storage::get_data_ptr(workd),
                storage::get_data_ptr(workl), workl_size, info);
-
-    storage::destroy(workl);
+    watch.lap(timings_.eupd);
 
     handle_peupd_error_codes(info);
   }
@@ -529,16 +614,17 @@ public:
     iparam[6] = mode; // Modes 2-5, generalized eigenproblem
 
     const int workl_size = ncv * ncv + 8 * ncv;
-    real_vector_t workl = storage::make_real_vector(workl_size);
 
     rci_flag ido = Init;
     Bx_available_ = false;
+    stopwatch watch;
     do {
       f77::paupd<true>(comm, ido, "G", block_size, which, nev, tol,
-                       storage::get_data_ptr(resid), ncv,
-                       storage::get_data_ptr(v), ldv, iparam, ipntr,
-                       storage::get_data_ptr(workd),
+                       storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam,
+                       ipntr, storage::get_data_ptr(workd),
                        storage::get_data_ptr(workl), workl_size, info);
+      if(trace_) observe_trace(ido);
+      watch.lap(timings_.aupd);
       switch(ido) {
         case ApplyOpInit: {
           int in_pos = in_vector_n() * block_size;
@@ -546,6 +632,7 @@ public:
           Bx_available_ = false;
           op(storage::make_vector_view(workd, in_pos, block_size),
              storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.op);
         } break;
         case ApplyOp: {
           int in_pos = in_vector_n() * block_size;
@@ -554,39 +641,37 @@ public:
           Bx_available_ = true;
           op(storage::make_vector_view(workd, in_pos, block_size),
              storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.op);
         } break;
         case ApplyB: {
           int in_pos = in_vector_n() * block_size;
           int out_pos = out_vector_n() * block_size;
           b(storage::make_vector_const_view(workd, in_pos, block_size),
             storage::make_vector_view(workd, out_pos, block_size));
+          watch.lap(timings_.b);
         } break;
         case Shifts:
           shifts_f(storage::make_vector_const_view(workl, ipntr[5] - 1, ncv),
                    storage::make_vector_const_view(workl, ipntr[6] - 1, ncv),
                    storage::make_vector_view(workl, ipntr[10] - 1, iparam[7]));
+          watch.lap(timings_.shifts);
           break;
         case Done: break;
-        default: {
-          storage::destroy(workl);
+        default:
           throw ARPACK_SOLVER_ERROR("Reverse communication interface error");
-        }
       }
     } while(ido != Done);
 
-    handle_paupd_error_codes(info, workl);
+    handle_paupd_error_codes(info);
 
-    storage::resize(d, nev);
     double sigma = (mode != Inverse) ? params.sigma : 0;
 
     f77::peupd(comm, rvec, "A", storage::get_data_ptr(select),
-               storage::get_data_ptr(d), storage::get_data_ptr(v), ldv, sigma,
-               "G", block_size, which, nev, tol, storage::get_data_ptr(resid),
-               ncv, storage::get_data_ptr(v), ldv, iparam, ipntr,
-               storage::get_data_ptr(workd), storage::get_data_ptr(workl),
-               workl_size, info);
-
-    storage::destroy(workl);
+               storage::get_data_ptr(d), z_data(), ldz, sigma, "G", block_size,
+               which, nev, tol, storage::get_data_ptr(resid), ncv, v_data(),
+               ldv, iparam, ipntr, storage::get_data_ptr(workd),
+               storage::get_data_ptr(workl), workl_size, info);
+    watch.lap(timings_.eupd);
 
     handle_peupd_error_codes(info);
   }
@@ -642,10 +727,20 @@ public:
   /// vectors (eigenvectors).
   /// @throws std::runtime_error Ritz vectors have not been computed in the
   /// last IRLM run.
+  /// @throws std::runtime_error Ritz vectors have been written into
+  /// a user-supplied eigenvector or basis buffer.
   real_matrix_const_view_t eigenvectors() const {
     if(!rvec)
       throw ARPACK_SOLVER_ERROR(
           "Invalid method call: Ritz vectors have not been computed");
+    if(z_buffer)
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Ritz vectors have been written into "
+          "the eigenvector buffer");
+    if(v_buffer)
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Ritz vectors have been written into "
+          "the basis buffer");
     return storage::make_matrix_const_view(v, block_size, nconv());
   }
 
@@ -678,6 +773,8 @@ public:
     unsigned int n_b_x_operations;
     /// Total number of steps of re-orthogonalization.
     unsigned int n_reorth_steps;
+    /// Wall time spent in different phases of the run.
+    phase_timings timings;
   };
 
   /// Returns computation statistics from the last IRLM run.
@@ -687,17 +784,230 @@ public:
     s.n_op_x_operations = iparam[8];
     s.n_b_x_operations = iparam[9];
     s.n_reorth_steps = iparam[10];
+    s.timings = timings_;
     return s;
   }
 
+  /// Sizes of internal data buffers (in bytes) required to run the IRLM.
+  ///
+  /// The sizes are computed from dimensions of the arrays passed to ARPACK-NG
+  /// routines and do not include padding that some storage backends may add
+  /// between matrix columns. Sizes of distributed arrays refer to
+  /// the local block stored by the calling MPI rank.
+  struct memory_footprint_t {
+    /// Residual vector.
+    std::size_t resid;
+    /// Working space of the reverse communication interface (WORKD).
+    std::size_t workd;
+    /// Matrix with Lanczos basis vectors.
+    std::size_t v;
+    /// Ritz values.
+    std::size_t d;
+    /// Working space of the Lanczos iteration (WORKL).
+    std::size_t workl;
+    /// SELECT parameter of pdseupd().
+    std::size_t select;
+
+    /// Total size of all buffers.
+    std::size_t total() const {
+      return resid + workd + v + d + workl + select;
+    }
+  };
+
+  /// Returns sizes of internal data buffers needed to run the IRLM with
+  /// a given set of input parameters.
+  ///
+  /// This method does not allocate memory. Since the buffers are never shrunk,
+  /// the actually allocated amount of memory is the maximum over all runs
+  /// performed so far.
+  /// A basis buffer supplied by the caller via set_basis_buffer() is not
+  /// counted.
+  /// @param params Set of input parameters for the Implicitly Restarted Lanczos
+  /// Method.
+  /// @throws std::runtime_error Invalid value of params_t::ncv.
+  memory_footprint_t memory_footprint(params_t const& params) const {
+    const std::size_t n = block_size;
+    const std::size_t m = ncv_from_params(params);
+
+    memory_footprint_t f;
+    f.resid = n * sizeof(double);
+    f.workd = 3 * n * sizeof(double);
+    f.v = v_buffer ? 0 : n * m * sizeof(double);
+    f.d = m * sizeof(double);
+    f.workl = (m * m + 8 * m) * sizeof(double);
+    f.select = m * sizeof(int);
+    return f;
+  }
+
+  /// Allocates internal data buffers for up to `ncv_max` Lanczos vectors.
+  ///
+  /// Subsequent runs with params_t::ncv not exceeding `ncv_max` will not
+  /// reallocate the working space of the IRLM.
+  /// @param ncv_max Maximal number of Lanczos vectors to be generated.
+  /// @throws std::runtime_error `ncv_max` is not within [1;N].
+  void reserve(unsigned int ncv_max) {
+    if(ncv_max < 1 || int(ncv_max) > N)
+      throw ARPACK_SOLVER_ERROR("ncv_max must be within [1;" +
+                                std::to_string(N) + "]");
+    allocate_workspace(ncv_max);
+  }
+
+  /// Allocates all internal data buffers needed to run the IRLM with
+  /// a given set of input parameters.
+  ///
+  /// This method reserves working space for params_t::ncv Lanczos vectors.
+  /// @param params Set of input parameters for the Implicitly Restarted Lanczos
+  /// Method.
+  /// @throws std::runtime_error Invalid value of params_t::ncv.
+  void reserve(params_t const& params) {
+    allocate_workspace(ncv_from_params(params));
+  }
+
+  /// Makes the solver store Lanczos basis vectors in a user-supplied buffer
+  /// instead of an internally allocated matrix.
+  ///
+  /// The buffer is used by all subsequent runs until @ref reset_basis_buffer()
+  /// is called. It must accommodate a column-major matrix with
+  /// @ref local_block_size() rows and `ncv_max` columns, and it must outlive
+  /// all runs that use it. Ritz vectors computed by a run are written into its
+  /// first @ref nconv() columns, unless @ref set_eigenvectors_buffer() is in
+  /// effect.
+  /// Ritz vectors computed by earlier runs become unavailable.
+  ///
+  /// @param buffer Pointer to the first element of the buffer.
+  /// @param ncv_max Number of columns in the buffer. Runs with params_t::ncv
+  /// exceeding this number will be rejected.
+  /// @param ld Leading dimension of the buffer. `-1` stands for
+  /// @ref local_block_size().
+  /// @throws std::runtime_error Invalid buffer pointer or dimensions.
+  void set_basis_buffer(double* buffer, unsigned int ncv_max, int ld = -1) {
+    if(buffer == nullptr)
+      throw ARPACK_SOLVER_ERROR("Basis buffer pointer must not be null");
+    if(ncv_max < 1 || int(ncv_max) > N)
+      throw ARPACK_SOLVER_ERROR("ncv_max must be within [1;" +
+                                std::to_string(N) + "]");
+    if(ld == -1)
+      ld = block_size;
+    else if(ld < block_size)
+      throw ARPACK_SOLVER_ERROR("Leading dimension of the basis buffer must "
+                                "be at least " + std::to_string(block_size));
+
+    v_buffer = buffer;
+    v_buffer_ncv = ncv_max;
+    ldv = ld;
+    rvec = false;
+  }
+
+  /// Makes the solver store Lanczos basis vectors in the internally allocated
+  /// matrix again.
+  ///
+  /// Ritz vectors computed by earlier runs become unavailable.
+  void reset_basis_buffer() {
+    v_buffer = nullptr;
+    v_buffer_ncv = 0;
+    ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v)
+                                           : block_size;
+    rvec = false;
+  }
+
+  /// Makes pdseupd() write Ritz vectors (eigenvectors) directly into
+  /// a user-supplied buffer instead of an internally allocated matrix.
+  ///
+  /// The buffer is used by all subsequent runs until
+  /// @ref reset_eigenvectors_buffer() is called. It must accommodate
+  /// a column-major matrix with @ref local_block_size() rows and `nev_max`
+  /// columns, and it must outlive all runs that use it. Ritz vectors computed
+  /// by a run are written into its first @ref nconv() columns, and
+  /// @ref eigenvectors() is not available.
+  /// Ritz vectors computed by earlier runs become unavailable.
+  ///
+  /// @param buffer Pointer to the first element of the buffer.
+  /// @param nev_max Number of columns in the buffer. Runs computing more than
+  /// this number of Ritz vectors will be rejected.
+  /// @param ld Leading dimension of the buffer. `-1` stands for
+  /// @ref local_block_size().
+  /// @throws std::runtime_error Invalid buffer pointer or dimensions.
+  void set_eigenvectors_buffer(double* buffer,
+                               unsigned int nev_max,
+                               int ld = -1) {
+    if(buffer == nullptr)
+      throw ARPACK_SOLVER_ERROR("Eigenvector buffer pointer must not be null");
+    if(nev_max < 1 || int(nev_max) > N)
+      throw ARPACK_SOLVER_ERROR("nev_max must be within [1;" +
+                                std::to_string(N) + "]");
+    if(ld == -1)
+      ld = block_size;
+    else if(ld < block_size)
+      throw ARPACK_SOLVER_ERROR(
+          "Leading dimension of the eigenvector buffer must be at least " +
+          std::to_string(block_size));
+
+    z_buffer = buffer;
+    z_buffer_nev = nev_max;
+    ldz = ld;
+    rvec = false;
+  }
+
+  /// Makes the solver store Ritz vectors (eigenvectors) in the internally
+  /// allocated matrix again.
+  ///
+  /// Ritz vectors computed by earlier runs become unavailable.
+  void reset_eigenvectors_buffer() {
+    z_buffer = nullptr;
+    z_buffer_nev = 0;
+    rvec = false;
+  }
+
+  /// Sets the memory placement policy for the residual vector, the working
+  /// space of the reverse communication interface (WORKD) and the matrix
+  /// with Lanczos basis vectors.
+  ///
+  /// The policy is applied to the currently allocated buffers right away
+  /// and to the buffers allocated by subsequent runs. Pages that have
+  /// already been touched are migrated if the kernel allows it. A buffer
+  /// passed to @ref set_basis_buffer() is not affected.
+  /// @param policy Memory placement policy.
+  /// @return `true` if the kernel has accepted all requested advice.
+  bool set_placement(placement_policy const& policy) {
+    placement_ = policy;
+    bool ok = true;
+    ok &= apply_placement(storage::get_data_ptr(resid), block_size,
+                          placement_);
+    ok &= apply_placement(storage::get_data_ptr(workd), 3 * block_size,
+                          placement_);
+    ok &= place_basis();
+    return ok;
+  }
+
+  /// Returns the current memory placement policy.
+  placement_policy const& placement() const { return placement_; }
+
+  /// Attaches a recorder of the convergence history to the solver.
+  ///
+  /// During subsequent runs, Ritz values and Ritz estimates computed at every
+  /// implicit restart are stored in the recorder. The recorder is not owned by
+  /// the solver and must outlive all such runs.
+  /// @param trace Recorder, or `nullptr` to stop recording.
+  void set_trace(convergence_trace* trace) { trace_ = trace; }
+
+  /// Returns the recorder set by @ref set_trace().
+  convergence_trace* trace() const { return trace_; }
+
 private:
+  /// @internal Pass Ritz values and Ritz estimates stored in WORKL to
+  /// the convergence trace.
+  void observe_trace(rci_flag ido) {
+    double const* w = storage::get_data_ptr(workl);
+    trace_->observe(ido, iparam, ncv, nev, tol, w + ipntr[5] - 1,
+                    w + ipntr[6] - 1);
+  }
+
   /// @internal Translate pdsaupd's INFO codes into C++ exceptions.
   ///
   /// @param error_code pdsaupd's INFO code.
-  void handle_paupd_error_codes(int error_code, real_vector_t& workl) {
+  void handle_paupd_error_codes(int error_code) {
     if(error_code == 0) return;
 
-    storage::destroy(workl);
     switch(error_code) {
       case 1: throw(maxiter_reached(iparam[2]));
       case 3: throw(ncv_insufficient(ncv));
@@ -0,0 +1,123 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/parallel.hpp
+/// @brief Shared-memory parallelization of independent tasks.
+#pragma once
+
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "thread_pool.hpp"
+
+namespace ezarpack {
+
+/// @brief Calls `f(i)` for all `i` in `[0; n)`.
+///
+/// If a @ref thread_pool has been installed in the calling thread by
+/// a @ref parallel_context, the calls are executed on that pool. Otherwise, if
+/// ezARPACK is compiled with OpenMP support enabled, the calls are distributed
+/// among threads of an OpenMP team. In all other cases, and whenever `n` is 1,
+/// they are made sequentially in the calling thread. If some of the calls
+/// throw, the first caught exception is rethrown after all calls have
+/// completed.
+///
+/// @tparam F Type of the callable object.
+/// @param n Number of calls.
+/// @param f Callable object. It must be safe to call it concurrently.
+template<typename F> void parallel_for(int n, F&& f) {
+  if(n == 1) {
+    f(0);
+    return;
+  }
+  if(thread_pool* pool = thread_pool::current()) {
+    pool->run(n, f);
+    return;
+  }
+
+  std::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for(int i = 0; i < n; ++i) {
+    try {
+      f(i);
+    } catch(...) {
+#ifdef _OPENMP
+#pragma omp critical(ezarpack_parallel_for)
+#endif
+      if(!error) error = std::current_exception();
+    }
+  }
+  if(error) std::rethrow_exception(error);
+}
+
+/// Returns the number of threads that parallel_for() called from the calling
+/// thread distributes its calls among: the size of the current
+/// @ref thread_pool, the maximal number of OpenMP threads, or 1.
+inline int parallel_concurrency() {
+  if(thread_pool* pool = thread_pool::current()) return pool->size();
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+/// @brief Adaptor for callable objects representing linear operators that can
+/// be safely applied to different vectors from concurrent threads.
+///
+/// Post-processing steps that apply a linear operator to many independent
+/// vectors, such as
+/// ezarpack::arpack_solver<Asymmetric, Backend>::eigenvalues(A &&) const,
+/// distribute the applications among threads with parallel_for() when given
+/// an adapted object. The Reverse Communication Interface of ARPACK-NG still
+/// calls the operator sequentially.
+///
+/// @tparam F Type of the adapted callable object.
+template<typename F> class thread_safe_operator {
+  F f;
+
+public:
+  /// Constructs an adaptor object.
+  /// @param f Callable object to adapt.
+  explicit thread_safe_operator(F f) : f(std::move(f)) {}
+
+  /// Applies the linear operator to a vector.
+  /// @param in View of the input vector.
+  /// @param out View of the output vector.
+  template<typename In, typename Out>
+  void operator()(In&& in, Out&& out) const {
+    f(std::forward<In>(in), std::forward<Out>(out));
+  }
+};
+
+/// Makes a @ref thread_safe_operator adaptor object.
+/// @param f Callable object to adapt.
+template<typename F>
+thread_safe_operator<typename std::decay<F>::type>
+make_thread_safe_operator(F&& f) {
+  return thread_safe_operator<typename std::decay<F>::type>(
+      std::forward<F>(f));
+}
+
+/// Detects @ref thread_safe_operator types.
+template<typename T> struct is_thread_safe_operator : std::false_type {};
+template<typename F>
+struct is_thread_safe_operator<thread_safe_operator<F>> : std::true_type {};
+
+} // namespace ezarpack
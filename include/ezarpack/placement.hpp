@@ -0,0 +1,148 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/placement.hpp
+/// @brief Memory placement policies (transparent huge pages and NUMA node
+/// placement) for large internal data buffers.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ezarpack {
+
+/// NUMA placement of memory pages.
+enum numa_placement {
+  NUMADefault,    /**< Leave placement to the process-wide memory policy. */
+  NUMAFirstTouch, /**< Place each page on the NUMA node of the CPU that
+                       first touches it.                                  */
+  NUMAInterleave  /**< Interleave pages over all NUMA nodes the process
+                       is allowed to allocate memory on.                  */
+};
+
+/// @brief Memory placement policy for large data buffers, such as the
+/// Lanczos/Arnoldi basis vectors and the working space of ARPACK-NG.
+///
+/// The policy is advisory. It is translated into `madvise()` and `mbind()`
+/// calls on Linux and ignored on other platforms.
+struct placement_policy {
+
+  /// Ask the kernel to back the buffers with transparent huge pages.
+  bool huge_pages = false;
+
+  /// NUMA placement of the buffers.
+  numa_placement numa = NUMADefault;
+
+  /// Constructs a placement policy object.
+  /// @param huge_pages Ask the kernel to back the buffers with transparent
+  /// huge pages.
+  /// @param numa NUMA placement of the buffers.
+  placement_policy(bool huge_pages = false, numa_placement numa = NUMADefault)
+      : huge_pages(huge_pages), numa(numa) {}
+
+  /// Does this policy require any action?
+  bool is_default() const { return !huge_pages && numa == NUMADefault; }
+};
+
+/// @brief Applies a memory placement policy to a memory region.
+///
+/// Only the memory pages lying entirely within the region are affected.
+/// Pages that have already been touched are migrated to conform to the NUMA
+/// placement, if the kernel allows it. Regions shorter than one page are left
+/// untouched, as are huge page boundaries not fully covered by the region.
+///
+/// @param data Pointer to the beginning of the memory region.
+/// @param size Size of the region in bytes.
+/// @param policy Placement policy to apply.
+/// @return `true` if the kernel has accepted all requested advice.
+inline bool apply_placement(void* data,
+                            std::size_t size,
+                            placement_policy const& policy) {
+  if(policy.is_default() || data == nullptr) return true;
+#ifdef __linux__
+  std::uintptr_t const page = sysconf(_SC_PAGESIZE);
+  std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(data);
+  std::uintptr_t end = begin + size;
+  begin = (begin + page - 1) / page * page;
+  end = end / page * page;
+  if(end <= begin) return true;
+
+  void* addr = reinterpret_cast<void*>(begin);
+  std::size_t const len = end - begin;
+  bool ok = true;
+
+#ifdef MADV_HUGEPAGE
+  if(policy.huge_pages) ok = madvise(addr, len, MADV_HUGEPAGE) == 0 && ok;
+#else
+  if(policy.huge_pages) ok = false;
+#endif
+
+#ifdef SYS_mbind
+  // Constants from <linux/mempolicy.h>, which is not always installed
+  const int mpol_interleave = 3;
+  const int mpol_local = 4;
+  const int mpol_f_mems_allowed = 1 << 2;
+  const unsigned int mpol_mf_move = 1 << 1;
+
+  // Room for up to 1024 NUMA nodes
+  unsigned long nodemask[1024 / (8 * sizeof(unsigned long))] = {};
+  unsigned long const maxnode = 8 * sizeof(nodemask);
+
+  switch(policy.numa) {
+    case NUMAFirstTouch:
+      ok = syscall(SYS_mbind, addr, len, mpol_local, nullptr, 0,
+                   mpol_mf_move) == 0 &&
+           ok;
+      break;
+    case NUMAInterleave:
+      if(syscall(SYS_get_mempolicy, nullptr, nodemask, maxnode, nullptr,
+                 mpol_f_mems_allowed) != 0) {
+        ok = false;
+        break;
+      }
+      ok = syscall(SYS_mbind, addr, len, mpol_interleave, nodemask, maxnode,
+                   mpol_mf_move) == 0 &&
+           ok;
+      break;
+    default: break;
+  }
+#else
+  if(policy.numa != NUMADefault) ok = false;
+#endif
+
+  return ok;
+#else
+  return false;
+#endif
+}
+
+/// @brief Applies a memory placement policy to an array.
+///
+/// @tparam T Array element type.
+/// @param data Pointer to the first element of the array.
+/// @param size Number of elements in the array.
+/// @param policy Placement policy to apply.
+/// @return `true` if the kernel has accepted all requested advice.
+template<typename T>
+inline bool apply_placement(T* data,
+                            std::size_t size,
+                            placement_policy const& policy) {
+  return apply_placement(static_cast<void*>(data), size * sizeof(T), policy);
+}
+
+} // namespace ezarpack
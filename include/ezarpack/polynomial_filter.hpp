@@ -0,0 +1,477 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/polynomial_filter.hpp
+/// @brief Chebyshev polynomial filters targeting eigenvalues of real symmetric
+/// operators within a window.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "arpack_solver.hpp"
+#include "view_data.hpp"
+
+namespace ezarpack {
+
+/// Interval of the real axis.
+struct spectral_interval {
+  /// Lower end of the interval.
+  double lower;
+  /// Upper end of the interval.
+  double upper;
+};
+
+/// Damping of the Gibbs oscillations of a truncated Chebyshev series.
+enum filter_damping {
+  NoDamping,      /**< No damping (Dirichlet kernel). */
+  JacksonDamping, /**< Jackson kernel. */
+  SigmaDamping    /**< Lanczos @f$ \sigma @f$-factors. */
+};
+
+/// @internal Number of eigenvalues of a symmetric tridiagonal matrix smaller
+/// than `x` (Sturm sequence count).
+///
+/// @param alpha Diagonal elements.
+/// @param beta Subdiagonal elements.
+/// @param x Argument.
+inline int tridiagonal_count(std::vector<double> const& alpha,
+                             std::vector<double> const& beta,
+                             double x) {
+  double const tiny = std::numeric_limits<double>::min();
+  int count = 0;
+  double q = 1;
+  for(std::size_t i = 0; i < alpha.size(); ++i) {
+    double const b2 = (i == 0) ? 0 : beta[i - 1] * beta[i - 1];
+    q = alpha[i] - x - b2 / q;
+    if(q == 0) q = -tiny;
+    if(q < 0) ++count;
+  }
+  return count;
+}
+
+/// @internal Computes the `k`-th smallest eigenvalue of a symmetric
+/// tridiagonal matrix by bisection.
+///
+/// @param alpha Diagonal elements.
+/// @param beta Subdiagonal elements.
+/// @param k Index of the eigenvalue, starting from 0.
+inline double tridiagonal_eigenvalue(std::vector<double> const& alpha,
+                                     std::vector<double> const& beta,
+                                     int k) {
+  // Gershgorin bounds
+  double lo = std::numeric_limits<double>::max();
+  double hi = -std::numeric_limits<double>::max();
+  for(std::size_t i = 0; i < alpha.size(); ++i) {
+    double r = 0;
+    if(i > 0) r += std::abs(beta[i - 1]);
+    if(i + 1 < alpha.size()) r += std::abs(beta[i]);
+    lo = std::min(lo, alpha[i] - r);
+    hi = std::max(hi, alpha[i] + r);
+  }
+  double const eps = std::numeric_limits<double>::epsilon();
+  while(hi - lo > 2 * eps * std::max(std::abs(lo), std::abs(hi))) {
+    double const mid = (lo + hi) / 2;
+    if(mid == lo || mid == hi) break;
+    if(tridiagonal_count(alpha, beta, mid) > k)
+      hi = mid;
+    else
+      lo = mid;
+  }
+  return (lo + hi) / 2;
+}
+
+/// @internal Damping factors @f$ g_k @f$, @f$ k = 0, \ldots, d @f$, of
+/// a truncated Chebyshev series of degree @f$ d @f$.
+///
+/// @param degree Degree of the series.
+/// @param damping Damping of the Gibbs oscillations.
+inline std::vector<double> chebyshev_damping_factors(int degree,
+                                                     filter_damping damping) {
+  double const pi = std::acos(-1.0);
+  std::vector<double> g(degree + 1, 1.0);
+  switch(damping) {
+    case NoDamping: break;
+    case JacksonDamping: {
+      double const q = pi / (degree + 2);
+      for(int k = 1; k <= degree; ++k) {
+        g[k] = ((degree + 2 - k) * std::cos(k * q) +
+                std::sin(k * q) / std::tan(q)) /
+               (degree + 2);
+      }
+    } break;
+    case SigmaDamping: {
+      double const q = pi / (degree + 1);
+      for(int k = 1; k <= degree; ++k)
+        g[k] = std::sin(k * q) / (k * q);
+    } break;
+  }
+  return g;
+}
+
+/// @internal Damped Chebyshev expansion coefficients of the indicator function
+/// of a window, with respect to the Chebyshev polynomials of the first kind in
+/// @f$ (\lambda - c)/e @f$, where @f$ c @f$ and @f$ e @f$ are the center and
+/// the half-width of the spectral bounds.
+///
+/// @param window Window.
+/// @param bounds Bounds of the spectrum.
+/// @param degree Degree of the series.
+/// @param damping Damping of the Gibbs oscillations.
+inline std::vector<double>
+chebyshev_window_coefficients(spectral_interval window,
+                              spectral_interval bounds,
+                              int degree,
+                              filter_damping damping) {
+  double const pi = std::acos(-1.0);
+  double const c = (bounds.upper + bounds.lower) / 2;
+  double const e = (bounds.upper - bounds.lower) / 2;
+  auto to_unit = [c, e](double lambda) {
+    return std::max(-1.0, std::min(1.0, (lambda - c) / e));
+  };
+  double const theta_a = std::acos(to_unit(window.lower));
+  double const theta_b = std::acos(to_unit(window.upper));
+
+  std::vector<double> coeffs = chebyshev_damping_factors(degree, damping);
+  coeffs[0] *= (theta_a - theta_b) / pi;
+  for(int k = 1; k <= degree; ++k)
+    coeffs[k] *= 2 * (std::sin(k * theta_a) - std::sin(k * theta_b)) / (k * pi);
+  return coeffs;
+}
+
+/// @brief Estimates bounds of the spectrum of a real symmetric linear
+/// operator with a few steps of the Lanczos algorithm.
+///
+/// The extreme Ritz values of the Lanczos tridiagonal matrix are widened by
+/// the norm of the last residual vector, which makes the interval enclose
+/// the spectrum for all practical purposes. The starting vector is
+/// pseudo-random with a fixed seed, so that the estimate is reproducible.
+///
+/// @tparam Backend Storage backend used to allocate the Lanczos vectors.
+/// @param a Linear operator @f$ \hat A @f$ called as
+/// `a(vector_const_view_t in, vector_view_t out)`, where the view types are
+/// those of `arpack_solver<Symmetric, Backend>`.
+/// @param N Dimension of the operator.
+/// @param n_steps Number of Lanczos steps.
+/// @param seed Seed of the pseudo-random starting vector.
+/// @return Interval containing the spectrum of @f$ \hat A @f$.
+template<typename Backend, typename A>
+spectral_interval estimate_spectral_bounds(A&& a,
+                                           int N,
+                                           int n_steps = 20,
+                                           unsigned int seed = 0) {
+  using storage = storage_traits<Backend>;
+  using real_vector_t = typename storage::real_vector_type;
+
+  if(N < 1)
+    throw std::runtime_error(
+        "estimate_spectral_bounds: Dimension must be positive");
+  n_steps = std::max(1, std::min(n_steps, N));
+
+  // Previous, current and next Lanczos vectors
+  real_vector_t vecs[3] = {storage::make_real_vector(N),
+                           storage::make_real_vector(N),
+                           storage::make_real_vector(N)};
+  int i_prev = 0, i_v = 1, i_w = 2;
+  auto data = [&](int i) { return storage::get_data_ptr(vecs[i]); };
+
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  double norm2 = 0;
+  for(int i = 0; i < N; ++i) {
+    data(i_prev)[i] = 0;
+    data(i_v)[i] = dist(gen);
+    norm2 += data(i_v)[i] * data(i_v)[i];
+  }
+  for(int i = 0; i < N; ++i)
+    data(i_v)[i] /= std::sqrt(norm2);
+
+  std::vector<double> alpha, beta;
+  double beta_last = 0;
+  for(int j = 0; j < n_steps; ++j) {
+    a(storage::make_vector_const_view(vecs[i_v], 0, N),
+      storage::make_vector_view(vecs[i_w]));
+    double const* v_prev = data(i_prev);
+    double const* v = data(i_v);
+    double* w = data(i_w);
+    double al = 0;
+    for(int i = 0; i < N; ++i)
+      al += v[i] * w[i];
+    norm2 = 0;
+    for(int i = 0; i < N; ++i) {
+      w[i] -= al * v[i] + beta_last * v_prev[i];
+      norm2 += w[i] * w[i];
+    }
+    alpha.push_back(al);
+    beta_last = std::sqrt(norm2);
+    if(beta_last == 0 || j + 1 == n_steps) break;
+    beta.push_back(beta_last);
+
+    for(int i = 0; i < N; ++i)
+      w[i] /= beta_last;
+    int const i_free = i_prev;
+    i_prev = i_v;
+    i_v = i_w;
+    i_w = i_free;
+  }
+
+  for(auto& vec : vecs)
+    storage::destroy(vec);
+
+  int const m = int(alpha.size());
+  return {tridiagonal_eigenvalue(alpha, beta, 0) - beta_last,
+          tridiagonal_eigenvalue(alpha, beta, m - 1) + beta_last};
+}
+
+/// @brief Chebyshev polynomial filter @f$ p(\hat A) @f$ of a real symmetric
+/// linear operator @f$ \hat A @f$, which targets its eigenvalues within
+/// a window @f$ [a; b] @f$.
+///
+/// The filter is a truncated Chebyshev series of degree @f$ d @f$
+/// approximating the indicator function of the window on the spectrum of
+/// @f$ \hat A @f$, optionally damped to suppress the Gibbs oscillations.
+/// Eigenvectors of @f$ p(\hat A) @f$ coincide with those of @f$ \hat A @f$,
+/// and the eigenvalues within the window are mapped onto the largest
+/// eigenvalues of @f$ p(\hat A) @f$ (close to 1), while the rest of
+/// the spectrum is mapped close to 0. Running the Implicitly Restarted Lanczos
+/// Method on @f$ p(\hat A) @f$ thus finds interior eigenvalues with nothing but
+/// applications of @f$ \hat A @f$: each application of the filter costs
+/// @f$ d @f$ of them, and no factorization is required.
+///
+/// The eigenvalues of @f$ \hat A @f$ are recovered as Rayleigh quotients of
+/// the Ritz vectors, see `arpack_solver<Symmetric, Backend>::eigenvalues(A&&)`.
+/// Some of them may lie just outside the window, because @f$ p @f$ is only
+/// approximately an indicator function, and can be discarded with
+/// @ref contains(). The number of eigenvalues requested from the solver should
+/// be at least the number of eigenvalues in the window, which can be
+/// estimated beforehand.
+///
+/// Example:
+/// @code
+/// using solver_t = arpack_solver<Symmetric, eigen_storage>;
+/// chebyshev_filter<eigen_storage> filter(N, A, {a, b}, 100);
+/// solver_t::params_t params(nev, solver_t::params_t::Largest, true);
+/// solver(filter, params);
+/// auto lambda = solver.eigenvalues(A);
+/// @endcode
+///
+/// @note Vector views passed to the operator must reference whole vectors.
+/// Therefore, it is not suitable for `mpi::arpack_solver`.
+///
+/// @tparam Backend Storage backend of the solver.
+template<typename Backend> class chebyshev_filter {
+public:
+  /// Type of input vector views, the same as for
+  /// `arpack_solver<Symmetric, Backend>`.
+  using vector_const_view_t =
+      typename arpack_solver<Symmetric, Backend>::vector_const_view_t;
+  /// Type of output vector views, the same as for
+  /// `arpack_solver<Symmetric, Backend>`.
+  using vector_view_t =
+      typename arpack_solver<Symmetric, Backend>::vector_view_t;
+  /// Type of the linear operator @f$ \hat A @f$.
+  using operator_type = std::function<void(vector_const_view_t, vector_view_t)>;
+
+private:
+  using storage = storage_traits<Backend>;
+  using real_vector_t = typename storage::real_vector_type;
+
+  int N_;                      // Dimension
+  operator_type a_;            // Operator A
+  spectral_interval window_;   // Window of wanted eigenvalues
+  spectral_interval bounds_;   // Bounds of the spectrum
+  filter_damping damping_;     // Damping of the Gibbs oscillations
+  double center_;              // Center of the spectrum
+  double half_width_;          // Half-width of the spectrum
+  std::vector<double> coeffs_; // Damped Chebyshev expansion coefficients
+
+  // Chebyshev vectors and the result of applying A
+  mutable real_vector_t t1_, t2_, w_;
+
+public:
+  /// Constructs a filter. Bounds of the spectrum of @f$ \hat A @f$ are
+  /// estimated with estimate_spectral_bounds().
+  ///
+  /// @param N Dimension of @f$ \hat A @f$.
+  /// @param a Linear operator @f$ \hat A @f$.
+  /// @param window Window of wanted eigenvalues.
+  /// @param degree Degree of the filter polynomial.
+  /// @param damping Damping of the Gibbs oscillations.
+  /// @param n_lanczos_steps Number of Lanczos steps to be made by
+  /// estimate_spectral_bounds().
+  /// @throws std::runtime_error Invalid dimension, window or degree.
+  chebyshev_filter(int N,
+                   operator_type a,
+                   spectral_interval window,
+                   int degree,
+                   filter_damping damping = JacksonDamping,
+                   int n_lanczos_steps = 20)
+      : chebyshev_filter(N,
+                         a,
+                         window,
+                         degree,
+                         damping,
+                         estimate_spectral_bounds<Backend>(a, N,
+                                                           n_lanczos_steps)) {}
+
+  /// Constructs a filter given bounds of the spectrum of @f$ \hat A @f$.
+  ///
+  /// @param N Dimension of @f$ \hat A @f$.
+  /// @param a Linear operator @f$ \hat A @f$.
+  /// @param window Window of wanted eigenvalues.
+  /// @param degree Degree of the filter polynomial.
+  /// @param damping Damping of the Gibbs oscillations.
+  /// @param bounds Interval containing the spectrum of @f$ \hat A @f$.
+  /// @throws std::runtime_error Invalid dimension, window, degree or bounds.
+  chebyshev_filter(int N,
+                   operator_type a,
+                   spectral_interval window,
+                   int degree,
+                   filter_damping damping,
+                   spectral_interval bounds)
+      : N_(N),
+        a_(std::move(a)),
+        window_(window),
+        bounds_(bounds),
+        damping_(damping),
+        center_((bounds.upper + bounds.lower) / 2),
+        half_width_((bounds.upper - bounds.lower) / 2),
+        t1_(storage::make_real_vector(N)),
+        t2_(storage::make_real_vector(N)),
+        w_(storage::make_real_vector(N)) {
+    if(N_ < 1)
+      throw std::runtime_error("chebyshev_filter: Dimension must be positive");
+    if(degree < 1)
+      throw std::runtime_error("chebyshev_filter: Degree must be positive");
+    if(!(bounds_.lower < bounds_.upper))
+      throw std::runtime_error("chebyshev_filter: Invalid spectral bounds");
+    if(!(window_.lower < window_.upper) || window_.upper <= bounds_.lower ||
+       window_.lower >= bounds_.upper)
+      throw std::runtime_error("chebyshev_filter: The window must be "
+                               "a non-empty interval overlapping with "
+                               "the spectral bounds");
+    coeffs_ = chebyshev_window_coefficients(window_, bounds_, degree, damping_);
+  }
+
+  chebyshev_filter(chebyshev_filter const&) = delete;
+  chebyshev_filter& operator=(chebyshev_filter const&) = delete;
+
+  ~chebyshev_filter() {
+    storage::destroy(t1_);
+    storage::destroy(t2_);
+    storage::destroy(w_);
+  }
+
+  /// Dimension of @f$ \hat A @f$.
+  int dim() const { return N_; }
+
+  /// Window of wanted eigenvalues.
+  spectral_interval window() const { return window_; }
+
+  /// Bounds of the spectrum of @f$ \hat A @f$.
+  spectral_interval bounds() const { return bounds_; }
+
+  /// Degree of the filter polynomial.
+  int degree() const { return int(coeffs_.size()) - 1; }
+
+  /// Damping of the Gibbs oscillations.
+  filter_damping damping() const { return damping_; }
+
+  /// Damped Chebyshev expansion coefficients of the filter polynomial, with
+  /// respect to the Chebyshev polynomials of the first kind in
+  /// @f$ (\lambda - c)/e @f$, where @f$ c @f$ and @f$ e @f$ are the center and
+  /// the half-width of the spectral bounds.
+  std::vector<double> const& coefficients() const { return coeffs_; }
+
+  /// Value of the filter polynomial @f$ p(\lambda) @f$.
+  /// @param lambda Argument.
+  double value(double lambda) const {
+    double const t = (lambda - center_) / half_width_;
+    double t_prev = 1, t_cur = t;
+    double p = coeffs_[0];
+    for(std::size_t k = 1; k < coeffs_.size(); ++k) {
+      p += coeffs_[k] * t_cur;
+      double const t_next = 2 * t * t_cur - t_prev;
+      t_prev = t_cur;
+      t_cur = t_next;
+    }
+    return p;
+  }
+
+  /// Smallest value of the filter polynomial at the ends of the window (or
+  /// of the part of the window within the spectral bounds). Eigenvalues of
+  /// @f$ p(\hat A) @f$ below this threshold correspond, with rare
+  /// exceptions, to eigenvalues of @f$ \hat A @f$ outside the window.
+  double threshold() const {
+    return std::min(value(std::max(window_.lower, bounds_.lower)),
+                    value(std::min(window_.upper, bounds_.upper)));
+  }
+
+  /// Does the window contain a given eigenvalue of @f$ \hat A @f$?
+  /// @param lambda Eigenvalue.
+  bool contains(double lambda) const {
+    return lambda >= window_.lower && lambda <= window_.upper;
+  }
+
+  /// Applies the filter @f$ p(\hat A) @f$ to a vector.
+  /// @param in View of the input vector.
+  /// @param out View of the output vector.
+  void operator()(vector_const_view_t in, vector_view_t out) const {
+    double const* x = view_data(in);
+    double* y = view_data(out);
+    double* t_prev = storage::get_data_ptr(t1_);
+    double* t_cur = storage::get_data_ptr(t2_);
+    double* w = storage::get_data_ptr(w_);
+    double const inv_e = 1 / half_width_;
+    int const d = degree();
+
+    // T_0(B) x = x, T_1(B) x = B x, where B = (A - c) / e
+    a_(in, storage::make_vector_view(w_));
+    for(int i = 0; i < N_; ++i) {
+      t_cur[i] = (w[i] - center_ * x[i]) * inv_e;
+      y[i] = coeffs_[0] * x[i] + coeffs_[1] * t_cur[i];
+    }
+    if(d == 1) return;
+
+    // T_2(B) x = 2 B T_1(B) x - x
+    a_(storage::make_vector_const_view(t2_, 0, N_),
+       storage::make_vector_view(w_));
+    for(int i = 0; i < N_; ++i) {
+      t_prev[i] = 2 * (w[i] - center_ * t_cur[i]) * inv_e - x[i];
+      y[i] += coeffs_[2] * t_prev[i];
+    }
+    std::swap(t_prev, t_cur);
+    bool cur_in_t1 = true;
+
+    // T_{k+1}(B) x = 2 B T_k(B) x - T_{k-1}(B) x, computed in place of
+    // T_{k-1}(B) x
+    for(int k = 3; k <= d; ++k) {
+      a_(storage::make_vector_const_view(cur_in_t1 ? t1_ : t2_, 0, N_),
+         storage::make_vector_view(w_));
+      for(int i = 0; i < N_; ++i) {
+        t_prev[i] = 2 * (w[i] - center_ * t_cur[i]) * inv_e - t_prev[i];
+        y[i] += coeffs_[k] * t_prev[i];
+      }
+      std::swap(t_prev, t_cur);
+      cur_in_t1 = !cur_in_t1;
+    }
+  }
+};
+
+} // namespace ezarpack
@@ -0,0 +1,264 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/ritz_kernels.hpp
+/// @brief Backend-independent kernels used to post-process Ritz vectors
+/// computed by ARPACK-NG.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace ezarpack {
+
+/// @brief Returns the number of chunks in ARPACK-NG's internal representation
+/// of Ritz vectors that are needed to reconstruct the first `nconv` Ritz
+/// vectors.
+///
+/// The result exceeds `nconv` by one if the last of the Ritz vectors is
+/// the first member of a complex conjugate pair.
+/// @param di Imaginary parts of the Ritz values.
+/// @param nconv Number of the converged Ritz vectors.
+inline int asymm_ritz_chunks(double const* di, int nconv) {
+  int i = 0;
+  while(i < nconv)
+    i += (di[i] == 0) ? 1 : 2;
+  return i;
+}
+
+/// @brief Computes eigenvalues of a real linear operator @f$ \hat A @f$ as
+/// Rayleigh quotients
+/// @f$ \frac{\mathbf{x}^\dagger \hat A \mathbf{x}}
+///          {\mathbf{x}^\dagger \hat M \mathbf{x}} @f$
+/// of Ritz vectors @f$ \mathbf{x} @f$.
+///
+/// This function expects the Ritz vectors in ARPACK-NG's internal
+/// representation, see asymm_ritz_vectors(). In MPI mode the computed values
+/// are rank-local contributions to the quotients.
+/// The Ritz vectors are processed in parallel, see parallel_for().
+///
+/// @param z Holds components of the Ritz vectors as a sequence of
+/// length-`n` chunks, see asymm_ritz_chunks().
+/// @param az Holds the result of applying @f$ \hat A @f$ to every chunk of `z`.
+/// @param di Imaginary parts of the Ritz values.
+/// @param n Length of one chunk.
+/// @param nconv Number of the converged Ritz vectors.
+/// @param lambda Output array of `nconv` eigenvalues.
+inline void asymm_rayleigh_quotients(double const* z,
+                                     double const* az,
+                                     double const* di,
+                                     int n,
+                                     int nconv,
+                                     std::complex<double>* lambda) {
+  // Chunks holding real Ritz vectors and real parts of complex Ritz vectors
+  std::vector<int> starts;
+  for(int i = 0; i < nconv; i += (di[i] == 0) ? 1 : 2)
+    starts.push_back(i);
+
+  parallel_for(int(starts.size()), [&](int p) {
+    int const i = starts[p];
+    double const* x1 = z + std::ptrdiff_t(i) * n;
+    double const* ax1 = az + std::ptrdiff_t(i) * n;
+    if(di[i] == 0) {
+      double s11 = 0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : s11)
+#endif
+      for(int k = 0; k < n; ++k)
+        s11 += x1[k] * ax1[k];
+      lambda[i] = s11;
+    } else {
+      double const* x2 = x1 + n;
+      double const* ax2 = ax1 + n;
+      // Compute all four scalar products in one pass over the chunks
+      double s11 = 0, s22 = 0, s12 = 0, s21 = 0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : s11, s22, s12, s21)
+#endif
+      for(int k = 0; k < n; ++k) {
+        s11 += x1[k] * ax1[k];
+        s22 += x2[k] * ax2[k];
+        s12 += x1[k] * ax2[k];
+        s21 += x2[k] * ax1[k];
+      }
+      lambda[i] = std::complex<double>(s11 + s22, s12 - s21);
+      if(i + 1 < nconv) lambda[i + 1] = std::conj(lambda[i]);
+    }
+  });
+}
+
+/// @brief Assembles complex Ritz vectors from ARPACK-NG's internal
+/// representation.
+///
+/// Each complex conjugate pair of Ritz vectors is written in a single pass
+/// over the corresponding chunks of `z`. Long vectors are split into row
+/// blocks that are processed in parallel, see parallel_for().
+///
+/// @param z Holds components of the Ritz vectors as a sequence of
+/// length-`n` chunks. Meaning of each chunk depends on the corresponding
+/// component of `di`, see below.
+/// @param di If `di[i]` is zero, then the `i`-th chunk of `z` contains a
+/// real Ritz vector. Otherwise, `di[i] = -di[i+1] != 0`, in which case
+/// the `i`-th and `(i+1)`-th chunks of `z` are real and imaginary parts of
+/// a complex Ritz vector respectively. Every such pair corresponds to a complex
+/// conjugate pair of Ritz vectors.
+/// @param n Length of one chunk.
+/// @param nconv Number of the converged Ritz vectors.
+/// @param x Output column-major matrix with `n` rows and `nconv` columns.
+/// @param ldx Leading dimension of `x`.
+inline void asymm_ritz_vectors(double const* z,
+                               double const* di,
+                               int n,
+                               int nconv,
+                               std::complex<double>* x,
+                               std::ptrdiff_t ldx) {
+  // Chunks holding real Ritz vectors and real parts of complex Ritz vectors
+  std::vector<int> starts;
+  for(int i = 0; i < nconv; i += (di[i] == 0) ? 1 : 2)
+    starts.push_back(i);
+
+  int const rows_per_task = 1 << 15;
+  int const n_row_blocks = (n + rows_per_task - 1) / rows_per_task;
+
+  parallel_for(int(starts.size()) * n_row_blocks, [&](int t) {
+    int const i = starts[t / n_row_blocks];
+    int const k_begin = (t % n_row_blocks) * rows_per_task;
+    int const k_end = std::min(n, k_begin + rows_per_task);
+
+    double const* z1 = z + std::ptrdiff_t(i) * n;
+    // std::complex<double> is layout-compatible with double[2]
+    double* x1 = reinterpret_cast<double*>(x + i * ldx);
+
+    if(di[i] == 0) {
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+      for(int k = k_begin; k < k_end; ++k) {
+        x1[2 * k] = z1[k];
+        x1[2 * k + 1] = 0;
+      }
+    } else {
+      double const* z2 = z1 + n;
+      double const sign = std::copysign(1.0, di[i]);
+      if(i + 1 < nconv) {
+        double* x2 = reinterpret_cast<double*>(x + (i + 1) * ldx);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+        for(int k = k_begin; k < k_end; ++k) {
+          double const re = z1[k];
+          double const im = sign * z2[k];
+          x1[2 * k] = re;
+          x1[2 * k + 1] = im;
+          x2[2 * k] = re;
+          x2[2 * k + 1] = -im;
+        }
+      } else {
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+        for(int k = k_begin; k < k_end; ++k) {
+          x1[2 * k] = z1[k];
+          x1[2 * k + 1] = sign * z2[k];
+        }
+      }
+    }
+  });
+}
+
+/// @brief Lazy view of a complex Ritz vector stored in ARPACK-NG's internal
+/// representation.
+///
+/// Components of the vector are computed on demand from one or two real
+/// chunks. A view remains valid as long as the underlying chunks are not
+/// modified.
+class ritz_vector_view {
+  double const* re_;
+  double const* im_;
+  double sign_;
+  int n_;
+
+public:
+  /// Constructs a view.
+  /// @param re Chunk holding the real part of the vector.
+  /// @param im Chunk holding the imaginary part of the vector up to a sign,
+  /// or `nullptr` if the vector is real.
+  /// @param sign Sign of the imaginary part.
+  /// @param n Length of the vector.
+  ritz_vector_view(double const* re, double const* im, double sign, int n)
+      : re_(re), im_(im), sign_(sign), n_(n) {}
+
+  /// Length of the vector.
+  int size() const { return n_; }
+
+  /// Is the vector real?
+  bool is_real() const { return im_ == nullptr; }
+
+  /// Returns a component of the vector.
+  /// @param k Index of the component.
+  std::complex<double> operator[](int k) const {
+    return im_ ? std::complex<double>(re_[k], sign_ * im_[k])
+               : std::complex<double>(re_[k]);
+  }
+
+  /// Writes all components of the vector into an array.
+  /// @param dest Output array of length @ref size().
+  void copy_to(std::complex<double>* dest) const {
+    // std::complex<double> is layout-compatible with double[2]
+    double* d = reinterpret_cast<double*>(dest);
+    if(im_) {
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+      for(int k = 0; k < n_; ++k) {
+        d[2 * k] = re_[k];
+        d[2 * k + 1] = sign_ * im_[k];
+      }
+    } else {
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+      for(int k = 0; k < n_; ++k) {
+        d[2 * k] = re_[k];
+        d[2 * k + 1] = 0;
+      }
+    }
+  }
+};
+
+/// @brief Makes a lazy view of one complex Ritz vector stored in ARPACK-NG's
+/// internal representation.
+///
+/// @param z Holds components of the Ritz vectors as a sequence of
+/// length-`n` chunks, see asymm_ritz_vectors().
+/// @param di Imaginary parts of the Ritz values.
+/// @param n Length of one chunk.
+/// @param i Index of the Ritz vector.
+inline ritz_vector_view
+asymm_ritz_vector(double const* z, double const* di, int n, int i) {
+  // Find the first chunk corresponding to the i-th Ritz vector
+  int p = 0;
+  while(p + ((di[p] == 0) ? 1 : 2) <= i)
+    p += (di[p] == 0) ? 1 : 2;
+
+  double const* re = z + std::ptrdiff_t(p) * n;
+  if(di[p] == 0) return ritz_vector_view(re, nullptr, 1, n);
+  double const sign = std::copysign(1.0, di[p]);
+  return ritz_vector_view(re, re + n, p == i ? sign : -sign, n);
+}
+
+} // namespace ezarpack
@@ -16,7 +16,12 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace ezarpack {
 
@@ -87,11 +92,15 @@ private:
   real_vector_t resid;        // Residual vector
   real_vector_t workd;        // Working space
   int ncv = 0;                // Number of Lanczos vectors to be generated
+  int ncv_alloc = 0;          // Number of Arnoldi vectors allocated for
   real_matrix_t v;            // Matrix with Arnoldi basis vectors
   int ldv = 0;                // Leading dimension of v
   real_vector_t z;            // Flattened matrix with Ritz vectors
+  int z_size = 0;             // Allocated size of z
   int ldz = 0;                // Leading dimension of z
   real_vector_t dr, di;       // Ritz values (real and imaginary parts)
+  real_vector_t workl;        // Working space for the Arnoldi iteration
+  real_vector_t workev;       // WORKEV parameter of dneupd
   int iparam[11];             // Various input/output parameters
   int ipntr[14];              // Starting locations in workd and workl
   int info = 0;               // !=0 to use resid, 0 otherwise
@@ -101,6 +110,35 @@ private:
   double sigmar = 0;          // SIGMAR parameter of dneupd
   double sigmai = 0;          // SIGMAI parameter of dneupd
   bool Bx_available_ = false; // Has B*x already been computed?
+  int v_ncv = 0;              // Number of columns allocated in v
+
+  // User-supplied buffer for Arnoldi basis vectors (not owned)
+  double* v_buffer = nullptr;
+  int v_buffer_ncv = 0; // Number of columns in v_buffer
+
+  // Memory placement policy for resid, workd and v
+  placement_policy placement_;
+
+  // Thread pool executing parallel loops during solver calls (not owned)
+  thread_pool* executor_ = nullptr;
+
+  // Conditions for early interruption of runs
+  interruption_monitor interruption_;
+
+  // Tolerance in effect before the last interruption
+  double requested_tol_ = 0;
+
+  // Wall time spent in different phases of the last run
+  phase_timings timings_;
+
+  // Recorder of the convergence history (not owned)
+  convergence_trace* trace_ = nullptr;
+
+  // State of a step-wise run (see begin(), step() and finish())
+  rci_flag step_ido_ = Done;  // Last value of IDO returned by dnaupd
+  bool step_started_ = false; // Has begin() been called?
+  int step_mode_ = 1;         // Computational mode
+  stopwatch step_watch_;      // Measures time between steps
 
 public:
   /// Input parameters of the Implicitly Restarted Arnoldi Method (IRAM).
@@ -176,6 +214,8 @@ public:
         z(storage::make_real_vector(0)),
         dr(storage::make_real_vector(nev + 1)),
         di(storage::make_real_vector(nev + 1)),
+        workl(storage::make_real_vector(0)),
+        workev(storage::make_real_vector(0)),
         select(storage::make_int_vector(0)) {
     iparam[3] = 1;
   }
@@ -187,6 +227,8 @@ public:
     storage::destroy(z);
     storage::destroy(dr);
     storage::destroy(di);
+    storage::destroy(workl);
+    storage::destroy(workev);
     storage::destroy(select);
   }
 
@@ -218,32 +260,20 @@ private:
     which = wh[int(params.eigenvalues_select)];
 
     // Check ncv
-    ncv = params.ncv;
-    if(ncv == -1)
-      ncv = std::min(2 * int(params.n_eigenvalues) + 2, N);
-    else if(ncv <= int(params.n_eigenvalues + 2) || ncv > N)
-      throw ARPACK_SOLVER_ERROR("ncv must be within ]" +
-                                std::to_string(params.n_eigenvalues + 2) + ";" +
-                                std::to_string(N) + "]");
+    ncv = ncv_from_params(params);
+    if(v_buffer && ncv > v_buffer_ncv)
+      throw ARPACK_SOLVER_ERROR("ncv must not exceed the number of columns "
+                                "in the basis buffer (" +
+                                std::to_string(v_buffer_ncv) + ")");
 
-    storage::resize(v, N, ncv);
-    ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v) : N;
+    allocate_workspace(ncv);
 
     // Eigenvectors
     rvec = (params.compute_vectors != params_t::None);
     howmny = params.compute_vectors == params_t::Schur ? 'P' : 'A';
-    storage::resize(select, ncv);
 
-    // According to dneupd() docs, 'z' is not referenced if howmny == 'P'.
-    // In fact, however, passing a zero-size 'z' in the Schur vector mode
-    // results in a SEGFAULT.
-    if(rvec) {
-      storage::resize(z, N * (nev + 1));
-      ldz = N;
-    } else {
-      storage::resize(z, 1);
-      ldz = 1;
-    }
+    allocate_ritz_vectors(nev, rvec);
+    ldz = rvec ? N : 1;
 
     // Tolerance
     tol = std::max(.0, params.tolerance);
@@ -255,6 +285,79 @@ private:
     if(iparam[2] <= 0)
       throw ARPACK_SOLVER_ERROR(
           "Maximum number of Arnoldi update iterations must be positive");
+
+    interruption_.start();
+    timings_ = phase_timings();
+    if(trace_) trace_->clear();
+  }
+
+  /// @internal Grow containers whose size depends on the number of Arnoldi
+  /// vectors.
+  ///
+  /// The containers are never shrunk, so that subsequent runs with the same or
+  /// a smaller number of Arnoldi vectors require no memory allocations.
+  /// @param ncv_required Number of Arnoldi vectors to allocate memory for.
+  void allocate_workspace(int ncv_required) {
+    if(!v_buffer && ncv_required > v_ncv) {
+      storage::resize(v, N, ncv_required);
+      ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v) : N;
+      v_ncv = ncv_required;
+      place_basis();
+    }
+
+    if(ncv_required <= ncv_alloc) return;
+
+    storage::resize(dr, ncv_required);
+    storage::resize(di, ncv_required);
+    storage::resize(workl,
+                    3 * ncv_required * ncv_required + 6 * ncv_required);
+    storage::resize(workev, 3 * ncv_required);
+    storage::resize(select, ncv_required);
+
+    ncv_alloc = ncv_required;
+  }
+
+  /// @internal Apply the memory placement policy to the internally allocated
+  /// matrix with Arnoldi basis vectors.
+  ///
+  /// @return `true` if the kernel has accepted all requested advice.
+  bool place_basis() {
+    std::size_t ld =
+        storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v) : N;
+    return apply_placement(storage::get_data_ptr(v), ld * v_ncv, placement_);
+  }
+
+  /// @internal Validate params_t::ncv and substitute its default value if
+  /// necessary.
+  ///
+  /// @param params Set of input parameters for the IRAM.
+  /// @return Number of Arnoldi vectors to be generated.
+  int ncv_from_params(params_t const& params) const {
+    if(params.ncv == -1)
+      return std::min(2 * int(params.n_eigenvalues) + 2, N);
+    if(params.ncv <= int(params.n_eigenvalues + 2) || params.ncv > N)
+      throw ARPACK_SOLVER_ERROR("ncv must be within ]" +
+                                std::to_string(params.n_eigenvalues + 2) + ";" +
+                                std::to_string(N) + "]");
+    return params.ncv;
+  }
+
+  /// @internal Pointer to the storage of Arnoldi basis vectors.
+  double* v_data() { return v_buffer ? v_buffer : storage::get_data_ptr(v); }
+
+  /// @internal Grow the container for Ritz/Schur vectors.
+  ///
+  /// @param nev_required Number of eigenvalues to allocate memory for.
+  /// @param rvec_required Are Ritz/Schur vectors going to be computed?
+  void allocate_ritz_vectors(int nev_required, bool rvec_required) {
+    // According to dneupd() docs, 'z' is not referenced if howmny == 'P'.
+    // In fact, however, passing a zero-size 'z' in the Schur vector mode
+    // results in a SEGFAULT.
+    int z_size_required = rvec_required ? N * (nev_required + 1) : 1;
+    if(z_size_required > z_size) {
+      storage::resize(z, z_size_required);
+      z_size = z_size_required;
+    }
   }
 
 public:
@@ -324,22 +427,26 @@ public:
   template<typename A, typename ShiftsF = exact_shifts_f>
   void operator()(A&& a, params_t const& params, ShiftsF shifts_f = {}) {
 
+    parallel_context context(executor_);
     prepare(params);
 
     iparam[0] = (std::is_same<ShiftsF, exact_shifts_f>::value ? 1 : 0);
     iparam[6] = 1; // Mode 1, standard eigenproblem
 
     const int workl_size = 3 * ncv * ncv + 6 * ncv;
-    real_vector_t workl = storage::make_real_vector(workl_size);
 
     rci_flag ido = Init;
     Bx_available_ = false;
+    stopwatch watch;
     do {
       f77::aupd<false>(ido, "I", N, which, nev, tol,
-                       storage::get_data_ptr(resid), ncv,
-                       storage::get_data_ptr(v), ldv, iparam, ipntr,
-                       storage::get_data_ptr(workd),
+                       storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam,
+                       ipntr, storage::get_data_ptr(workd),
                        storage::get_data_ptr(workl), workl_size, info);
+      if(ido == Done) settle_interruption();
+      if(trace_) observe_trace(ido);
+      watch.lap(timings_.aupd);
+      if(ido != Done && interruption_.check()) interrupt_iteration();
       switch(ido) {
         case ApplyOpInit:
         case ApplyOp: {
@@ -347,6 +454,7 @@ public:
           int out_pos = out_vector_n() * N;
           a(storage::make_vector_const_view(workd, in_pos, N),
             storage::make_vector_view(workd, out_pos, N));
+          watch.lap(timings_.op);
         } break;
         case Shifts: {
           int np = iparam[7];
@@ -355,31 +463,24 @@ public:
                    storage::make_vector_const_view(workl, ipntr[7] - 1, ncv),
                    storage::make_vector_view(workl, ipntr[13] - 1, np),
                    storage::make_vector_view(workl, ipntr[13] - 1 + np, np));
+          watch.lap(timings_.shifts);
         } break;
         case Done: break;
-        default: {
-          storage::destroy(workl);
+        default:
           throw ARPACK_SOLVER_ERROR("Reverse communication interface error");
-        }
       }
     } while(ido != Done);
 
-    handle_aupd_error_codes(info, workl);
-
-    storage::resize(dr, nev + 1);
-    storage::resize(di, nev + 1);
-    real_vector_t workev = storage::make_real_vector(3 * ncv);
+    handle_aupd_error_codes(info);
 
     f77::eupd(rvec, &howmny, storage::get_data_ptr(select),
               storage::get_data_ptr(dr), storage::get_data_ptr(di),
               storage::get_data_ptr(z), ldz, sigmar, sigmai,
               storage::get_data_ptr(workev), "I", N, which, nev, tol,
-              storage::get_data_ptr(resid), ncv, storage::get_data_ptr(v), ldv,
-              iparam, ipntr, storage::get_data_ptr(workd),
-              storage::get_data_ptr(workl), workl_size, info);
-
-    storage::destroy(workev);
-    storage::destroy(workl);
+              storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam, ipntr,
+              storage::get_data_ptr(workd), storage::get_data_ptr(workl),
+              workl_size, info);
+    watch.lap(timings_.eupd);
 
     handle_eupd_error_codes(info);
   }
@@ -503,22 +604,26 @@ public:
                   params_t const& params,
                   ShiftsF shifts_f = {}) {
 
+    parallel_context context(executor_);
     prepare(params);
 
     iparam[0] = (std::is_same<ShiftsF, exact_shifts_f>::value ? 1 : 0);
     iparam[6] = mode; // Modes 2-4, generalized eigenproblem
 
     const int workl_size = 3 * ncv * ncv + 6 * ncv;
-    real_vector_t workl = storage::make_real_vector(workl_size);
 
     rci_flag ido = Init;
     Bx_available_ = false;
+    stopwatch watch;
     do {
       f77::aupd<false>(ido, "G", N, which, nev, tol,
-                       storage::get_data_ptr(resid), ncv,
-                       storage::get_data_ptr(v), ldv, iparam, ipntr,
-                       storage::get_data_ptr(workd),
+                       storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam,
+                       ipntr, storage::get_data_ptr(workd),
                        storage::get_data_ptr(workl), workl_size, info);
+      if(ido == Done) settle_interruption();
+      if(trace_) observe_trace(ido);
+      watch.lap(timings_.aupd);
+      if(ido != Done && interruption_.check()) interrupt_iteration();
       switch(ido) {
         case ApplyOpInit: {
           int in_pos = in_vector_n() * N;
@@ -526,6 +631,7 @@ public:
           Bx_available_ = false;
           op(storage::make_vector_const_view(workd, in_pos, N),
              storage::make_vector_view(workd, out_pos, N));
+          watch.lap(timings_.op);
         } break;
         case ApplyOp: {
           int in_pos = in_vector_n() * N;
@@ -534,12 +640,14 @@ public:
           Bx_available_ = true;
           op(storage::make_vector_const_view(workd, in_pos, N),
              storage::make_vector_view(workd, out_pos, N));
+          watch.lap(timings_.op);
         } break;
         case ApplyB: {
           int in_pos = in_vector_n() * N;
           int out_pos = out_vector_n() * N;
           b(storage::make_vector_const_view(workd, in_pos, N),
             storage::make_vector_view(workd, out_pos, N));
+          watch.lap(timings_.b);
         } break;
         case Shifts: {
           int np = iparam[7];
@@ -548,35 +656,164 @@ public:
                    storage::make_vector_const_view(workl, ipntr[7] - 1, ncv),
                    storage::make_vector_view(workl, ipntr[13] - 1, np),
                    storage::make_vector_view(workl, ipntr[13] - 1 + np, np));
+          watch.lap(timings_.shifts);
         } break;
         case Done: break;
-        default: {
-          storage::destroy(workl);
+        default:
           throw ARPACK_SOLVER_ERROR("Reverse communication interface error");
-        }
       }
     } while(ido != Done);
 
-    handle_aupd_error_codes(info, workl);
+    handle_aupd_error_codes(info);
 
-    storage::resize(dr, nev + 1);
-    storage::resize(di, nev + 1);
     if(mode != Inverse) {
       sigmar = params.sigma.real();
       sigmai = params.sigma.imag();
     }
-    real_vector_t workev = storage::make_real_vector(3 * ncv);
 
     f77::eupd(rvec, &howmny, storage::get_data_ptr(select),
               storage::get_data_ptr(dr), storage::get_data_ptr(di),
               storage::get_data_ptr(z), ldz, sigmar, sigmai,
               storage::get_data_ptr(workev), "G", N, which, nev, tol,
-              storage::get_data_ptr(resid), ncv, storage::get_data_ptr(v), ldv,
-              iparam, ipntr, storage::get_data_ptr(workd),
-              storage::get_data_ptr(workl), workl_size, info);
+              storage::get_data_ptr(resid), ncv, v_data(), ldv, iparam, ipntr,
+              storage::get_data_ptr(workd), storage::get_data_ptr(workl),
+              workl_size, info);
+    watch.lap(timings_.eupd);
 
-    storage::destroy(workev);
-    storage::destroy(workl);
+    handle_eupd_error_codes(info);
+  }
+
+  /// Request made by the Reverse Communication Interface in the course of
+  /// a step-wise IRAM run.
+  struct step_t {
+    /// What must be done before the next call to @ref step():
+    /// - ezarpack::ApplyOpInit and ezarpack::ApplyOp, act with @f$ \hat O @f$
+    ///   on @ref in and write the result into @ref out;
+    /// - ezarpack::ApplyB, act with @f$ \hat B @f$ on @ref in and write the
+    ///   result into @ref out;
+    /// - ezarpack::Done, call @ref finish().
+    rci_flag request;
+    /// View of the input vector @f$ \mathbf{x} @f$.
+    vector_view_t in;
+    /// View of the output vector @f$ \mathbf{y} @f$.
+    vector_view_t out;
+  };
+
+  /// Starts a step-wise solution of a standard eigenproblem
+  /// @f$ \hat A\mathbf{x} = \lambda\mathbf{x}@f$.
+  ///
+  /// Instead of accepting a callable object and running the whole IRAM, the
+  /// step-wise interface hands the Reverse Communication Interface over to the
+  /// caller. Each call to @ref step() advances the iteration to the next
+  /// request for a linear operator application, which the caller is free to
+  /// serve in any way, e.g. on a task scheduler or in a coroutine. Once
+  /// @ref step() has returned ezarpack::Done, @ref finish() computes the
+  /// results.
+  /// @code
+  /// solver.begin(params);
+  /// while(true) {
+  ///   auto s = solver.step();
+  ///   if(s.request == ezarpack::Done) break;
+  ///   a(s.in, s.out);
+  /// }
+  /// solver.finish();
+  /// @endcode
+  /// The "Exact Shift Strategy" is always used by the step-wise interface.
+  /// Unless ARPACK-NG has been declared reentrant with
+  /// set_arpack_reentrant(), step-wise runs of different solver objects must
+  /// not be interleaved.
+  ///
+  /// @param params Set of input parameters for the Implicitly Restarted
+  /// Arnoldi Method.
+  /// @throws std::runtime_error Invalid input parameters.
+  void begin(params_t const& params) { begin_steps(1, params); }
+
+  /// Starts a step-wise solution of a generalized eigenproblem
+  /// @f$ \hat A\mathbf{x} = \lambda\hat M\mathbf{x}@f$.
+  ///
+  /// See @ref begin(params_t const&) for a description of the step-wise
+  /// interface. The requests made by @ref step() have the same meaning as
+  /// calls to `op` and `b` made by the generalized version of
+  /// @ref operator()().
+  ///
+  /// @param mode @ref Mode "Computational mode" to be used.
+  /// @param params Set of input parameters for the Implicitly Restarted
+  /// Arnoldi Method.
+  /// @throws std::runtime_error Invalid input parameters.
+  void begin(Mode mode, params_t const& params) { begin_steps(mode, params); }
+
+  /// Advances a step-wise IRAM run to the next request of the Reverse
+  /// Communication Interface.
+  ///
+  /// The request returned by a previous call must have been served.
+  /// @throws ezarpack::solve_interrupted The run has been interrupted
+  /// according to an interruption policy with mode
+  /// ezarpack::ThrowOnInterruption. The step-wise run is abandoned.
+  /// @throws std::runtime_error No step-wise run is in progress or
+  /// the Reverse Communication Interface has failed.
+  step_t step() {
+    if(!step_started_ || step_ido_ == Done)
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: No step-wise run is in progress");
+
+    // Time elapsed since the previous step has been spent serving a request
+    if(step_ido_ == ApplyB)
+      step_watch_.lap(timings_.b);
+    else if(step_ido_ != Init)
+      step_watch_.lap(timings_.op);
+    else
+      step_watch_.restart();
+
+    const int workl_size = 3 * ncv * ncv + 6 * ncv;
+    f77::aupd<false>(step_ido_, step_mode_ == 1 ? "I" : "G", N, which, nev,
+                     tol, storage::get_data_ptr(resid), ncv, v_data(), ldv,
+                     iparam, ipntr, storage::get_data_ptr(workd),
+                     storage::get_data_ptr(workl), workl_size, info);
+    if(step_ido_ == Done) settle_interruption();
+    if(trace_) observe_trace(step_ido_);
+    step_watch_.lap(timings_.aupd);
+    if(step_ido_ != Done) check_step_interruption();
+    switch(step_ido_) {
+      case ApplyOpInit: Bx_available_ = false; break;
+      // B*x is available via Bx_vector()
+      case ApplyOp: Bx_available_ = (step_mode_ != 1); break;
+      case ApplyB:
+      case Done: break;
+      default:
+        step_started_ = false;
+        throw ARPACK_SOLVER_ERROR("Reverse communication interface error");
+    }
+    return make_step(step_ido_);
+  }
+
+  /// Completes a step-wise IRAM run after @ref step() has returned
+  /// ezarpack::Done, and computes the eigenvalues and (optionally) the Ritz
+  /// or Schur vectors.
+  ///
+  /// @throws ezarpack::ncv_insufficient No shifts could be applied during
+  /// a cycle of the IRA iteration.
+  /// @throws ezarpack::maxiter_reached Maximum number of IRA iterations has
+  /// been reached. All possible eigenvalues of @f$ \hat O @f$ have been found.
+  /// @throws std::runtime_error The iteration has not been completed, and
+  /// other errors reported by ARPACK-NG routines `dnaupd()` and `dneupd()`.
+  void finish() {
+    if(!step_started_ || step_ido_ != Done)
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: The iteration has not been completed");
+    step_started_ = false;
+
+    handle_aupd_error_codes(info);
+
+    const int workl_size = 3 * ncv * ncv + 6 * ncv;
+    step_watch_.restart();
+    f77::eupd(rvec, &howmny, storage::get_data_ptr(select),
+              storage::get_data_ptr(dr), storage::get_data_ptr(di),
+              storage::get_data_ptr(z), ldz, sigmar, sigmai,
+              storage::get_data_ptr(workev), step_mode_ == 1 ? "I" : "G", N,
+              which, nev, tol, storage::get_data_ptr(resid), ncv, v_data(),
+              ldv, iparam, ipntr, storage::get_data_ptr(workd),
+              storage::get_data_ptr(workl), workl_size, info);
+    step_watch_.lap(timings_.eupd);
 
     handle_eupd_error_codes(info);
   }
@@ -631,15 +868,18 @@ public:
   /// last run) and is primarily intended for use in the @ref ShiftAndInvertReal
   /// and @ref ShiftAndInvertImag modes.
   /// @param a A callable object representing the linear operator
-  /// @f$ \hat A @f$.
+  /// @f$ \hat A @f$. If it is a @ref block_operator, then @f$ \hat A @f$ is
+  /// applied to all Ritz vectors in a single call. If it is
+  /// a @ref thread_safe_operator, then the Ritz vectors are processed
+  /// concurrently.
   /// @throws std::runtime_error Ritz vectors have not been computed in the
   /// last IRAM run.
   template<typename A> complex_vector_t eigenvalues(A&& a) const {
     if((!rvec) || (howmny != 'A'))
       throw ARPACK_SOLVER_ERROR(
           "Invalid method call: Ritz vectors have not been computed");
-    return storage::make_asymm_eigenvalues(z, di, std::forward<A>(a), N,
-                                           nconv());
+    parallel_context context(executor_);
+    return rayleigh_quotients(a);
   }
 
   /// Returns a matrix, whose @ref nconv() columns are converged
@@ -650,17 +890,85 @@ public:
     if((!rvec) || (howmny != 'A'))
       throw ARPACK_SOLVER_ERROR(
           "Invalid method call: Ritz vectors have not been computed");
+    parallel_context context(executor_);
     return storage::make_asymm_eigenvectors(z, di, N, nconv());
   }
 
+  /// Returns a lazy view of the `i`-th converged Ritz vector
+  /// (eigenvector).
+  ///
+  /// Components of the vector are computed on demand from ARPACK-NG's internal
+  /// representation of Ritz vectors, and no memory is allocated. The view is
+  /// invalidated by the next IRAM run.
+  /// @param i Index of the Ritz vector.
+  /// @throws std::runtime_error Ritz vectors have not been computed in the
+  /// last IRAM run.
+  /// @throws std::runtime_error `i` is not below @ref nconv().
+  ritz_vector_view eigenvector_view(unsigned int i) const {
+    if((!rvec) || (howmny != 'A'))
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Ritz vectors have not been computed");
+    if(i >= nconv())
+      throw ARPACK_SOLVER_ERROR("Index of a Ritz vector must be within [0;" +
+                                std::to_string(nconv()) + ")");
+    return asymm_ritz_vector(z_data(), di_data(), N, i);
+  }
+
+  /// Returns the `i`-th converged Ritz vector
+  /// (eigenvector).
+  ///
+  /// Unlike @ref eigenvectors(), this method allocates memory for only one
+  /// vector.
+  /// @param i Index of the Ritz vector.
+  /// @throws std::runtime_error Ritz vectors have not been computed in the
+  /// last IRAM run.
+  /// @throws std::runtime_error `i` is not below @ref nconv().
+  complex_vector_t eigenvector(unsigned int i) const {
+    auto view = eigenvector_view(i);
+    complex_vector_t x = storage::make_complex_vector(N);
+    view.copy_to(storage::get_data_ptr(x));
+    return x;
+  }
+
+  /// Writes all @ref nconv() converged Ritz vectors
+  /// (eigenvectors) into a caller-owned buffer.
+  ///
+  /// The buffer must accommodate a column-major matrix with @ref dim() rows
+  /// and @ref nconv() columns.
+  /// @param dest Pointer to the first element of the buffer.
+  /// @param ld Leading dimension of the buffer. `-1` stands for @ref dim().
+  /// @throws std::runtime_error Ritz vectors have not been computed in the
+  /// last IRAM run.
+  /// @throws std::runtime_error Invalid buffer pointer or leading dimension.
+  void eigenvectors_into(dcomplex* dest, int ld = -1) const {
+    if((!rvec) || (howmny != 'A'))
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Ritz vectors have not been computed");
+    if(dest == nullptr)
+      throw ARPACK_SOLVER_ERROR("Destination pointer must not be null");
+    if(ld == -1)
+      ld = N;
+    else if(ld < N)
+      throw ARPACK_SOLVER_ERROR("Leading dimension of the destination must be "
+                                "at least " + std::to_string(N));
+    parallel_context context(executor_);
+    asymm_ritz_vectors(z_data(), di_data(), N, nconv(), dest, ld);
+  }
+
   /// Returns a view of a matrix, whose @ref nconv() columns are
   /// Schur basis vectors.
   /// @throws std::runtime_error Schur vectors have not been computed in the
   /// last IRAM run.
+  /// @throws std::runtime_error Schur vectors have been written into
+  /// a user-supplied basis buffer.
   real_matrix_const_view_t schur_vectors() const {
     if(!rvec)
       throw ARPACK_SOLVER_ERROR(
           "Invalid method call: Schur vectors have not been computed");
+    if(v_buffer)
+      throw ARPACK_SOLVER_ERROR(
+          "Invalid method call: Schur vectors have been written into "
+          "the basis buffer");
     return storage::make_matrix_const_view(v, N, nconv());
   }
 
@@ -693,6 +1001,8 @@ public:
     unsigned int n_b_x_operations;
     /// Total number of steps of re-orthogonalization.
     unsigned int n_reorth_steps;
+    /// Wall time spent in different phases of the run.
+    phase_timings timings;
   };
 
   /// Returns computation statistics from the last IRAM run.
@@ -702,17 +1012,416 @@ public:
     s.n_op_x_operations = iparam[8];
     s.n_b_x_operations = iparam[9];
     s.n_reorth_steps = iparam[10];
+    s.timings = timings_;
     return s;
   }
 
+  /// Sizes of internal data buffers (in bytes) required to run the IRAM.
+  ///
+  /// The sizes are computed from dimensions of the arrays passed to ARPACK-NG
+  /// routines and do not include padding that some storage backends may add
+  /// between matrix columns.
+  struct memory_footprint_t {
+    /// Residual vector.
+    std::size_t resid;
+    /// Working space of the reverse communication interface (WORKD).
+    std::size_t workd;
+    /// Matrix with Arnoldi basis vectors.
+    std::size_t v;
+    /// Real parts of Ritz values.
+    std::size_t dr;
+    /// Imaginary parts of Ritz values.
+    std::size_t di;
+    /// Matrix with Ritz vectors.
+    std::size_t z;
+    /// Working space of the Arnoldi iteration (WORKL).
+    std::size_t workl;
+    /// WORKEV parameter of dneupd().
+    std::size_t workev;
+    /// SELECT parameter of dneupd().
+    std::size_t select;
+
+    /// Total size of all buffers.
+    std::size_t total() const {
+      return resid + workd + v + dr + di + z + workl + workev + select;
+    }
+  };
+
+  /// Returns sizes of internal data buffers needed to run the IRAM with
+  /// a given set of input parameters.
+  ///
+  /// This method does not allocate memory. Since the buffers are never shrunk,
+  /// the actually allocated amount of memory is the maximum over all runs
+  /// performed so far.
+  /// A basis buffer supplied by the caller via set_basis_buffer() is not
+  /// counted.
+  /// @param params Set of input parameters for the Implicitly Restarted Arnoldi
+  /// Method.
+  /// @throws std::runtime_error Invalid value of params_t::ncv.
+  memory_footprint_t memory_footprint(params_t const& params) const {
+    const std::size_t n = N;
+    const std::size_t m = ncv_from_params(params);
+    const std::size_t k = params.n_eigenvalues + 1;
+    const bool rv = (params.compute_vectors != params_t::None);
+
+    memory_footprint_t f;
+    f.resid = n * sizeof(double);
+    f.workd = 3 * n * sizeof(double);
+    f.v = v_buffer ? 0 : n * m * sizeof(double);
+    f.dr = m * sizeof(double);
+    f.di = m * sizeof(double);
+    f.z = (rv ? n * k : 1) * sizeof(double);
+    f.workl = (3 * m * m + 6 * m) * sizeof(double);
+    f.workev = 3 * m * sizeof(double);
+    f.select = m * sizeof(int);
+    return f;
+  }
+
+  /// Allocates internal data buffers for up to `ncv_max` Arnoldi vectors.
+  ///
+  /// Subsequent runs with params_t::ncv not exceeding `ncv_max` will not
+  /// reallocate the working space of the IRAM.
+  /// @param ncv_max Maximal number of Arnoldi vectors to be generated.
+  /// @throws std::runtime_error `ncv_max` is not within [1;N].
+  void reserve(unsigned int ncv_max) {
+    if(ncv_max < 1 || int(ncv_max) > N)
+      throw ARPACK_SOLVER_ERROR("ncv_max must be within [1;" +
+                                std::to_string(N) + "]");
+    allocate_workspace(ncv_max);
+  }
+
+  /// Allocates all internal data buffers needed to run the IRAM with
+  /// a given set of input parameters.
+  ///
+  /// This method reserves working space for params_t::ncv Arnoldi vectors
+  /// and memory for Ritz/Schur vectors if they are requested by `params`.
+  /// @param params Set of input parameters for the Implicitly Restarted Arnoldi
+  /// Method.
+  /// @throws std::runtime_error Invalid value of params_t::ncv.
+  void reserve(params_t const& params) {
+    allocate_workspace(ncv_from_params(params));
+    allocate_ritz_vectors(params.n_eigenvalues,
+                          params.compute_vectors != params_t::None);
+  }
+
+  /// Makes the solver store Arnoldi basis vectors in a user-supplied buffer
+  /// instead of an internally allocated matrix.
+  ///
+  /// The buffer is used by all subsequent runs until @ref reset_basis_buffer()
+  /// is called. It must accommodate a column-major matrix with `N` rows and
+  /// `ncv_max` columns, and it must outlive all runs that use it. Schur vectors
+  /// computed by a run are written into its first @ref nconv() columns.
+  /// Ritz and Schur vectors computed by earlier runs become unavailable.
+  ///
+  /// @param buffer Pointer to the first element of the buffer.
+  /// @param ncv_max Number of columns in the buffer. Runs with params_t::ncv
+  /// exceeding this number will be rejected.
+  /// @param ld Leading dimension of the buffer. `-1` stands for `N`.
+  /// @throws std::runtime_error Invalid buffer pointer or dimensions.
+  void set_basis_buffer(double* buffer, unsigned int ncv_max, int ld = -1) {
+    if(buffer == nullptr)
+      throw ARPACK_SOLVER_ERROR("Basis buffer pointer must not be null");
+    if(ncv_max < 1 || int(ncv_max) > N)
+      throw ARPACK_SOLVER_ERROR("ncv_max must be within [1;" +
+                                std::to_string(N) + "]");
+    if(ld == -1)
+      ld = N;
+    else if(ld < N)
+      throw ARPACK_SOLVER_ERROR("Leading dimension of the basis buffer must "
+                                "be at least " + std::to_string(N));
+
+    v_buffer = buffer;
+    v_buffer_ncv = ncv_max;
+    ldv = ld;
+    rvec = false;
+  }
+
+  /// Makes the solver store Arnoldi basis vectors in the internally allocated
+  /// matrix again.
+  ///
+  /// Ritz and Schur vectors computed by earlier runs become unavailable.
+  void reset_basis_buffer() {
+    v_buffer = nullptr;
+    v_buffer_ncv = 0;
+    ldv = storage::get_col_spacing(v) >= 0 ? storage::get_col_spacing(v) : N;
+    rvec = false;
+  }
+
+  /// Sets the memory placement policy for the residual vector, the working
+  /// space of the reverse communication interface (WORKD) and the matrix
+  /// with Arnoldi basis vectors.
+  ///
+  /// The policy is applied to the currently allocated buffers right away
+  /// and to the buffers allocated by subsequent runs. Pages that have
+  /// already been touched are migrated if the kernel allows it. A buffer
+  /// passed to @ref set_basis_buffer() is not affected.
+  /// @param policy Memory placement policy.
+  /// @return `true` if the kernel has accepted all requested advice.
+  bool set_placement(placement_policy const& policy) {
+    placement_ = policy;
+    bool ok = true;
+    ok &= apply_placement(storage::get_data_ptr(resid), N, placement_);
+    ok &= apply_placement(storage::get_data_ptr(workd), 3 * N, placement_);
+    ok &= place_basis();
+    return ok;
+  }
+
+  /// Returns the current memory placement policy.
+  placement_policy const& placement() const { return placement_; }
+
+  /// Sets the thread pool that executes parallel loops in solver calls.
+  ///
+  /// During a call to @ref operator()() and to the post-processing methods
+  /// that compute Ritz vectors or Rayleigh quotients, the pool is installed as
+  /// the executor of parallel_for(). Built-in linear operators, such as
+  /// csr_operator, then run their parallel loops on the pool instead of
+  /// forking an OpenMP team at each Reverse Communication Interface step. The
+  /// pool is not owned by the solver and must outlive all such calls.
+  /// @param pool Thread pool, or `nullptr` to use the pool installed by
+  /// the caller's @ref parallel_context (if any).
+  void set_executor(thread_pool* pool) { executor_ = pool; }
+
+  /// Returns the thread pool set by @ref set_executor().
+  thread_pool* executor() const { return executor_; }
+
+  /// Sets conditions under which subsequent runs are interrupted before
+  /// the IRAM converges.
+  ///
+  /// The conditions are checked every time ARPACK-NG's Reverse Communication
+  /// Interface returns control to the solver. Depending on
+  /// interruption_policy::mode, an interrupted run either throws
+  /// ezarpack::solve_interrupted or completes once the current extension of
+  /// the factorization is finished. In the latter case, @ref interrupted()
+  /// returns `true`, and only the wanted Ritz pairs that satisfy
+  /// params_t::tolerance at that point are computed. @ref nconv() may then be
+  /// smaller than params_t::n_eigenvalues, or even zero.
+  /// @param policy Interruption policy.
+  void set_interruption(interruption_policy const& policy) {
+    interruption_.set_policy(policy);
+  }
+
+  /// Returns the interruption policy set by @ref set_interruption().
+  interruption_policy const& interruption() const {
+    return interruption_.policy();
+  }
+
+  /// Has the last run been interrupted?
+  bool interrupted() const { return interruption_.interrupted(); }
+
+  /// Attaches a recorder of the convergence history to the solver.
+  ///
+  /// During subsequent runs, Ritz values and Ritz estimates computed at every
+  /// implicit restart are stored in the recorder. The recorder is not owned by
+  /// the solver and must outlive all such runs.
+  /// @param trace Recorder, or `nullptr` to stop recording.
+  void set_trace(convergence_trace* trace) { trace_ = trace; }
+
+  /// Returns the recorder set by @ref set_trace().
+  convergence_trace* trace() const { return trace_; }
+
 private:
+  /// @internal Pass Ritz values and Ritz estimates stored in WORKL to
+  /// the convergence trace.
+  void observe_trace(rci_flag ido) {
+    double const* w = storage::get_data_ptr(workl);
+    trace_->observe(ido, iparam, ncv, nev, tol, w + ipntr[5] - 1,
+                    w + ipntr[6] - 1, w + ipntr[7] - 1);
+  }
+
+  /// @internal Make the IRAM stop after the current extension of the
+  /// factorization.
+  ///
+  /// The tolerance is passed to ARPACK-NG at every call, so raising it makes
+  /// the next convergence test accept all wanted Ritz values, and the
+  /// iteration terminates as if it had converged. The requested tolerance is
+  /// restored by settle_interruption().
+  void interrupt_iteration() {
+    requested_tol_ = tol;
+    tol = std::numeric_limits<double>::max();
+  }
+
+  /// @internal Keep only the truly converged Ritz values after an interrupted
+  /// run has terminated.
+  ///
+  /// On exit from dnaupd(), the wanted Ritz values and their Ritz estimates
+  /// occupy the first nev elements of the respective arrays in WORKL. Those
+  /// passing the convergence test of ARPACK-NG with the requested tolerance
+  /// are moved to the front in their original order, and their number is
+  /// stored in IPARAM(5), which dneupd() treats as the number of converged
+  /// Ritz values.
+  void settle_interruption() {
+    if(!interruption_.interrupted()) return;
+    double const eps = std::numeric_limits<double>::epsilon() / 2;
+    tol = requested_tol_ > 0 ? requested_tol_ : eps;
+    double const eps23 = std::pow(eps, 2.0 / 3);
+
+    double* w = storage::get_data_ptr(workl);
+    double* ritzr = w + ipntr[5] - 1;
+    double* ritzi = w + ipntr[6] - 1;
+    double* bounds = w + ipntr[7] - 1;
+    int n_converged = 0;
+    for(int i = 0; i < nev; ++i) {
+      double const threshold =
+          tol * std::max(eps23, std::hypot(ritzr[i], ritzi[i]));
+      if(std::abs(bounds[i]) > threshold) continue;
+      std::rotate(ritzr + n_converged, ritzr + i, ritzr + i + 1);
+      std::rotate(ritzi + n_converged, ritzi + i, ritzi + i + 1);
+      std::rotate(bounds + n_converged, bounds + i, bounds + i + 1);
+      ++n_converged;
+    }
+    iparam[4] = n_converged;
+  }
+
+  /// @internal Check the interruption conditions during a step-wise run,
+  /// which is abandoned if ezarpack::solve_interrupted is thrown.
+  void check_step_interruption() {
+    try {
+      if(interruption_.check()) interrupt_iteration();
+    } catch(...) {
+      step_started_ = false;
+      step_ido_ = Done;
+      throw;
+    }
+  }
+
+  /// @internal Start a step-wise run.
+  ///
+  /// @param mode Computational mode, 1 for standard eigenproblems.
+  /// @param params Set of input parameters for the IRAM.
+  void begin_steps(int mode, params_t const& params) {
+    step_started_ = false;
+    prepare(params);
+
+    iparam[0] = 1;    // Exact shifts
+    iparam[6] = mode; // Modes 1-4
+
+    step_mode_ = mode;
+    if(mode != 1 && mode != Inverse) {
+      sigmar = params.sigma.real();
+      sigmai = params.sigma.imag();
+    }
+    step_ido_ = Init;
+    Bx_available_ = false;
+    step_started_ = true;
+  }
+
+  /// @internal Describe the current request of a step-wise run.
+  step_t make_step(rci_flag request) {
+    // ipntr is meaningless once the iteration has been completed
+    int in_pos = (request != Done) ? in_vector_n() * N : 0;
+    int out_pos = (request != Done) ? out_vector_n() * N : N;
+    return {request, storage::make_vector_view(workd, in_pos, N),
+            storage::make_vector_view(workd, out_pos, N)};
+  }
+
+  /// @internal Pointer to the data array of z.
+  double const* z_data() const {
+    // get_data_ptr() is not required to accept constant containers
+    return storage::get_data_ptr(const_cast<real_vector_t&>(z));
+  }
+
+  /// @internal Pointer to the data array of di.
+  double const* di_data() const {
+    return storage::get_data_ptr(const_cast<real_vector_t&>(di));
+  }
+
+  /// @internal Compute eigenvalues as Rayleigh quotients of the Ritz vectors.
+  template<typename A> complex_vector_t rayleigh_quotients(A& a) const {
+    complex_vector_t lambda = storage::make_complex_vector(nconv());
+    rayleigh_quotients(a, storage::get_data_ptr(lambda),
+                       is_block_operator<typename std::decay<A>::type>());
+    return lambda;
+  }
+
+  /// @internal Apply a block operator to the first chunks of z in a single
+  /// call and compute the Rayleigh quotients.
+  template<typename A>
+  void rayleigh_quotients(A& a, dcomplex* lambda, std::true_type) const {
+    int const n_chunks = asymm_ritz_chunks(di_data(), nconv());
+    if(n_chunks == 0) return;
+    real_vector_t az = storage::make_real_vector(N * n_chunks);
+    try {
+      a(storage::make_vector_const_view(z, 0, N * n_chunks),
+        storage::make_vector_view(az, 0, N * n_chunks), n_chunks);
+    } catch(...) {
+      storage::destroy(az);
+      throw;
+    }
+    asymm_rayleigh_quotients(z_data(), storage::get_data_ptr(az), di_data(),
+                             N, nconv(), lambda);
+    storage::destroy(az);
+  }
+
+  /// @internal Apply an operator to the Ritz vectors one by one and compute
+  /// the Rayleigh quotients. Thread-safe operators are applied concurrently.
+  ///
+  /// Each thread copies chunks of z into its own scratch vector of length N
+  /// before applying the operator, so that the views passed to the operator
+  /// do not start at offsets that may exceed the range of `int`.
+  template<typename A>
+  void rayleigh_quotients(A& a, dcomplex* lambda, std::false_type) const {
+    // Chunks holding real Ritz vectors and real parts of complex Ritz vectors
+    int const n = nconv();
+    double const* di_ptr = di_data();
+    std::vector<int> starts;
+    for(int i = 0; i < n; i += (di_ptr[i] == 0) ? 1 : 2)
+      starts.push_back(i);
+    int const n_starts = int(starts.size());
+
+    int const n_threads =
+        is_thread_safe_operator<typename std::decay<A>::type>::value
+            ? std::min(parallel_concurrency(), n_starts)
+            : std::min(1, n_starts);
+    parallel_for(n_threads, [&](int t) {
+      real_vector_t x = storage::make_real_vector(N);
+      real_vector_t ax = storage::make_real_vector(N);
+      double* x_ptr = storage::get_data_ptr(x);
+      double const* ax_ptr = storage::get_data_ptr(ax);
+      // Apply the operator to a chunk of z and return scalar products of
+      // the result with chunks x1 and x2 of z
+      auto apply = [&](double const* chunk, double const* x1,
+                       double const* x2, double& s1, double& s2) {
+        std::copy(chunk, chunk + N, x_ptr);
+        a(storage::make_vector_const_view(x, 0, N),
+          storage::make_vector_view(ax, 0, N));
+        s1 = s2 = 0;
+        for(int k = 0; k < N; ++k) {
+          s1 += x1[k] * ax_ptr[k];
+          s2 += x2[k] * ax_ptr[k];
+        }
+      };
+      try {
+        for(int p = t; p < n_starts; p += n_threads) {
+          int const i = starts[p];
+          double const* x1 = z_data() + std::ptrdiff_t(i) * N;
+          double s11, s21, s12, s22;
+          if(di_ptr[i] == 0) {
+            apply(x1, x1, x1, s11, s21);
+            lambda[i] = s11;
+          } else {
+            double const* x2 = x1 + N;
+            apply(x1, x1, x2, s11, s21);
+            apply(x2, x1, x2, s12, s22);
+            lambda[i] = dcomplex(s11 + s22, s12 - s21);
+            if(i + 1 < n) lambda[i + 1] = std::conj(lambda[i]);
+          }
+        }
+      } catch(...) {
+        storage::destroy(x);
+        storage::destroy(ax);
+        throw;
+      }
+      storage::destroy(x);
+      storage::destroy(ax);
+    });
+  }
+
   /// @internal Translate dnaupd's INFO codes into C++ exceptions.
   ///
   /// @param error_code dnaupd's INFO code.
-  void handle_aupd_error_codes(int error_code, real_vector_t& workl) {
+  void handle_aupd_error_codes(int error_code) {
     if(error_code == 0) return;
 
-    storage::destroy(workl);
     switch(error_code) {
       case 1: throw(maxiter_reached(iparam[2]));
       case 3: throw(ncv_insufficient(ncv));
@@ -747,6 +1456,8 @@ private:
         throw ARPACK_SOLVER_ERROR(
             "Error in LAPACK calculation of eigenvectors (dtrevc)");
       case -14:
+        // An interrupted run may end without converged Ritz values
+        if(interrupted()) return;
         throw ARPACK_SOLVER_ERROR(
             "dnaupd did not find any eigenvalues to sufficient accuracy");
       default:
@@ -19,6 +19,13 @@
 #include <utility>
 
 #include "arpack.hpp"
+#include "block_operator.hpp"
+#include "cancellation.hpp"
+#include "convergence_trace.hpp"
+#include "parallel.hpp"
+#include "placement.hpp"
+#include "ritz_kernels.hpp"
+#include "timing.hpp"
 
 #include "storages/base.hpp"
 
@@ -0,0 +1,470 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/sparse_shift_invert.hpp
+/// @brief Spectral transformations of generalized eigenproblems with sparse
+/// matrices, based on the sparse direct solvers of Eigen 3.
+///
+/// This header requires Eigen 3 regardless of the storage backend used by
+/// the solver.
+#pragma once
+
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseCore>
+#include <Eigen/SparseLU>
+
+#include "common.hpp"
+#include "view_data.hpp"
+
+namespace ezarpack {
+
+/// @internal Sparse direct solver of linear systems whose matrices share
+/// the same sparsity pattern.
+///
+/// Self-adjoint matrices are factorized with `Eigen::SimplicialLDLT`, which
+/// performs no pivoting. Should it fail, as well as for general matrices,
+/// `Eigen::SparseLU` is used instead. The sparsity pattern is analyzed upon
+/// the first factorization only.
+/// @tparam T Type of matrix elements.
+template<typename T> class sparse_direct_solver {
+  using matrix_type = Eigen::SparseMatrix<T>;
+
+  Eigen::SimplicialLDLT<matrix_type> ldlt_;
+  Eigen::SparseLU<matrix_type> lu_;
+  bool ldlt_analyzed_ = false;
+  bool lu_analyzed_ = false;
+  bool use_ldlt_ = false;
+
+public:
+  /// Factorizes a matrix.
+  /// @param K Matrix in the compressed mode.
+  /// @param selfadjoint Is `K` self-adjoint?
+  /// @throws std::runtime_error The matrix could not be factorized.
+  void factorize(matrix_type const& K, bool selfadjoint) {
+    if(selfadjoint) {
+      if(!ldlt_analyzed_) {
+        ldlt_.analyzePattern(K);
+        ldlt_analyzed_ = true;
+      }
+      ldlt_.factorize(K);
+      use_ldlt_ = (ldlt_.info() == Eigen::Success);
+      if(use_ldlt_) return;
+    }
+    if(!lu_analyzed_) {
+      lu_.analyzePattern(K);
+      lu_analyzed_ = true;
+    }
+    lu_.factorize(K);
+    if(lu_.info() != Eigen::Success)
+      throw std::runtime_error(
+          "sparse_shift_invert: Sparse factorization has failed");
+  }
+
+  /// Number of negative pivots of the @f$ LDL^T @f$ factorization, which is
+  /// the number of negative eigenvalues of a self-adjoint matrix.
+  /// @throws std::runtime_error The matrix has not been factorized with
+  /// `Eigen::SimplicialLDLT`.
+  int n_negative_pivots() const {
+    if(!use_ldlt_)
+      throw std::runtime_error("sparse_shift_invert: Inertia of the matrix is "
+                               "not available without LDLT factorization");
+    auto const& D = ldlt_.vectorD();
+    int n = 0;
+    for(Eigen::Index i = 0; i < D.size(); ++i) {
+      if(std::real(D(i)) < 0) ++n;
+    }
+    return n;
+  }
+
+  /// Solves @f$ \hat K \mathbf{x} = \mathbf{b} @f$.
+  /// @param b Right-hand side.
+  /// @param x Solution.
+  template<typename B, typename X> void solve(B const& b, X&& x) const {
+    if(use_ldlt_)
+      x = ldlt_.solve(b);
+    else
+      x = lu_.solve(b);
+  }
+};
+
+/// @brief Linear operators @f$ \hat O @f$ and @f$ \hat B @f$ of
+/// a spectral transformation of a generalized eigenproblem
+/// @f$ \hat A\mathbf{x} = \lambda\hat M\mathbf{x} @f$ with sparse matrices.
+///
+/// This class is a ready-made implementation of the `op` and `b` arguments
+/// of the generalized version of `arpack_solver::operator()`. Depending on
+/// the computational mode, it factorizes @f$ \hat M @f$ or
+/// @f$ \hat A - \sigma\hat M @f$ with a sparse direct solver of Eigen 3
+/// (`Eigen::SimplicialLDLT` for symmetric eigenproblems and for
+/// @f$ \hat M @f$, and `Eigen::SparseLU` otherwise) and applies its inverse
+/// by forward and backward substitution.
+///
+/// | OpKind     | Mode                 | Factorized matrix                 |
+/// |------------|----------------------|-----------------------------------|
+/// | Symmetric  | `Inverse`            | @f$ \hat M @f$                    |
+/// | Symmetric  | `ShiftAndInvert`     | @f$ \hat A - \sigma\hat M @f$     |
+/// | Symmetric  | `Buckling`           | @f$ \hat A - \sigma\hat M @f$     |
+/// | Symmetric  | `Cayley`             | @f$ \hat A - \sigma\hat M @f$     |
+/// | Asymmetric | `Inverse`            | @f$ \hat M @f$                    |
+/// | Asymmetric | `ShiftAndInvertReal` | @f$ \hat A - \sigma\hat M @f$     |
+/// | Asymmetric | `ShiftAndInvertImag` | @f$ \hat A - \sigma\hat M @f$     |
+/// | Complex    | `Inverse`            | @f$ \hat M @f$                    |
+/// | Complex    | `ShiftAndInvert`     | @f$ \hat A - \sigma\hat M @f$     |
+///
+/// In the Buckling mode, @f$ \hat A @f$ and @f$ \hat M @f$ stand for
+/// the stiffness matrix @f$ \hat K @f$ and the geometric stiffness matrix
+/// @f$ \hat K_G @f$ respectively. For the asymmetric eigenproblems, a complex
+/// factorization is computed when the shift has a non-zero imaginary part.
+///
+/// When @f$ \hat M @f$ is omitted, it is the identity matrix. Passing
+/// the operators to the generalized version of `arpack_solver::operator()`
+/// then finds eigenvalues of a standard eigenproblem nearest to
+/// @f$ \sigma @f$, which are correctly back-transformed by the solver.
+///
+/// The factorization is kept by the object and reused by all subsequent runs.
+/// @ref set_sigma() refactorizes @f$ \hat A - \sigma\hat M @f$ for a new shift
+/// without repeating the analysis of its sparsity pattern. The operators refer
+/// to the object, which must outlive them. They use internal buffers and must
+/// not be applied from concurrent threads.
+///
+/// Example:
+/// @code
+/// using solver_t = arpack_solver<Symmetric, eigen_storage>;
+/// sparse_shift_invert<Symmetric> si(A, M, solver_t::ShiftAndInvert, sigma);
+/// params.sigma = sigma;
+/// solver(si.op(), si.b(), solver_t::ShiftAndInvert, params);
+/// @endcode
+///
+/// @tparam OpKind Kind of eigenproblems to be solved.
+template<operator_kind OpKind> class sparse_shift_invert {
+public:
+  /// Type of matrix elements.
+  using scalar_type =
+      typename std::conditional<OpKind == Complex, dcomplex, double>::type;
+  /// Type of sparse matrices.
+  using matrix_type = Eigen::SparseMatrix<scalar_type>;
+  /// Type of the spectral shift.
+  using shift_type =
+      typename std::conditional<OpKind == Symmetric, double, dcomplex>::type;
+
+private:
+  using vector_type = Eigen::Matrix<scalar_type, Eigen::Dynamic, 1>;
+  using complex_matrix_type = Eigen::SparseMatrix<dcomplex>;
+  using complex_vector_type = Eigen::Matrix<dcomplex, Eigen::Dynamic, 1>;
+  template<operator_kind K>
+  using kind = std::integral_constant<operator_kind, K>;
+
+  int n_;            // Dimension
+  matrix_type A_;    // Matrix A
+  matrix_type M_;    // Matrix M (identity if not given)
+  bool has_M_;       // Has M been given?
+  int mode_;         // Computational mode
+  shift_type sigma_; // Spectral shift
+
+  // Is A - sigma*M factorized in complex arithmetic?
+  bool complex_factorization_ = false;
+
+  sparse_direct_solver<scalar_type> solver_;
+  sparse_direct_solver<dcomplex> complex_solver_;
+
+  // Temporary vectors
+  mutable vector_type tmp_;
+  mutable complex_vector_type complex_rhs_;
+  mutable complex_vector_type complex_x_;
+
+public:
+  /// Linear operator @f$ \hat O @f$.
+  class op_type {
+    sparse_shift_invert const* parent_;
+
+  public:
+    /// @internal
+    explicit op_type(sparse_shift_invert const* parent) : parent_(parent) {}
+
+    /// Acts with @f$ \hat O @f$ on `in` and writes the result into `out`.
+    template<typename In, typename Out>
+    void operator()(In&& in, Out&& out) const {
+      parent_->apply_op(view_data(in), view_data(out), kind<OpKind>());
+    }
+  };
+
+  /// Linear operator @f$ \hat B @f$.
+  class b_type {
+    sparse_shift_invert const* parent_;
+
+  public:
+    /// @internal
+    explicit b_type(sparse_shift_invert const* parent) : parent_(parent) {}
+
+    /// Acts with @f$ \hat B @f$ on `in` and writes the result into `out`.
+    template<typename In, typename Out>
+    void operator()(In&& in, Out&& out) const {
+      parent_->apply_b(view_data(in), view_data(out));
+    }
+  };
+
+  /// Constructs operators of a generalized eigenproblem and computes
+  /// the factorization.
+  /// @param A Matrix @f$ \hat A @f$.
+  /// @param M Matrix @f$ \hat M @f$.
+  /// @param mode Computational mode of `arpack_solver<OpKind, Backend>`, such
+  /// as `arpack_solver<OpKind, Backend>::ShiftAndInvert`.
+  /// @param sigma Spectral shift @f$ \sigma @f$. It is not used in
+  /// the Inverse mode.
+  /// @throws std::runtime_error Invalid mode, matrix dimensions or shift,
+  /// or failed factorization.
+  sparse_shift_invert(matrix_type A,
+                      matrix_type M,
+                      int mode,
+                      shift_type sigma = shift_type(0))
+      : n_(int(A.rows())),
+        A_(std::move(A)),
+        M_(std::move(M)),
+        has_M_(true),
+        mode_(mode),
+        sigma_(sigma) {
+    init();
+  }
+
+  /// Constructs operators of a standard eigenproblem
+  /// (@f$ \hat M @f$ is the identity matrix) and computes the factorization.
+  /// @param A Matrix @f$ \hat A @f$.
+  /// @param mode Computational mode of `arpack_solver<OpKind, Backend>`, such
+  /// as `arpack_solver<OpKind, Backend>::ShiftAndInvert`.
+  /// @param sigma Spectral shift @f$ \sigma @f$.
+  /// @throws std::runtime_error Invalid mode, matrix dimensions or shift,
+  /// or failed factorization.
+  sparse_shift_invert(matrix_type A, int mode, shift_type sigma = shift_type(0))
+      : n_(int(A.rows())),
+        A_(std::move(A)),
+        M_(n_, n_),
+        has_M_(false),
+        mode_(mode),
+        sigma_(sigma) {
+    M_.setIdentity();
+    init();
+  }
+
+  sparse_shift_invert(sparse_shift_invert const&) = delete;
+  sparse_shift_invert& operator=(sparse_shift_invert const&) = delete;
+
+  /// Dimension of the eigenproblem.
+  int dim() const { return n_; }
+
+  /// Computational mode.
+  int mode() const { return mode_; }
+
+  /// Spectral shift.
+  shift_type sigma() const { return sigma_; }
+
+  /// Changes the spectral shift and refactorizes
+  /// @f$ \hat A - \sigma\hat M @f$.
+  /// @param sigma New spectral shift.
+  /// @throws std::runtime_error Invalid shift or failed factorization.
+  void set_sigma(shift_type sigma) {
+    sigma_ = sigma;
+    factorize();
+  }
+
+  /// Number of eigenvalues of a symmetric eigenproblem below the spectral
+  /// shift.
+  ///
+  /// By Sylvester's law of inertia, it equals the number of negative pivots
+  /// in the @f$ LDL^T @f$ factorization of @f$ \hat A - \sigma\hat M @f$,
+  /// provided that @f$ \hat M @f$ is positive definite. This makes
+  /// the method an exact eigenvalue count function for @ref spectrum_slicer.
+  /// @throws std::runtime_error The eigenproblem is not symmetric, the mode is
+  /// neither `ShiftAndInvert` nor `Cayley`, or
+  /// @f$ \hat A - \sigma\hat M @f$ is too ill-conditioned to be factorized
+  /// without pivoting.
+  int n_eigenvalues_below_sigma() const {
+    if(OpKind != Symmetric || (mode_ != 3 && mode_ != 5))
+      throw std::runtime_error("sparse_shift_invert: Eigenvalue counts are "
+                               "only available for symmetric eigenproblems "
+                               "in the ShiftAndInvert and Cayley modes");
+    return solver_.n_negative_pivots();
+  }
+
+  /// Returns linear operator @f$ \hat O @f$ to be passed to
+  /// `arpack_solver::operator()` as `op`.
+  op_type op() const { return op_type(this); }
+
+  /// Returns linear operator @f$ \hat B @f$ to be passed to
+  /// `arpack_solver::operator()` as `b`.
+  b_type b() const { return b_type(this); }
+
+private:
+  /// @internal Check arguments and compute the factorization.
+  void init() {
+    if(A_.rows() != A_.cols())
+      throw std::runtime_error("sparse_shift_invert: Matrix A must be square");
+    if(M_.rows() != n_ || M_.cols() != n_)
+      throw std::runtime_error("sparse_shift_invert: Matrix M must be of "
+                               "the same size as A");
+    int const max_mode =
+        (OpKind == Symmetric) ? 5 : (OpKind == Asymmetric ? 4 : 3);
+    if(mode_ < 2 || mode_ > max_mode)
+      throw std::runtime_error("sparse_shift_invert: Unsupported mode " +
+                               std::to_string(mode_));
+    tmp_.resize(n_);
+    factorize();
+  }
+
+  /// @internal Factorize M or A - sigma*M depending on the mode.
+  void factorize() {
+    complex_factorization_ = false;
+    if(mode_ == 2) { // Inverse
+      if(has_M_) {
+        M_.makeCompressed();
+        solver_.factorize(M_, true);
+      }
+      return;
+    }
+    factorize_shifted(kind<OpKind>());
+  }
+
+  /// @internal Factorize A - sigma*M, symmetric eigenproblems.
+  void factorize_shifted(kind<Symmetric>) {
+    matrix_type K = A_ - sigma_ * M_;
+    K.makeCompressed();
+    solver_.factorize(K, true);
+  }
+
+  /// @internal Factorize A - sigma*M, asymmetric eigenproblems.
+  void factorize_shifted(kind<Asymmetric>) {
+    if(mode_ == 4 && sigma_.imag() == 0)
+      throw std::runtime_error("sparse_shift_invert: ShiftAndInvertImag mode "
+                               "requires a shift with a non-zero imaginary "
+                               "part");
+    if(sigma_.imag() == 0) {
+      matrix_type K = A_ - sigma_.real() * M_;
+      K.makeCompressed();
+      solver_.factorize(K, false);
+    } else {
+      complex_matrix_type K =
+          A_.template cast<dcomplex>() - sigma_ * M_.template cast<dcomplex>();
+      K.makeCompressed();
+      complex_solver_.factorize(K, false);
+      complex_factorization_ = true;
+      complex_rhs_.resize(n_);
+      complex_x_.resize(n_);
+    }
+  }
+
+  /// @internal Factorize A - sigma*M, complex eigenproblems.
+  void factorize_shifted(kind<Complex>) {
+    matrix_type K = A_ - sigma_ * M_;
+    K.makeCompressed();
+    solver_.factorize(K, false);
+  }
+
+  /// @internal Compute tmp_ = M * x.
+  template<typename X> void apply_M(X const& x) const {
+    if(has_M_)
+      tmp_ = M_ * x;
+    else
+      tmp_ = x;
+  }
+
+  /// @internal Apply M^{-1} to tmp_.
+  template<typename Y> void solve_M(Y&& y) const {
+    if(has_M_)
+      solver_.solve(tmp_, y);
+    else
+      y = tmp_;
+  }
+
+  /// @internal Act with O, symmetric eigenproblems.
+  ///
+  /// In the Inverse mode, the input vector is overwritten with
+  /// @f$ \hat A\mathbf{x} @f$ as required by `dsaupd()`.
+  void apply_op(scalar_type* in, scalar_type* out, kind<Symmetric>) const {
+    Eigen::Map<vector_type> x(in, n_);
+    Eigen::Map<vector_type> y(out, n_);
+    switch(mode_) {
+      case 2: // Inverse
+        tmp_ = A_ * x;
+        x = tmp_;
+        solve_M(y);
+        break;
+      case 3: // ShiftAndInvert
+        apply_M(x);
+        solver_.solve(tmp_, y);
+        break;
+      case 4: // Buckling
+        tmp_ = A_ * x;
+        solver_.solve(tmp_, y);
+        break;
+      case 5: // Cayley
+        apply_M(x);
+        tmp_ = A_ * x + sigma_ * tmp_;
+        solver_.solve(tmp_, y);
+        break;
+    }
+  }
+
+  /// @internal Act with O, asymmetric eigenproblems.
+  void
+  apply_op(scalar_type const* in, scalar_type* out, kind<Asymmetric>) const {
+    Eigen::Map<const vector_type> x(in, n_);
+    Eigen::Map<vector_type> y(out, n_);
+    if(mode_ == 2) { // Inverse
+      tmp_ = A_ * x;
+      solve_M(y);
+      return;
+    }
+    apply_M(x);
+    if(!complex_factorization_) {
+      solver_.solve(tmp_, y);
+      return;
+    }
+    complex_rhs_ = tmp_.template cast<dcomplex>();
+    complex_solver_.solve(complex_rhs_, complex_x_);
+    if(mode_ == 3) // ShiftAndInvertReal
+      y = complex_x_.real();
+    else // ShiftAndInvertImag
+      y = complex_x_.imag();
+  }
+
+  /// @internal Act with O, complex eigenproblems.
+  void apply_op(scalar_type const* in, scalar_type* out, kind<Complex>) const {
+    Eigen::Map<const vector_type> x(in, n_);
+    Eigen::Map<vector_type> y(out, n_);
+    if(mode_ == 2) { // Inverse
+      tmp_ = A_ * x;
+      solve_M(y);
+    } else { // ShiftAndInvert
+      apply_M(x);
+      solver_.solve(tmp_, y);
+    }
+  }
+
+  /// @internal Act with B.
+  void apply_b(scalar_type const* in, scalar_type* out) const {
+    Eigen::Map<const vector_type> x(in, n_);
+    Eigen::Map<vector_type> y(out, n_);
+    if(OpKind == Symmetric && mode_ == 4) // Buckling
+      y = A_ * x;
+    else if(has_M_)
+      y = M_ * x;
+    else
+      y = x;
+  }
+};
+
+} // namespace ezarpack
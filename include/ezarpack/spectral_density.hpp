@@ -0,0 +1,409 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/spectral_density.hpp
+/// @brief Stochastic estimation of the spectral density and of eigenvalue
+/// counts of real symmetric operators (Kernel Polynomial Method).
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "block_operator.hpp"
+#include "parallel.hpp"
+#include "polynomial_filter.hpp"
+
+namespace ezarpack {
+
+/// Parameters of the Kernel Polynomial Method.
+struct kpm_params {
+  /// Degree of the Chebyshev expansion.
+  int degree = 100;
+  /// Number of random probe vectors.
+  int n_probes = 32;
+  /// Number of probe vectors processed together.
+  int block_size = 8;
+  /// Damping of the Gibbs oscillations.
+  filter_damping damping = JacksonDamping;
+  /// Seed of the pseudo-random probe vectors.
+  unsigned int seed = 0;
+  /// Number of Lanczos steps to be made by estimate_spectral_bounds() when
+  /// the spectral bounds are not given.
+  int n_lanczos_steps = 20;
+};
+
+/// @brief Spectral density of a real symmetric linear operator
+/// @f$ \hat A @f$ estimated with the Kernel Polynomial Method.
+///
+/// The density is represented by its Chebyshev moments
+/// @f$ \mu_k = \mathrm{Tr}[T_k(\hat B)] / N @f$, where
+/// @f$ \hat B = (\hat A - c)/e @f$ and @f$ c @f$, @f$ e @f$ are the center and
+/// the half-width of the spectral bounds. The moments are estimated
+/// stochastically, @f$ \mu_k \approx \langle\mathbf{z}^T T_k(\hat B)\mathbf{z}
+/// \rangle / N @f$, by averaging over random probe vectors @f$ \mathbf{z} @f$
+/// (Hutchinson's estimator). Moments of the individual probes are kept to
+/// estimate statistical errors.
+///
+/// Objects of this class are returned by estimate_spectral_density().
+class spectral_density {
+  int N_;                             // Dimension of the operator
+  spectral_interval bounds_;          // Bounds of the spectrum
+  filter_damping damping_;            // Damping of the Gibbs oscillations
+  int n_probes_;                      // Number of probe vectors
+  std::vector<double> probe_moments_; // Moments of the individual probes
+  std::vector<double> moments_;       // Average moments
+
+public:
+  /// Constructs a spectral density from the Chebyshev moments of
+  /// individual probe vectors.
+  /// @param N Dimension of @f$ \hat A @f$.
+  /// @param bounds Interval containing the spectrum of @f$ \hat A @f$.
+  /// @param damping Damping of the Gibbs oscillations.
+  /// @param n_probes Number of probe vectors.
+  /// @param probe_moments Moments @f$ \mathbf{z}^T T_k(\hat B)\mathbf{z} / N
+  /// @f$, stored as a column-major matrix with @f$ d + 1 @f$ rows and
+  /// `n_probes` columns, @f$ d @f$ being the degree of the expansion.
+  /// @throws std::runtime_error Invalid arguments.
+  spectral_density(int N,
+                   spectral_interval bounds,
+                   filter_damping damping,
+                   int n_probes,
+                   std::vector<double> probe_moments)
+      : N_(N),
+        bounds_(bounds),
+        damping_(damping),
+        n_probes_(n_probes),
+        probe_moments_(std::move(probe_moments)) {
+    if(N_ < 1 || n_probes_ < 1 || !(bounds_.lower < bounds_.upper) ||
+       probe_moments_.empty() || probe_moments_.size() % n_probes_ != 0)
+      throw std::runtime_error("spectral_density: Invalid arguments");
+    int const n_moments = int(probe_moments_.size()) / n_probes_;
+    moments_.assign(n_moments, 0);
+    for(int p = 0; p < n_probes_; ++p) {
+      for(int k = 0; k < n_moments; ++k)
+        moments_[k] += probe_moments_[p * n_moments + k] / n_probes_;
+    }
+  }
+
+  /// Dimension of @f$ \hat A @f$.
+  int dim() const { return N_; }
+
+  /// Bounds of the spectrum of @f$ \hat A @f$.
+  spectral_interval bounds() const { return bounds_; }
+
+  /// Degree of the Chebyshev expansion.
+  int degree() const { return int(moments_.size()) - 1; }
+
+  /// Damping of the Gibbs oscillations.
+  filter_damping damping() const { return damping_; }
+
+  /// Number of probe vectors.
+  int n_probes() const { return n_probes_; }
+
+  /// Estimated Chebyshev moments @f$ \mu_k @f$.
+  std::vector<double> const& moments() const { return moments_; }
+
+  /// Spectral density @f$ \rho(\lambda) @f$, normalized to the dimension of
+  /// @f$ \hat A @f$.
+  /// @param lambda Argument.
+  double density(double lambda) const {
+    double const c = (bounds_.upper + bounds_.lower) / 2;
+    double const e = (bounds_.upper - bounds_.lower) / 2;
+    double const x = (lambda - c) / e;
+    if(x <= -1 || x >= 1) return 0;
+
+    std::vector<double> const g = chebyshev_damping_factors(degree(), damping_);
+    double rho = g[0] * moments_[0];
+    double t_prev = 1, t_cur = x;
+    for(int k = 1; k <= degree(); ++k) {
+      rho += 2 * g[k] * moments_[k] * t_cur;
+      double const t_next = 2 * x * t_cur - t_prev;
+      t_prev = t_cur;
+      t_cur = t_next;
+    }
+    double const pi = std::acos(-1.0);
+    return N_ * rho / (pi * e * std::sqrt(1 - x * x));
+  }
+
+  /// Estimated number of eigenvalues within a window.
+  /// @param window Window.
+  double count(spectral_interval window) const {
+    std::vector<double> const c = coefficients(window);
+    double n = 0;
+    for(int k = 0; k <= degree(); ++k)
+      n += c[k] * moments_[k];
+    return N_ * n;
+  }
+
+  /// Standard error of @ref count(), estimated from the spread of
+  /// the counts obtained with individual probe vectors. It is zero for
+  /// a single probe vector.
+  /// @param window Window.
+  double count_error(spectral_interval window) const {
+    if(n_probes_ == 1) return 0;
+    std::vector<double> const c = coefficients(window);
+    int const n_moments = degree() + 1;
+    double const mean = count(window);
+    double var = 0;
+    for(int p = 0; p < n_probes_; ++p) {
+      double n = 0;
+      for(int k = 0; k < n_moments; ++k)
+        n += c[k] * probe_moments_[p * n_moments + k];
+      var += (N_ * n - mean) * (N_ * n - mean);
+    }
+    var /= n_probes_ - 1;
+    return std::sqrt(var / n_probes_);
+  }
+
+  /// Estimated number of eigenvalues below a given number. This method can
+  /// serve as an eigenvalue count function for @ref spectrum_slicer.
+  /// @param x Argument.
+  double count_below(double x) const {
+    if(x <= bounds_.lower) return 0;
+    if(x >= bounds_.upper) return N_;
+    return count({bounds_.lower, x});
+  }
+
+  /// Sets the number of eigenvalues and the number of Lanczos vectors in
+  /// parameters of `arpack_solver` so that all eigenvalues within a window
+  /// can be computed.
+  ///
+  /// The number of eigenvalues is the estimated count rounded up and
+  /// increased by a multiple of its standard error. The number of Lanczos
+  /// vectors is twice the number of eigenvalues plus 2, but not more than
+  /// the dimension.
+  /// @tparam Params Type of the parameters, such as
+  /// `arpack_solver<Symmetric, Backend>::params_t`.
+  /// @param params Parameters to update.
+  /// @param window Window.
+  /// @param n_errors Number of standard errors to add to the count.
+  template<typename Params>
+  void tune_params(Params& params,
+                   spectral_interval window,
+                   double n_errors = 2) const {
+    double const n = count(window) + n_errors * count_error(window);
+    int const nev = std::max(1, std::min(int(std::ceil(n)), N_ - 1));
+    params.n_eigenvalues = nev;
+    params.ncv = std::min(2 * nev + 2, N_);
+  }
+
+private:
+  /// @internal Undamped Chebyshev expansion coefficients of the indicator
+  /// function of a window, multiplied by the damping factors.
+  std::vector<double> coefficients(spectral_interval window) const {
+    if(!(window.lower < window.upper))
+      throw std::runtime_error("spectral_density: The window must not be "
+                               "empty");
+    return chebyshev_window_coefficients(window, bounds_, degree(), damping_);
+  }
+};
+
+/// @internal Apply a block operator to a block of `k` vectors in a single
+/// call.
+template<typename Backend, typename A>
+void apply_to_block(A& a,
+                    typename storage_traits<Backend>::real_vector_type& in,
+                    typename storage_traits<Backend>::real_vector_type& out,
+                    int N,
+                    int k,
+                    std::true_type) {
+  using storage = storage_traits<Backend>;
+  a(storage::make_vector_const_view(in, 0, N * k),
+    storage::make_vector_view(out, 0, N * k), k);
+}
+
+/// @internal Apply an operator to a block of `k` vectors one by one.
+/// Thread-safe operators are applied concurrently.
+template<typename Backend, typename A>
+void apply_to_block(A& a,
+                    typename storage_traits<Backend>::real_vector_type& in,
+                    typename storage_traits<Backend>::real_vector_type& out,
+                    int N,
+                    int k,
+                    std::false_type) {
+  using storage = storage_traits<Backend>;
+  auto apply = [&](int i) {
+    a(storage::make_vector_const_view(in, i * N, N),
+      storage::make_vector_view(out, i * N, N));
+  };
+  if(is_thread_safe_operator<typename std::decay<A>::type>::value)
+    parallel_for(k, apply);
+  else
+    for(int i = 0; i < k; ++i)
+      apply(i);
+}
+
+/// @brief Estimates the spectral density of a real symmetric linear operator
+/// with the Kernel Polynomial Method, given bounds of its spectrum.
+///
+/// Chebyshev moments are computed for Rademacher probe vectors (random
+/// @f$ \pm 1 @f$ elements). The probes are processed in blocks of
+/// kpm_params::block_size vectors. If `a` is a @ref block_operator,
+/// @f$ \hat A @f$ is applied to a whole block in a single call. If it is
+/// a @ref thread_safe_operator, the vectors of a block are processed
+/// concurrently by parallel_for(). Using the identities
+/// @f$ T_{2k} = 2T_k^2 - T_0 @f$ and @f$ T_{2k+1} = 2T_{k+1}T_k - T_1 @f$,
+/// an expansion of degree @f$ d @f$ costs about @f$ d/2 @f$ applications of
+/// @f$ \hat A @f$ per probe vector. The probe vectors are generated with
+/// a fixed seed, so that the estimate does not depend on the block size or on
+/// the number of threads.
+///
+/// Example:
+/// @code
+/// auto dos = estimate_spectral_density<eigen_storage>(A, N);
+/// solver_t::params_t params(1, solver_t::params_t::Largest, true);
+/// dos.tune_params(params, {a, b});
+/// @endcode
+///
+/// @tparam Backend Storage backend used to allocate the Chebyshev vectors.
+/// @param a Linear operator @f$ \hat A @f$ called as
+/// `a(vector_const_view_t in, vector_view_t out)`, where the view types are
+/// those of `arpack_solver<Symmetric, Backend>`.
+/// @param N Dimension of the operator.
+/// @param bounds Interval containing the spectrum of @f$ \hat A @f$.
+/// @param params Parameters of the method.
+/// @throws std::runtime_error Invalid dimension, bounds or parameters.
+template<typename Backend, typename A>
+spectral_density estimate_spectral_density(
+    A&& a,
+    int N,
+    spectral_interval bounds,
+    kpm_params const& params = kpm_params()) {
+  using storage = storage_traits<Backend>;
+  using real_vector_t = typename storage::real_vector_type;
+
+  if(N < 1)
+    throw std::runtime_error(
+        "estimate_spectral_density: Dimension must be positive");
+  if(!(bounds.lower < bounds.upper))
+    throw std::runtime_error(
+        "estimate_spectral_density: Invalid spectral bounds");
+  if(params.degree < 1 || params.n_probes < 1 || params.block_size < 1)
+    throw std::runtime_error(
+        "estimate_spectral_density: Invalid parameters of the method");
+
+  int const d = params.degree;
+  int const n_moments = d + 1;
+  int const block_size = std::min(params.block_size, params.n_probes);
+  double const c = (bounds.upper + bounds.lower) / 2;
+  double const inv_e = 2 / (bounds.upper - bounds.lower);
+
+  // Probe vectors, previous and current Chebyshev vectors, and the result of
+  // applying A
+  real_vector_t z = storage::make_real_vector(N * block_size);
+  real_vector_t t1 = storage::make_real_vector(N * block_size);
+  real_vector_t t2 = storage::make_real_vector(N * block_size);
+  real_vector_t w = storage::make_real_vector(N * block_size);
+
+  std::mt19937 gen(params.seed);
+  std::vector<double> probe_moments(std::size_t(n_moments) * params.n_probes);
+  auto is_block = is_block_operator<typename std::decay<A>::type>();
+
+  for(int first = 0; first < params.n_probes; first += block_size) {
+    int const k = std::min(block_size, params.n_probes - first);
+    double* z_ptr = storage::get_data_ptr(z);
+    for(int i = 0; i < N * k; ++i)
+      z_ptr[i] = (gen() & 1) ? 1.0 : -1.0;
+
+    // T_1(B) z = B z, where B = (A - c) / e
+    apply_to_block<Backend>(a, z, w, N, k, is_block);
+    double* t_prev = storage::get_data_ptr(t1);
+    double* t_cur = storage::get_data_ptr(t2);
+    double const* w_ptr = storage::get_data_ptr(w);
+    for(int i = 0; i < N * k; ++i)
+      t_cur[i] = (w_ptr[i] - c * z_ptr[i]) * inv_e;
+
+    // mu_0 = z^T z, mu_1 = z^T T_1(B) z
+    for(int j = 0; j < k; ++j) {
+      double* mu = probe_moments.data() + std::size_t(first + j) * n_moments;
+      double const* zj = z_ptr + std::size_t(j) * N;
+      double const* tj = t_cur + std::size_t(j) * N;
+      mu[0] = mu[1] = 0;
+      for(int i = 0; i < N; ++i) {
+        mu[0] += zj[i] * zj[i];
+        mu[1] += zj[i] * tj[i];
+      }
+    }
+
+    // mu_{2m} = 2 T_m^T T_m - mu_0 and mu_{2m+1} = 2 T_{m+1}^T T_m - mu_1,
+    // where T_{m+1}(B) z = 2 B T_m(B) z - T_{m-1}(B) z is computed in place of
+    // T_{m-1}(B) z.
+    std::copy(z_ptr, z_ptr + N * k, t_prev);
+    bool cur_in_t2 = true;
+    for(int m = 1; 2 * m <= d; ++m) {
+      for(int j = 0; j < k; ++j) {
+        double* mu = probe_moments.data() + std::size_t(first + j) * n_moments;
+        double const* t_m = t_cur + std::size_t(j) * N;
+        double even = 0;
+        for(int i = 0; i < N; ++i)
+          even += t_m[i] * t_m[i];
+        mu[2 * m] = 2 * even - mu[0];
+      }
+      if(2 * m + 1 > d) break;
+
+      apply_to_block<Backend>(a, cur_in_t2 ? t2 : t1, w, N, k, is_block);
+      for(int i = 0; i < N * k; ++i)
+        t_prev[i] = 2 * (w_ptr[i] - c * t_cur[i]) * inv_e - t_prev[i];
+      for(int j = 0; j < k; ++j) {
+        double* mu = probe_moments.data() + std::size_t(first + j) * n_moments;
+        double const* t_next = t_prev + std::size_t(j) * N;
+        double const* t_m = t_cur + std::size_t(j) * N;
+        double odd = 0;
+        for(int i = 0; i < N; ++i)
+          odd += t_next[i] * t_m[i];
+        mu[2 * m + 1] = 2 * odd - mu[1];
+      }
+      std::swap(t_prev, t_cur);
+      cur_in_t2 = !cur_in_t2;
+    }
+  }
+
+  for(double& mu : probe_moments)
+    mu /= N;
+
+  storage::destroy(z);
+  storage::destroy(t1);
+  storage::destroy(t2);
+  storage::destroy(w);
+
+  return spectral_density(N, bounds, params.damping, params.n_probes,
+                          std::move(probe_moments));
+}
+
+/// @brief Estimates the spectral density of a real symmetric linear operator
+/// with the Kernel Polynomial Method.
+///
+/// Bounds of the spectrum are estimated with estimate_spectral_bounds() and
+/// kpm_params::n_lanczos_steps Lanczos steps.
+///
+/// @tparam Backend Storage backend used to allocate the Chebyshev vectors.
+/// @param a Linear operator @f$ \hat A @f$.
+/// @param N Dimension of the operator.
+/// @param params Parameters of the method.
+/// @throws std::runtime_error Invalid dimension or parameters.
+template<typename Backend, typename A>
+spectral_density estimate_spectral_density(
+    A&& a,
+    int N,
+    kpm_params const& params = kpm_params()) {
+  spectral_interval const bounds = estimate_spectral_bounds<Backend>(
+      a, N, params.n_lanczos_steps, params.seed);
+  return estimate_spectral_density<Backend>(a, N, bounds, params);
+}
+
+} // namespace ezarpack
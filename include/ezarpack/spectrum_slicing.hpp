@@ -0,0 +1,502 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/spectrum_slicing.hpp
+/// @brief Driver computing all eigenpairs of a real symmetric eigenproblem
+/// within an interval by spectrum slicing.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "batch_solver.hpp"
+#include "polynomial_filter.hpp"
+
+namespace ezarpack {
+
+/// Part of an interval processed by @ref spectrum_slicer with a single solver
+/// run.
+struct spectral_slice {
+  /// Half-open interval @f$ [a; b) @f$ covered by the slice.
+  spectral_interval interval;
+  /// Expected number of eigenvalues in the slice as given by the eigenvalue
+  /// count function, or -1 if no such function has been set.
+  double n_expected;
+  /// Number of eigenvalues found in the slice.
+  int n_found;
+  /// Number of bisections that have produced the slice from one of
+  /// the initial slices.
+  int level;
+  /// Is the slice believed to contain no eigenvalues other than the found
+  /// ones?
+  bool complete;
+};
+
+/// Parameters of a spectrum slicing run.
+struct slicing_params {
+  /// Number of slices the interval is initially partitioned into.
+  /// A non-positive value stands for the number of threads of the driver.
+  int n_slices = 0;
+  /// Number of eigenvalues requested from a solver run when the eigenvalue
+  /// count function is not set. Otherwise, slices expected to contain more
+  /// eigenvalues than this number are bisected before being processed.
+  int n_eigenvalues = 20;
+  /// Number of eigenvalues requested in excess of the expected number of
+  /// eigenvalues in a slice.
+  int n_extra = 4;
+  /// Maximum number of bisections of an initial slice.
+  int max_level = 8;
+  /// Maximal acceptable difference between the found and the expected
+  /// numbers of eigenvalues in a complete slice. The default value calls for
+  /// exact agreement and suits exact eigenvalue counts, such as inertia of
+  /// a factorized matrix.
+  double count_tolerance = 0.5;
+  /// Eigenvalues found in different slices and differing by less than this
+  /// tolerance times the width of the interval are considered duplicates.
+  double tolerance = 1e-10;
+};
+
+/// Result of a spectrum slicing run.
+struct slicing_result {
+  /// Found eigenvalues in ascending order.
+  std::vector<double> eigenvalues;
+  /// Column-major matrix whose columns are eigenvectors corresponding to
+  /// the found eigenvalues.
+  std::vector<double> eigenvectors;
+  /// Slices in ascending order.
+  std::vector<spectral_slice> slices;
+
+  /// Number of found eigenpairs.
+  int size() const { return int(eigenvalues.size()); }
+
+  /// Are all slices complete?
+  bool complete() const {
+    return std::all_of(slices.begin(), slices.end(),
+                       [](spectral_slice const& s) { return s.complete; });
+  }
+};
+
+/// @brief Driver computing all eigenpairs of a real symmetric eigenproblem
+/// @f$ \hat A\mathbf{x} = \lambda\hat M\mathbf{x} @f$ within an interval
+/// @f$ [a; b) @f$ by spectrum slicing.
+///
+/// The interval is partitioned into slices, and each slice is processed by
+/// an independent run of `arpack_solver<Symmetric, Backend>` performed by
+/// a user-supplied function. The runs are executed by a @ref batch_solver,
+/// so by default, the slices are processed one after another while the
+/// thread pool executes parallel loops of the linear operators. Slices are
+/// processed concurrently only if ARPACK-NG has been declared reentrant with
+/// set_arpack_reentrant(). A run is expected to compute eigenvalues of
+/// a spectrally transformed operator that correspond to the eigenvalues of
+/// @f$ \hat A @f$ closest to the slice, for instance
+///
+/// - the Shift-and-Invert mode with @f$ \sigma @f$ at the center of
+///   the slice (see @ref sparse_shift_invert and @ref iterative_shift_invert),
+/// - the standard mode with a @ref chebyshev_filter whose window is
+///   the slice.
+///
+/// Runs request the eigenvalues of largest magnitude of the transformed
+/// operator. In the Shift-and-Invert mode, these are
+/// @f$ \nu = 1/(\lambda - \sigma) @f$ with @f$ \lambda @f$ nearest to
+/// @f$ \sigma @f$ on either side. A damped Chebyshev filter is close to 1
+/// within the slice and close to 0 elsewhere, so its eigenvalues of largest
+/// magnitude correspond to the slice as well. The eigenvalues of
+/// @f$ \hat A @f$ are computed as Rayleigh quotients of the Ritz vectors.
+///
+/// A slice is bisected and processed anew if it may contain eigenvalues that
+/// have not been found. When an eigenvalue count function is set with
+/// @ref set_count_function(), a slice is complete if the number of found
+/// eigenvalues agrees with the expected one. Otherwise, a slice is complete
+/// if at least one of the computed eigenvalues lies outside it. Slices
+/// expected to contain too many eigenvalues are bisected beforehand.
+///
+/// Eigenvalues close to slice boundaries are found by more than one run.
+/// Groups of such nearly equal eigenvalues, including degenerate ones, are
+/// deduplicated by keeping all eigenpairs of the group found by a single run.
+///
+/// Example:
+/// @code
+/// using slicer_t = spectrum_slicer<eigen_storage>;
+/// slicer_t slicer(N, A);
+/// auto result = slicer({a, b},
+///                      [&](spectral_slice const& slice,
+///                          slicer_t::params_t const& params,
+///                          slicer_t::solver_t& solver) {
+///                        chebyshev_filter<eigen_storage> filter(
+///                            N, A, slice.interval, 100, JacksonDamping,
+///                            bounds);
+///                        solver(filter, params);
+///                      });
+/// @endcode
+///
+/// @note Eigenvectors are stored in `std::vector` containers regardless of
+/// the storage backend. Distributed eigenproblems (`mpi::arpack_solver`) are
+/// not supported.
+///
+/// @tparam Backend Storage backend used by the solver objects.
+template<typename Backend> class spectrum_slicer {
+public:
+  /// Type of the recycled solver objects.
+  using solver_t = arpack_solver<Symmetric, Backend>;
+  /// Parameters of the solver runs.
+  using params_t = typename solver_t::params_t;
+  /// Type of input vector views.
+  using vector_const_view_t = typename solver_t::vector_const_view_t;
+  /// Type of output vector views.
+  using vector_view_t = typename solver_t::vector_view_t;
+  /// Type of the linear operator @f$ \hat A @f$.
+  using operator_type = std::function<void(vector_const_view_t, vector_view_t)>;
+  /// Type of the eigenvalue count function. It is called with a real
+  /// number @f$ x @f$ and returns the (expected) number of eigenvalues
+  /// below @f$ x @f$.
+  using count_function = std::function<double(double)>;
+
+private:
+  using storage = storage_traits<Backend>;
+
+  unsigned int N_;                         // Dimension of the eigenproblem
+  operator_type a_;                        // Operator A
+  count_function count_;                   // Eigenvalue count function
+  batch_solver<Symmetric, Backend> batch_; // Driver of the solver runs
+
+  // Slice waiting to be processed
+  struct work_item {
+    spectral_slice slice;
+    double count_lower; // Number of eigenvalues below the lower end
+    double count_upper; // Number of eigenvalues below the upper end
+  };
+
+  // Output of a solver run
+  struct run_output {
+    std::vector<double> eigenvalues;
+    std::vector<double> eigenvectors;
+    bool exhausted = false; // Has an eigenvalue outside the slice been found?
+  };
+
+public:
+  /// Constructs a spectrum slicing driver.
+  /// @param N Dimension of the eigenproblem.
+  /// @param a Linear operator @f$ \hat A @f$. It must be safe to call from
+  /// concurrent threads if ARPACK-NG has been declared reentrant.
+  /// @param n_threads Number of threads in the pool of the underlying
+  /// @ref batch_solver. A non-positive value stands for
+  /// `std::thread::hardware_concurrency()`.
+  spectrum_slicer(unsigned int N, operator_type a, int n_threads = 0)
+      : N_(N), a_(std::move(a)), batch_(N, n_threads) {}
+
+  spectrum_slicer(spectrum_slicer const&) = delete;
+  spectrum_slicer& operator=(spectrum_slicer const&) = delete;
+
+  /// Dimension of the eigenproblem.
+  unsigned int dim() const { return N_; }
+
+  /// Number of threads in the pool.
+  int n_threads() const { return batch_.n_threads(); }
+
+  /// Sets the function counting eigenvalues below a given number. It is used
+  /// to choose the number of eigenvalues requested from each solver run and
+  /// to verify completeness of the found eigenvalues.
+  ///
+  /// The count can be exact (e.g. inertia of a factorized shifted matrix, see
+  /// `sparse_shift_invert<Symmetric>::n_eigenvalues_below_sigma()`), or
+  /// a stochastic estimate with a suitably increased
+  /// slicing_params::count_tolerance. The function is called from the thread
+  /// calling @ref operator()().
+  /// @param count Eigenvalue count function, or `nullptr` to unset it.
+  void set_count_function(count_function count) { count_ = std::move(count); }
+
+  /// @brief Computes eigenpairs within an interval.
+  ///
+  /// For each slice, `solve_f(slice, params, solver)` is called with
+  /// a recycled solver object. It is expected to run the solver with
+  /// the given parameters. The number of requested eigenvalues is chosen by
+  /// the driver, eigenvalues of largest magnitude are requested, eigenvectors
+  /// are always computed, and params_t::sigma is set to the center of
+  /// the slice. Other parameters may be adjusted in a copy of `params`.
+  ///
+  /// The calls for different slices are made one after another unless
+  /// ARPACK-NG has been declared reentrant, see set_arpack_reentrant().
+  ///
+  /// If some of the calls throw, the first caught exception is rethrown after
+  /// all other slices of the same bisection round have been processed.
+  ///
+  /// @param interval Interval @f$ [a; b) @f$.
+  /// @param solve_f Callable object with signature
+  /// `void(spectral_slice const& slice, params_t const& params,
+  /// solver_t & solver)`.
+  /// @param params Parameters of the slicing run.
+  /// @throws std::runtime_error Invalid interval or parameters.
+  template<typename SolveF>
+  slicing_result operator()(spectral_interval interval,
+                            SolveF&& solve_f,
+                            slicing_params const& params = slicing_params()) {
+    if(!(interval.lower < interval.upper))
+      throw std::runtime_error("spectrum_slicer: The interval must not be "
+                               "empty");
+    if(params.n_eigenvalues < 1 || params.n_extra < 0 || params.max_level < 0)
+      throw std::runtime_error("spectrum_slicer: Invalid slicing parameters");
+
+    double const tol = params.tolerance * (interval.upper - interval.lower);
+
+    // Initial partition
+    int const n_slices =
+        params.n_slices > 0 ? params.n_slices : batch_.n_threads();
+    std::vector<double> ends(n_slices + 1), counts(n_slices + 1, 0);
+    for(int i = 0; i < n_slices; ++i)
+      ends[i] = interval.lower +
+                (interval.upper - interval.lower) * double(i) / n_slices;
+    ends[n_slices] = interval.upper;
+    if(count_) std::transform(ends.begin(), ends.end(), counts.begin(), count_);
+    std::vector<work_item> pending;
+    for(int i = 0; i < n_slices; ++i)
+      pending.push_back(
+          make_item({ends[i], ends[i + 1]}, counts[i], counts[i + 1], 0));
+
+    // Bisect slices expected to contain too many eigenvalues
+    if(count_) {
+      std::vector<work_item> items;
+      while(!pending.empty()) {
+        work_item item = pending.back();
+        pending.pop_back();
+        if(item.slice.n_expected > params.n_eigenvalues &&
+           item.slice.level < params.max_level)
+          bisect(item, pending);
+        else
+          items.push_back(item);
+      }
+      pending.swap(items);
+    }
+
+    // Process slices, bisecting incomplete ones
+    std::vector<work_item> done;
+    std::vector<run_output> outputs;
+    while(!pending.empty()) {
+      std::vector<run_output> round_outputs(pending.size());
+      batch_(
+          int(pending.size()),
+          [&](int i, solver_t& solver) {
+            run(pending[i], solve_f, params, tol, solver, round_outputs[i]);
+          },
+          [](int, solver_t const&) {});
+
+      std::vector<work_item> next;
+      for(std::size_t i = 0; i < pending.size(); ++i) {
+        work_item& item = pending[i];
+        run_output& output = round_outputs[i];
+        item.slice.complete =
+            count_ ? agrees(item.slice.interval, item.slice.n_expected,
+                            output.eigenvalues, tol, params.count_tolerance)
+                   : output.exhausted;
+        if(!item.slice.complete && item.slice.level < params.max_level) {
+          bisect(item, next);
+        } else {
+          done.push_back(item);
+          outputs.push_back(std::move(output));
+        }
+      }
+      pending.swap(next);
+    }
+
+    return merge(interval, tol, params, done, outputs);
+  }
+
+private:
+  /// @internal Make a work item for a slice.
+  work_item make_item(spectral_interval interval,
+                      double count_lower,
+                      double count_upper,
+                      int level) const {
+    work_item item;
+    item.slice.interval = interval;
+    item.slice.n_expected = count_ ? count_upper - count_lower : -1;
+    item.slice.n_found = 0;
+    item.slice.level = level;
+    item.slice.complete = false;
+    item.count_lower = count_lower;
+    item.count_upper = count_upper;
+    return item;
+  }
+
+  /// @internal Bisect a slice and append the halves to a list.
+  void bisect(work_item const& item, std::vector<work_item>& items) const {
+    spectral_interval const& i = item.slice.interval;
+    double const middle = (i.lower + i.upper) / 2;
+    double const count_middle = count_ ? count_(middle) : 0;
+    int const level = item.slice.level + 1;
+    items.push_back(
+        make_item({i.lower, middle}, item.count_lower, count_middle, level));
+    items.push_back(
+        make_item({middle, i.upper}, count_middle, item.count_upper, level));
+  }
+
+  /// @internal Number of eigenvalues to be requested for a slice.
+  int n_eigenvalues(work_item const& item, slicing_params const& params) const {
+    int nev = params.n_eigenvalues;
+    if(count_)
+      nev = int(std::ceil(item.slice.n_expected + params.count_tolerance)) +
+            params.n_extra;
+    return std::max(1, std::min(nev, int(N_) - 1));
+  }
+
+  /// @internal Process a slice with a solver run.
+  template<typename SolveF>
+  void run(work_item const& item,
+           SolveF& solve_f,
+           slicing_params const& params,
+           double tol,
+           solver_t& solver,
+           run_output& output) const {
+    // Slices expected to be empty are skipped
+    if(count_ && item.slice.n_expected <= params.count_tolerance) {
+      output.exhausted = true;
+      return;
+    }
+
+    int const nev = n_eigenvalues(item, params);
+    params_t run_params(nev, params_t::LargestMagnitude, true);
+    spectral_interval const& i = item.slice.interval;
+    run_params.sigma = (i.lower + i.upper) / 2;
+
+    std::vector<double> z(std::size_t(N_) * nev);
+    solver.set_eigenvectors_buffer(z.data(), nev);
+    try {
+      solve_f(static_cast<spectral_slice const&>(item.slice),
+              static_cast<params_t const&>(run_params), solver);
+      collect(item, solver, z, tol, output);
+    } catch(...) {
+      solver.reset_eigenvectors_buffer();
+      throw;
+    }
+    solver.reset_eigenvectors_buffer();
+  }
+
+  /// @internal Collect eigenpairs computed by a solver run within a slice
+  /// widened by a tolerance.
+  void collect(work_item const& item,
+               solver_t const& solver,
+               std::vector<double> const& z,
+               double tol,
+               run_output& output) const {
+    spectral_interval const& i = item.slice.interval;
+    auto lambda = solver.eigenvalues(a_);
+    double const* lambda_ptr = storage::get_data_ptr(lambda);
+    for(int n = 0; n < int(solver.nconv()); ++n) {
+      double const l = lambda_ptr[n];
+      if(l < i.lower - tol || l >= i.upper + tol) {
+        output.exhausted = true;
+        continue;
+      }
+      output.eigenvalues.push_back(l);
+      output.eigenvectors.insert(output.eigenvectors.end(),
+                                 z.begin() + std::ptrdiff_t(n) * N_,
+                                 z.begin() + std::ptrdiff_t(n + 1) * N_);
+    }
+    storage::destroy(lambda);
+  }
+
+  /// @internal Does the number of eigenvalues found in a slice agree with
+  /// the expected one? Eigenvalues closer to the ends of the slice than
+  /// the tolerance may be counted on either side.
+  static bool agrees(spectral_interval const& i,
+                     double n_expected,
+                     std::vector<double> const& eigenvalues,
+                     double tol,
+                     double count_tolerance) {
+    int n_inner = 0, n_outer = 0;
+    for(double l : eigenvalues) {
+      if(l >= i.lower + tol && l < i.upper - tol) ++n_inner;
+      if(l >= i.lower - tol && l < i.upper + tol) ++n_outer;
+    }
+    return n_inner - count_tolerance <= n_expected &&
+           n_expected <= n_outer + count_tolerance;
+  }
+
+  /// @internal Deduplicate eigenpairs found in all slices and collect them.
+  slicing_result merge(spectral_interval interval,
+                       double tol,
+                       slicing_params const& params,
+                       std::vector<work_item> const& items,
+                       std::vector<run_output> const& outputs) const {
+    // Eigenvalues as (value, (run, column)) pairs
+    using entry = std::pair<double, std::pair<int, int>>;
+    std::vector<entry> entries;
+    for(std::size_t r = 0; r < outputs.size(); ++r) {
+      for(std::size_t n = 0; n < outputs[r].eigenvalues.size(); ++n)
+        entries.push_back({outputs[r].eigenvalues[n], {int(r), int(n)}});
+    }
+    std::sort(entries.begin(), entries.end());
+
+    // Within each group of nearly equal eigenvalues, keep the entries coming
+    // from the run that has contributed most of them
+    std::vector<entry> kept;
+    std::vector<int> n_contributed(outputs.size(), 0);
+    for(std::size_t first = 0; first < entries.size();) {
+      std::size_t last = first + 1;
+      while(last < entries.size() &&
+            entries[last].first - entries[last - 1].first <= tol)
+        ++last;
+      int best_run = -1;
+      for(std::size_t e = first; e < last; ++e) {
+        int const r = entries[e].second.first;
+        ++n_contributed[r];
+        if(best_run == -1 || n_contributed[r] > n_contributed[best_run] ||
+           (n_contributed[r] == n_contributed[best_run] && r < best_run))
+          best_run = r;
+      }
+      for(std::size_t e = first; e < last; ++e) {
+        n_contributed[entries[e].second.first] = 0;
+        double const l = entries[e].first;
+        if(entries[e].second.first == best_run && l >= interval.lower &&
+           l < interval.upper)
+          kept.push_back(entries[e]);
+      }
+      first = last;
+    }
+
+    slicing_result result;
+    result.eigenvalues.reserve(kept.size());
+    result.eigenvectors.reserve(kept.size() * N_);
+    for(entry const& e : kept) {
+      result.eigenvalues.push_back(e.first);
+      auto z = outputs[e.second.first].eigenvectors.begin() +
+               std::ptrdiff_t(e.second.second) * N_;
+      result.eigenvectors.insert(result.eigenvectors.end(), z, z + N_);
+    }
+
+    for(work_item const& item : items) {
+      spectral_slice slice = item.slice;
+      spectral_interval const& i = slice.interval;
+      slice.n_found = int(
+          std::lower_bound(result.eigenvalues.begin(), result.eigenvalues.end(),
+                           i.upper) -
+          std::lower_bound(result.eigenvalues.begin(), result.eigenvalues.end(),
+                           i.lower));
+      if(count_)
+        slice.complete = agrees(i, slice.n_expected, result.eigenvalues, tol,
+                                params.count_tolerance);
+      result.slices.push_back(slice);
+    }
+    std::sort(result.slices.begin(), result.slices.end(),
+              [](spectral_slice const& s1, spectral_slice const& s2) {
+                return s1.interval.lower < s2.interval.lower;
+              });
+
+    return result;
+  }
+};
+
+} // namespace ezarpack
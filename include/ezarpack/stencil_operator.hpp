@@ -0,0 +1,239 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/stencil_operator.hpp
+/// @brief Matrix-free linear operators defined by finite-difference stencils
+/// on structured grids.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "view_data.hpp"
+
+namespace ezarpack {
+
+/// A point of a finite-difference stencil, i.e. a displacement on the grid.
+struct stencil_point {
+  /// Displacement along the first (fastest varying) grid dimension.
+  int dx = 0;
+  /// Displacement along the second grid dimension.
+  int dy = 0;
+  /// Displacement along the third (slowest varying) grid dimension.
+  int dz = 0;
+
+  /// Constructs a stencil point.
+  /// @param dx Displacement along the first grid dimension.
+  /// @param dy Displacement along the second grid dimension.
+  /// @param dz Displacement along the third grid dimension.
+  stencil_point(int dx = 0, int dy = 0, int dz = 0) : dx(dx), dy(dy), dz(dz) {}
+};
+
+/// @brief Matrix-free linear operator defined by a finite-difference stencil
+/// on a 1D, 2D or 3D structured grid.
+///
+/// A grid of shape @f$ n_x \times n_y \times n_z @f$ (with
+/// @f$ n_y = n_z = 1 @f$ for 1D grids and @f$ n_z = 1 @f$ for 2D grids) is
+/// mapped onto vectors of dimension @f$ N = n_x n_y n_z @f$ with the first grid
+/// index varying fastest, @f$ i = i_x + n_x (i_y + n_y i_z) @f$. The operator
+/// acts as
+/// @f[
+///   y_{\mathbf{r}} = \sum_p c_p(\mathbf{r}) x_{\mathbf{r} + \mathbf{d}_p},
+/// @f]
+/// where @f$ \mathbf{d}_p @f$ are the stencil points and @f$ c_p @f$ are either
+/// constant or site-dependent coefficients. Terms with
+/// @f$ \mathbf{r} + \mathbf{d}_p @f$ outside the grid are dropped (zero
+/// Dirichlet boundary conditions).
+///
+/// Grid lines along the first dimension are distributed among threads with
+/// parallel_for(), and the contribution of each stencil point to a line is
+/// computed in a unit-stride loop that is vectorized by the compiler
+/// (explicitly so when OpenMP is enabled).
+///
+/// Objects of this class can be passed as linear operators to
+/// `arpack_solver::operator()` for all kinds of eigenproblems. Method
+/// @ref apply_rows() computes a range of components of the product. It serves
+/// as the local kernel in mpi::halo_operator, which makes the operator usable
+/// with `mpi::arpack_solver`.
+///
+/// @tparam T Type of stencil coefficients, `double` or `std::complex<double>`.
+template<typename T> class stencil_operator {
+
+  std::array<int, 3> shape_;          // Shape of the grid
+  int n_;                             // Number of grid sites
+  std::vector<stencil_point> points_; // Stencil points
+  std::vector<int> offsets_;          // Offsets of stencil points in vectors
+  std::vector<T> coeffs_;             // Stencil coefficients
+  bool variable_;                     // Are the coefficients site-dependent?
+  int lower_bandwidth_ = 0;           // Largest negative offset
+  int upper_bandwidth_ = 0;           // Largest positive offset
+
+  // Approximate number of grid sites processed by one task
+  static constexpr int block_sites = 1 << 12;
+
+public:
+  /// Constructs a stencil operator.
+  ///
+  /// @param shape Shape of the grid @f$ (n_x, n_y, n_z) @f$.
+  /// @param points Stencil points @f$ \mathbf{d}_p @f$.
+  /// @param coeffs Stencil coefficients. For constant coefficients, this is
+  /// an array of size `points.size()`. For site-dependent coefficients, it is
+  /// an array of size `points.size() * N`, where @f$ c_p(\mathbf{r}) @f$ is
+  /// stored in `coeffs[p * N + i]`, `i` being the linear index of
+  /// @f$ \mathbf{r} @f$.
+  /// @throws std::runtime_error Invalid grid shape or inconsistent sizes of
+  /// `points` and `coeffs`.
+  stencil_operator(std::array<int, 3> const& shape,
+                   std::vector<stencil_point> points,
+                   std::vector<T> coeffs)
+      : shape_(shape),
+        n_(shape[0] * shape[1] * shape[2]),
+        points_(std::move(points)),
+        coeffs_(std::move(coeffs)),
+        variable_(false) {
+    if(shape_[0] < 1 || shape_[1] < 1 || shape_[2] < 1)
+      throw std::runtime_error("stencil_operator: Grid dimensions must be "
+                               "positive");
+    if(coeffs_.size() == points_.size())
+      variable_ = false;
+    else if(coeffs_.size() == points_.size() * std::size_t(n_))
+      variable_ = true;
+    else
+      throw std::runtime_error("stencil_operator: coeffs must be of size " +
+                               std::to_string(points_.size()) + " or " +
+                               std::to_string(points_.size() * n_));
+    for(auto const& p : points_) {
+      int offset = p.dx + shape_[0] * (p.dy + shape_[1] * p.dz);
+      offsets_.push_back(offset);
+      lower_bandwidth_ = std::max(lower_bandwidth_, -offset);
+      upper_bandwidth_ = std::max(upper_bandwidth_, offset);
+    }
+  }
+
+  /// Dimension of the operator (number of grid sites).
+  int dim() const { return n_; }
+
+  /// Shape of the grid.
+  std::array<int, 3> const& shape() const { return shape_; }
+
+  /// Stencil points.
+  std::vector<stencil_point> const& points() const { return points_; }
+
+  /// Are the stencil coefficients site-dependent?
+  bool variable_coefficients() const { return variable_; }
+
+  /// Largest distance between components @f$ y_i @f$ and @f$ x_j @f$,
+  /// @f$ j < i @f$, coupled by the stencil.
+  int lower_bandwidth() const { return lower_bandwidth_; }
+
+  /// Largest distance between components @f$ y_i @f$ and @f$ x_j @f$,
+  /// @f$ j > i @f$, coupled by the stencil.
+  int upper_bandwidth() const { return upper_bandwidth_; }
+
+  /// Computes the product @f$ \mathbf{y} = \hat A \mathbf{x} @f$ for vectors
+  /// stored in plain arrays.
+  ///
+  /// @param x Input array of length @ref dim().
+  /// @param y Output array of length @ref dim().
+  template<typename X, typename Y> void apply(X const* x, Y* y) const {
+    apply_rows(x, y, 0, n_);
+  }
+
+  /// Computes components `[row_begin; row_end)` of the product
+  /// @f$ \mathbf{y} = \hat A \mathbf{x} @f$.
+  ///
+  /// @param x Pointer to the component @f$ x_\mathrm{row\_begin} @f$.
+  /// Components @f$ x_j @f$ with `j` in
+  /// `[max(0, row_begin - lower_bandwidth()); min(dim(), row_end +
+  /// upper_bandwidth()))` must be accessible as `x[j - row_begin]`.
+  /// @param y Output array of length `row_end - row_begin`.
+  /// @param row_begin First computed component.
+  /// @param row_end Past-the-end computed component.
+  template<typename X, typename Y>
+  void apply_rows(X const* x, Y* y, int row_begin, int row_end) const {
+    if(row_end <= row_begin) return;
+
+    int const nx = shape_[0];
+    int const line_begin = row_begin / nx;
+    int const line_end = (row_end + nx - 1) / nx;
+    int const lines_per_task = std::max(1, block_sites / nx);
+    int const n_tasks =
+        (line_end - line_begin + lines_per_task - 1) / lines_per_task;
+
+    parallel_for(n_tasks, [&](int t) {
+      int const l_begin = line_begin + t * lines_per_task;
+      int const l_end = std::min(l_begin + lines_per_task, line_end);
+      for(int l = l_begin; l < l_end; ++l)
+        apply_line(x, y, row_begin, row_end, l);
+    });
+  }
+
+  /// Applies the linear operator to a vector.
+  /// @param in View of the input vector.
+  /// @param out View of the output vector.
+  template<typename In, typename Out>
+  void operator()(In&& in, Out&& out) const {
+    apply(view_data(in), view_data(out));
+  }
+
+private:
+  /// @internal Compute components of the product within one grid line along
+  /// the first dimension.
+  template<typename X, typename Y>
+  void apply_line(X const* x, Y* y, int row_begin, int row_end, int l) const {
+    int const nx = shape_[0], ny = shape_[1], nz = shape_[2];
+    int const iy = l % ny, iz = l / ny;
+    int const line_start = l * nx;
+    int const ix_begin = std::max(0, row_begin - line_start);
+    int const ix_end = std::min(nx, row_end - line_start);
+
+    Y* yl = y + (line_start + ix_begin - row_begin);
+    std::fill(yl, yl + (ix_end - ix_begin), Y(0));
+
+    for(std::size_t p = 0; p < points_.size(); ++p) {
+      stencil_point const& pt = points_[p];
+      if(iy + pt.dy < 0 || iy + pt.dy >= ny || iz + pt.dz < 0 ||
+         iz + pt.dz >= nz)
+        continue;
+      int const lo = std::max(ix_begin, -pt.dx);
+      int const hi = std::min(ix_end, nx - pt.dx);
+      if(lo >= hi) continue;
+
+      int const i = line_start + lo; // Linear index of the first site
+      X const* xp = x + (i + offsets_[p] - row_begin);
+      Y* yp = y + (i - row_begin);
+      if(variable_) {
+        T const* c = coeffs_.data() + p * n_ + i;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+        for(int k = 0; k < hi - lo; ++k)
+          yp[k] += c[k] * xp[k];
+      } else {
+        T const c = coeffs_[p];
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+        for(int k = 0; k < hi - lo; ++k)
+          yp[k] += c * xp[k];
+      }
+    }
+  }
+};
+
+} // namespace ezarpack
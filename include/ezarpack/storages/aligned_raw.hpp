@@ -0,0 +1,449 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../ritz_kernels.hpp"
+#include "base.hpp"
+
+namespace ezarpack {
+
+/// Aligned raw memory storage backend tag.
+///
+/// Passing this tag as the second template parameter of
+/// @ref ezarpack::arpack_solver instructs it to use @ref aligned_array as
+/// vector/matrix type, and raw pointers as vector view types. All data arrays
+/// are aligned to a cache line boundary, and columns of matrices are padded
+/// to a multiple of the cache line size.
+struct aligned_raw_storage {};
+
+/// Container owning a cache line aligned one-dimensional (vector) or
+/// two-dimensional (column-major matrix) array.
+///
+/// Columns of a matrix are padded so that each of them starts at a cache line
+/// boundary. The distance between beginnings of two consecutive columns is
+/// returned by @ref col_spacing(). Elements of a vector are stored
+/// contiguously without padding.
+///
+/// @tparam T Element type.
+template<typename T> class aligned_array {
+
+  void* buffer = nullptr; // Memory block returned by std::malloc()
+  T* data_ = nullptr;     // Aligned pointer to the first element
+  int rows_ = 0;          // Number of rows (size of a vector)
+  int cols_ = 0;          // Number of columns (1 for a vector)
+  int col_spacing_ = 0;   // Distance between beginnings of two columns
+
+  void allocate(std::size_t size) {
+    if(size == 0) return;
+    buffer = std::malloc(size * sizeof(T) + alignment() - 1);
+    if(buffer == nullptr) throw std::bad_alloc();
+    auto addr = reinterpret_cast<std::uintptr_t>(buffer);
+    addr = (addr + alignment() - 1) & ~std::uintptr_t(alignment() - 1);
+    data_ = reinterpret_cast<T*>(addr);
+    if(!std::is_trivially_default_constructible<T>::value) {
+      for(std::size_t n = 0; n < size; ++n)
+        new(data_ + n) T();
+    }
+  }
+
+  void release() {
+    std::free(buffer);
+    buffer = nullptr;
+    data_ = nullptr;
+  }
+
+public:
+  /// Alignment of data arrays (size of a cache line) in bytes.
+  static constexpr std::size_t alignment() { return 64; }
+
+  /// Matrix columns are padded to a multiple of this number of elements.
+  static constexpr int col_alignment() {
+    return alignment() % sizeof(T) == 0 ? int(alignment() / sizeof(T)) : 1;
+  }
+
+  /// Constructs an empty array.
+  aligned_array() = default;
+
+  /// Constructs a vector.
+  /// @param size Size of the vector.
+  explicit aligned_array(int size)
+      : rows_(size), cols_(1), col_spacing_(size) {
+    allocate(std::size_t(size));
+  }
+
+  /// Constructs a column-major matrix with padded columns.
+  /// @param rows Number of matrix rows.
+  /// @param cols Number of matrix columns.
+  aligned_array(int rows, int cols)
+      : rows_(rows),
+        cols_(cols),
+        col_spacing_((rows + col_alignment() - 1) / col_alignment() *
+                     col_alignment()) {
+    allocate(std::size_t(col_spacing_) * std::size_t(cols));
+  }
+
+  aligned_array(aligned_array const&) = delete;
+  aligned_array& operator=(aligned_array const&) = delete;
+
+  aligned_array(aligned_array&& other) noexcept { swap(other); }
+  aligned_array& operator=(aligned_array&& other) noexcept {
+    release();
+    swap(other);
+    return *this;
+  }
+
+  ~aligned_array() { release(); }
+
+  /// Swaps contents of two arrays.
+  void swap(aligned_array& other) noexcept {
+    std::swap(buffer, other.buffer);
+    std::swap(data_, other.data_);
+    std::swap(rows_, other.rows_);
+    std::swap(cols_, other.cols_);
+    std::swap(col_spacing_, other.col_spacing_);
+  }
+
+  /// Pointer to the first element.
+  T* data() { return data_; }
+  /// Constant pointer to the first element.
+  T const* data() const { return data_; }
+
+  /// Number of rows (size of a vector).
+  int rows() const { return rows_; }
+  /// Number of columns (1 for a vector).
+  int cols() const { return cols_; }
+  /// Distance between beginnings of two consecutive columns.
+  int col_spacing() const { return col_spacing_; }
+
+  /// Access a vector element.
+  T& operator[](int i) { return data_[i]; }
+  /// Access a vector element (constant version).
+  T const& operator[](int i) const { return data_[i]; }
+
+  /// Access a matrix element.
+  T& operator()(int i, int j) { return data_[i + j * col_spacing_]; }
+  /// Access a matrix element (constant version).
+  T const& operator()(int i, int j) const {
+    return data_[i + j * col_spacing_];
+  }
+};
+
+/// Constant view of a column-major matrix with (possibly) padded columns.
+///
+/// @tparam T Element type.
+template<typename T> class aligned_matrix_const_view {
+
+  T const* data_;   // Pointer to the first element
+  int rows_;        // Number of rows
+  int cols_;        // Number of columns
+  int col_spacing_; // Distance between beginnings of two columns
+
+public:
+  /// Constructs a view.
+  /// @param data Pointer to the first element.
+  /// @param rows Number of rows.
+  /// @param cols Number of columns.
+  /// @param col_spacing Distance between beginnings of two consecutive
+  /// columns.
+  aligned_matrix_const_view(T const* data, int rows, int cols, int col_spacing)
+      : data_(data), rows_(rows), cols_(cols), col_spacing_(col_spacing) {}
+
+  /// Constant pointer to the first element.
+  T const* data() const { return data_; }
+
+  /// Number of rows.
+  int rows() const { return rows_; }
+  /// Number of columns.
+  int cols() const { return cols_; }
+  /// Distance between beginnings of two consecutive columns.
+  int col_spacing() const { return col_spacing_; }
+
+  /// Constant pointer to the first element of a column.
+  /// @param j Column index.
+  T const* col(int j) const { return data_ + j * col_spacing_; }
+
+  /// Access a matrix element.
+  T const& operator()(int i, int j) const {
+    return data_[i + j * col_spacing_];
+  }
+};
+
+/// Traits of the aligned raw memory storage backend.
+///
+/// Member typedefs of this structure describe types of objects that will be
+/// used by arpack_solver to store numerical arrays and expose their partial
+/// views. Structure's static member functions are called to control arrays'
+/// lifetime, create the partial views, and perform some data post-processing
+/// operations.
+///
+/// All containers are aligned to aligned_array::alignment() bytes. The same
+/// holds for the vector views passed to callable objects representing linear
+/// operators, as long as the size of the vectors (dimension of
+/// the eigenproblem or size of the local MPI block) is a multiple of
+/// aligned_array::col_alignment(). The views can then be safely loaded with
+/// aligned SIMD instructions.
+template<> struct storage_traits<aligned_raw_storage> {
+private:
+  // Implementation details
+
+  using dcomplex = std::complex<double>;
+
+public:
+  /// @name Vector and matrix storage types
+  /// @{
+
+  /// @brief One-dimensional container owning an aligned contiguous array of
+  /// `double`.
+  using real_vector_type = aligned_array<double>;
+  /// @brief One-dimensional container owning an aligned contiguous array of
+  /// `std::complex<double>`.
+  using complex_vector_type = aligned_array<dcomplex>;
+  /// @brief One-dimensional container owning an aligned contiguous array of
+  /// `int`.
+  using int_vector_type = aligned_array<int>;
+
+  /// @brief Two-dimensional container owning an aligned array of `double`.
+  /// The storage order is column-major, columns are padded.
+  using real_matrix_type = aligned_array<double>;
+  /// @brief Two-dimensional container owning an aligned array of
+  /// `std::complex<double>`. The storage order is column-major, columns are
+  /// padded.
+  using complex_matrix_type = aligned_array<dcomplex>;
+
+  /// @}
+
+  /// @name View types
+  /// @{
+
+  /// Contiguous partial view of a real vector (subvector).
+  using real_vector_view_type = double*;
+  /// Contiguous partial constant view of a real vector (subvector).
+  using real_vector_const_view_type = double const*;
+  /// Contiguous partial view of a complex vector (subvector).
+  using complex_vector_view_type = dcomplex*;
+  /// Contiguous partial constant view of a complex vector (subvector).
+  using complex_vector_const_view_type = dcomplex const*;
+
+  /// Partial constant view of a real matrix (matrix block) that
+  /// includes a number of the leftmost columns.
+  using real_matrix_const_view_type = aligned_matrix_const_view<double>;
+  /// Partial constant view of a complex matrix (matrix block) that
+  /// includes a number of the leftmost columns.
+  using complex_matrix_const_view_type = aligned_matrix_const_view<dcomplex>;
+
+  /// @}
+
+  /// @name Functions to create/destroy/resize data containers
+  /// @{
+
+  /// Constructs a real vector container.
+  /// @param size Size of the vector.
+  /// @return Constructed vector.
+  inline static real_vector_type make_real_vector(int size) {
+    return real_vector_type(size);
+  }
+  /// Constructs a complex vector container.
+  /// @param size Size of the vector.
+  /// @return Constructed vector.
+  inline static complex_vector_type make_complex_vector(int size) {
+    return complex_vector_type(size);
+  }
+  /// Constructs an integer vector container.
+  /// @param size Size of the vector.
+  /// @return Constructed vector.
+  inline static int_vector_type make_int_vector(int size) {
+    return int_vector_type(size);
+  }
+  /// Constructs a real matrix container.
+  /// @param rows Number of matrix rows.
+  /// @param cols Number of matrix columns.
+  /// @return Constructed matrix.
+  inline static real_matrix_type make_real_matrix(int rows, int cols) {
+    return real_matrix_type(rows, cols);
+  }
+  /// Constructs a complex matrix container.
+  /// @param rows Number of matrix rows.
+  /// @param cols Number of matrix columns.
+  /// @return Constructed matrix.
+  inline static complex_matrix_type make_complex_matrix(int rows, int cols) {
+    return complex_matrix_type(rows, cols);
+  }
+
+  /// Destroys a vector/matrix container.
+  /// @tparam T Vector/matrix element type.
+  template<typename T> inline static void destroy(aligned_array<T>&) {}
+
+  /// Resizes a vector container.
+  /// @tparam T Vector element type.
+  /// @param v Vector container to resize.
+  /// @param size New vector size.
+  template<typename T>
+  inline static void resize(aligned_array<T>& v, int size) {
+    v = aligned_array<T>(size);
+  }
+  /// Resizes a matrix container.
+  /// @tparam T Matrix element type.
+  /// @param m Matrix container to resize.
+  /// @param rows New number of matrix rows.
+  /// @param cols New number of matrix columns.
+  template<typename T>
+  inline static void resize(aligned_array<T>& m, int rows, int cols) {
+    m = aligned_array<T>(rows, cols);
+  }
+
+  /// @}
+
+  /// @name Access to underlying memory buffers
+  /// @{
+
+  /// Returns a pointer to the underlying data array owned by a vector/matrix.
+  /// @tparam T Vector/matrix element type.
+  /// @param a Vector/matrix to retrieve the data pointer from.
+  /// @return Pointer to the data array.
+  template<typename T> inline static T* get_data_ptr(aligned_array<T>& a) {
+    return a.data();
+  }
+
+  /// Returns the spacing between the beginning of two columns of a matrix.
+  ///
+  /// The spacing is the number of matrix rows rounded up to a multiple of
+  /// aligned_array::col_alignment().
+  /// @tparam T Matrix element type.
+  /// @param m Matrix to retrieve the spacing from.
+  /// @return Column spacing.
+  template<typename T>
+  inline static int get_col_spacing(aligned_array<T> const& m) {
+    return m.col_spacing();
+  }
+
+  /// @}
+
+  /// @name Functions to create vector/matrix views
+  /// @{
+
+  /// Makes a complete view of a vector.
+  /// @tparam T Vector element type.
+  /// @param v Vector container to make a view of.
+  /// @return View of the full vector.
+  template<typename T> inline static T* make_vector_view(aligned_array<T>& v) {
+    return v.data();
+  }
+
+  /// Makes a partial view of a vector.
+  /// @tparam T Vector element type.
+  /// @param v Vector container to make a view of.
+  /// @param start Position of the starting element in the partial view.
+  /// @param size **[ignored]** Number of elements in the partial view.
+  /// @return Subvector view.
+  template<typename T>
+  inline static T* make_vector_view(aligned_array<T>& v, int start, int size) {
+    return v.data() + start;
+  }
+  /// Makes a constant partial view of a vector.
+  /// @tparam T Vector element type.
+  /// @param v Vector container to make a view of.
+  /// @param start Position of the starting element in the partial view.
+  /// @param size **[ignored]** Number of elements in the partial view.
+  /// @return Subvector view.
+  template<typename T>
+  inline static T const*
+  make_vector_const_view(aligned_array<T> const& v, int start, int size) {
+    return v.data() + start;
+  }
+
+  /// Makes a complete view of a matrix.
+  /// @tparam T Matrix element type.
+  /// @param m Matrix container to make a view of.
+  /// @return View of the full matrix.
+  template<typename T>
+  inline static aligned_matrix_const_view<T>
+  make_matrix_const_view(aligned_array<T> const& m) {
+    return {m.data(), m.rows(), m.cols(), m.col_spacing()};
+  }
+
+  /// @brief Makes a constant partial view of a matrix including a number of
+  /// the leftmost columns.
+  /// @tparam T Matrix element type.
+  /// @param m Matrix container to make a view of.
+  /// @param rows Number of matrix rows.
+  /// @param cols Number of the leftmost columns in the resulting view.
+  /// @return Submatrix view.
+  template<typename T>
+  inline static aligned_matrix_const_view<T>
+  make_matrix_const_view(aligned_array<T> const& m, int rows, int cols) {
+    return {m.data(), rows, cols, m.col_spacing()};
+  }
+
+  /// @}
+
+  /// @name Post-processing required to compute eigenvalues/eigenvectors
+  /// @{
+
+  /// @brief Combines real and imaginary parts of eigenvalues computed by
+  /// ezarpack::arpack_solver<Asymmetric, Backend>.
+  ///
+  /// @param dr Real parts of the computed eigenvalues.
+  /// @param di Imaginary parts of the computed eigenvalues.
+  /// @param nconv Number of the converged eigenvalues.
+  /// @return Complex vector of eigenvalues.
+  inline static complex_vector_type
+  make_asymm_eigenvalues(real_vector_type const& dr,
+                         real_vector_type const& di,
+                         int nconv) {
+    complex_vector_type res(nconv);
+    for(int n = 0; n < nconv; ++n) {
+      res[n] = dcomplex(dr[n], di[n]);
+    }
+    return res;
+  }
+
+  /// @brief Extracts `nconv` complex Ritz vectors from ARPACK-NG's internal
+  /// representation. This function is called by
+  /// ezarpack::arpack_solver<Asymmetric, Backend>::eigenvectors() const.
+  ///
+  /// @param z Holds components of the Ritz vectors @f$ \mathbf{x} @f$ as
+  /// a sequence of `nconv` length-`N` chunks. Meaning of each chunk depends on
+  /// the corresponding component of `di`, see below.
+  /// @param di If `di[i]` is zero, then the `i`-th chunk of `z` contains a
+  /// real Ritz vector. Otherwise, `di[i] = -di[i+1] != 0`, in which case
+  /// the `i`-th and `(i+1)`-th chunks of `z` are
+  /// real and imaginary parts of a complex Ritz vector respectively. Every such
+  /// pair corresponds to a complex conjugate pair of Ritz vectors, so that the
+  /// total amount of vectors stored in `z` is exactly `nconv`.
+  /// @param N Dimension of the eigenproblem.
+  /// @param nconv Number of the converged Ritz vectors.
+  /// @return Complex matrix, whose columns are Ritz vectors (eigenvectors).
+  inline static complex_matrix_type
+  make_asymm_eigenvectors(real_vector_type const& z,
+                          real_vector_type const& di,
+                          int N,
+                          int nconv) {
+    complex_matrix_type res = make_complex_matrix(N, nconv);
+    int ld = get_col_spacing(res);
+    asymm_ritz_vectors(z.data(), di.data(), N, nconv, get_data_ptr(res),
+                       ld >= 0 ? ld : N);
+    return res;
+  }
+
+  /// @}
+};
+
+} // namespace ezarpack
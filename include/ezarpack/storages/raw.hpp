@@ -12,10 +12,10 @@
  ******************************************************************************/
 #pragma once
 
-#include <cmath>
 #include <complex>
 #include <memory>
 
+#include "../ritz_kernels.hpp"
 #include "base.hpp"
 
 namespace ezarpack {
@@ -253,65 +253,6 @@ public:
     return res;
   }
 
-  /// @brief Given a linear operator @f$ \hat A @f$, computes `nconv`
-  /// eigenvalues from Ritz vectors @f$ \mathbf{x} @f$ as Rayleigh quotients
-  /// @f$ \frac{\mathbf{x}^\dagger \hat A \mathbf{x}}
-  ///          {\mathbf{x}^\dagger \hat M \mathbf{x}} @f$.
-  /// This function is called by
-  /// ezarpack::arpack_solver<Asymmetric, Backend>::eigenvalues(A &&) const.
-  ///
-  /// @tparam A Type of the callable object representing the linear operator
-  /// @f$ \hat A @f$.
-  /// @param z Holds components of the Ritz vectors @f$ \mathbf{x} @f$ as
-  /// a sequence of `nconv` length-`N` chunks. Meaning of each chunk depends on
-  /// the corresponding component of `di`, see below.
-  /// @param di If `di[i]` is zero, then the `i`-th chunk of `z` contains a
-  /// real Ritz vector. Otherwise, `di[i] = -di[i+1] != 0`, in which case
-  /// the `i`-th and `(i+1)`-th chunks of `z` are
-  /// real and imaginary parts of a complex Ritz vector respectively. Every
-  /// real Ritz vector corresponds to one real eigenvalue, while every
-  /// complex vector gives rise to a complex conjugate pair of eigenvalues.
-  /// @param a Callable object representing @f$ \hat A @f$.
-  /// @param N Dimension of the eigenproblem.
-  /// @param nconv Number of the converged Ritz vectors.
-  /// @return Complex vector of eigenvalues.
-  template<typename A>
-  inline static complex_vector_type
-  make_asymm_eigenvalues(real_vector_type const& z,
-                         real_vector_type const& di,
-                         A&& a,
-                         int N,
-                         int nconv) {
-    complex_vector_type lambda(new dcomplex[nconv]);
-    real_vector_type Ax1(new double[N]), Ax2(new double[N]);
-    auto out1 = make_vector_view(Ax1);
-    auto out2 = make_vector_view(Ax2);
-    auto dot = [&](real_vector_const_view_type v1,
-                   real_vector_const_view_type v2) {
-      double s = 0;
-      for(int i = 0; i < N; ++i)
-        s += v1[i] * v2[i];
-      return s;
-    };
-    for(int i = 0; i < nconv; ++i) {
-      if(di[i] == 0) {
-        auto in1 = make_vector_const_view(z, i * N, N);
-        a(in1, out1);
-        lambda[i] = dot(in1, out1);
-      } else {
-        auto in1 = make_vector_const_view(z, i * N, N);
-        auto in2 = make_vector_const_view(z, (i + 1) * N, N);
-        a(in1, out1);
-        a(in2, out2);
-        lambda[i] = dcomplex(dot(in1, out1) + dot(in2, out2),
-                             dot(in1, out2) - dot(in2, out1));
-        ++i;
-        lambda[i] = std::conj(lambda[i - 1]);
-      }
-    }
-    return lambda;
-  }
-
   /// @brief Extracts `nconv` complex Ritz vectors from ARPACK-NG's internal
   /// representation. This function is called by
   /// ezarpack::arpack_solver<Asymmetric, Backend>::eigenvectors() const.
@@ -333,25 +274,10 @@ public:
                           real_vector_type const& di,
                           int N,
                           int nconv) {
-    complex_matrix_type res(new dcomplex[N * nconv]);
-    dcomplex I(0, 1);
-    for(int i = 0; i < nconv; ++i) {
-      if(di[i] == 0) {
-        for(int n = 0; n < N; ++n)
-          res[n + N * i] = z[n + N * i];
-      } else {
-        for(int n = 0; n < N; ++n) {
-          res[n + N * i] =
-              z[n + N * i] + I * std::copysign(1.0, di[i]) * z[n + N * (i + 1)];
-        }
-        if(i < nconv - 1) {
-          for(int n = 0; n < N; ++n) {
-            res[n + N * (i + 1)] = std::conj(res[n + N * i]);
-          }
-          ++i;
-        }
-      }
-    }
+    complex_matrix_type res = make_complex_matrix(N, nconv);
+    int ld = get_col_spacing(res);
+    asymm_ritz_vectors(z.get(), di.get(), N, nconv, get_data_ptr(res),
+                       ld >= 0 ? ld : N);
     return res;
   }
 
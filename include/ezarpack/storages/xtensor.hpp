@@ -20,6 +20,7 @@
 #include <xtensor/xtensor.hpp>
 #include <xtensor/xview.hpp>
 
+#include "../ritz_kernels.hpp"
 #include "base.hpp"
 
 namespace ezarpack {
@@ -303,60 +304,6 @@ public:
     return xt::view(dr, r) + dcomplex(0, 1) * xt::view(di, r);
   }
 
-  /// @brief Given a linear operator @f$ \hat A @f$, computes `nconv`
-  /// eigenvalues from Ritz vectors @f$ \mathbf{x} @f$ as Rayleigh quotients
-  /// @f$ \frac{\mathbf{x}^\dagger \hat A \mathbf{x}}
-  ///          {\mathbf{x}^\dagger \hat M \mathbf{x}} @f$.
-  /// This function is called by
-  /// ezarpack::arpack_solver<Asymmetric, Backend>::eigenvalues(A &&) const.
-  ///
-  /// @tparam A Type of the callable object representing the linear operator
-  /// @f$ \hat A @f$.
-  /// @param z Holds components of the Ritz vectors @f$ \mathbf{x} @f$ as
-  /// a sequence of `nconv` length-`N` chunks. Meaning of each chunk depends on
-  /// the corresponding component of `di`, see below.
-  /// @param di If `di[i]` is zero, then the `i`-th chunk of `z` contains a
-  /// real Ritz vector. Otherwise, `di[i] = -di[i+1] != 0`, in which case
-  /// the `i`-th and `(i+1)`-th chunks of `z` are
-  /// real and imaginary parts of a complex Ritz vector respectively. Every
-  /// real Ritz vector corresponds to one real eigenvalue, while every
-  /// complex vector gives rise to a complex conjugate pair of eigenvalues.
-  /// @param a Callable object representing @f$ \hat A @f$.
-  /// @param N Dimension of the eigenproblem.
-  /// @param nconv Number of the converged Ritz vectors.
-  /// @return Complex vector of eigenvalues.
-  template<typename A>
-  inline static complex_vector_type
-  make_asymm_eigenvalues(real_vector_type const& z,
-                         real_vector_type const& di,
-                         A&& a,
-                         int N,
-                         int nconv) {
-    auto lambda = complex_vector_type::from_shape({size_t(nconv)});
-    auto Ax1 = real_vector_type::from_shape({size_t(N)});
-    auto Ax2 = real_vector_type::from_shape({size_t(N)});
-    auto out1 = make_vector_view(Ax1);
-    auto out2 = make_vector_view(Ax2);
-    using xt::linalg::dot;
-    for(int i = 0; i < nconv; ++i) {
-      if(di(i) == 0) {
-        auto in1 = make_vector_const_view(z, i * N, N);
-        a(in1, out1);
-        lambda(i) = dot(in1, out1)[0];
-      } else {
-        auto in1 = make_vector_const_view(z, i * N, N);
-        auto in2 = make_vector_const_view(z, (i + 1) * N, N);
-        a(in1, out1);
-        a(in2, out2);
-        lambda(i) = dcomplex(dot(in1, out1)[0] + dot(in2, out2)[0],
-                             dot(in1, out2)[0] - dot(in2, out1)[0]);
-        ++i;
-        lambda(i) = std::conj(lambda(i - 1));
-      }
-    }
-    return lambda;
-  }
-
   /// @brief Extracts `nconv` complex Ritz vectors from ARPACK-NG's internal
   /// representation. This function is called by
   /// ezarpack::arpack_solver<Asymmetric, Backend>::eigenvectors() const.
@@ -378,24 +325,10 @@ public:
                           real_vector_type const& di,
                           int N,
                           int nconv) {
-    auto res = complex_matrix_type::from_shape({size_t(N), size_t(nconv)});
-    dcomplex I(0, 1);
-    for(int i = 0; i < nconv; ++i) {
-      if(di(i) == 0) {
-        xt::view(res, xt::all(), i) =
-            xt::view(z, xt::range(i * N, (i + 1) * N));
-      } else {
-        xt::view(res, xt::all(), i) =
-            xt::view(z, xt::range(i * N, (i + 1) * N)) +
-            I * std::copysign(1.0, di(i)) *
-                xt::view(z, xt::range((i + 1) * N, (i + 2) * N));
-        if(i < nconv - 1) {
-          xt::view(res, xt::all(), i + 1) =
-              xt::conj(xt::view(res, xt::all(), i));
-          ++i;
-        }
-      }
-    }
+    complex_matrix_type res = make_complex_matrix(N, nconv);
+    int ld = get_col_spacing(res);
+    asymm_ritz_vectors(z.data(), di.data(), N, nconv, get_data_ptr(res),
+                       ld >= 0 ? ld : N);
     return res;
   }
 
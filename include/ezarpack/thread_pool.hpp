@@ -0,0 +1,262 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/thread_pool.hpp
+/// @brief Persistent pool of worker threads executing parallel loops.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ezarpack {
+
+/// @brief Persistent pool of worker threads that execute parallel loops.
+///
+/// Worker threads are started once by the constructor and live as long as the
+/// pool object. Between loops, the workers spin-wait for new work for a while
+/// and then fall asleep. Compared to forking and joining an OpenMP team in
+/// every call to a parallel linear operator, this reduces the latency of short
+/// loops executed many times in a row, such as matrix-vector products with
+/// small matrices requested by ARPACK-NG at each Arnoldi/Lanczos step.
+///
+/// A pool is normally not used directly. It is passed to
+/// `arpack_solver::set_executor()` or installed with a @ref parallel_context,
+/// and parallel_for() then executes loops on it.
+class thread_pool {
+
+  std::vector<std::thread> workers_; // Worker threads
+  int spin_count_;                   // Number of spin-wait iterations
+
+  // Current loop
+  void (*job_)(void*, int) = nullptr; // Type-erased loop body
+  void* job_data_ = nullptr;          // Callable object of the loop body
+  int job_size_ = 0;                  // Number of iterations
+  std::atomic<int> next_index_;       // Next unclaimed iteration
+  std::atomic<int> busy_workers_;     // Workers that have not finished yet
+  std::exception_ptr error_;          // First exception thrown by the body
+  std::mutex error_mutex_;
+
+  // Generation counter, incremented every time a new loop is started
+  std::atomic<unsigned int> generation_;
+  std::atomic<bool> stop_;    // Should the workers terminate?
+  std::atomic<int> sleeping_; // Number of sleeping workers
+  std::mutex sleep_mutex_;    // Protects wake_up_
+  std::condition_variable wake_up_;
+
+  // Serializes loops started from different threads
+  std::mutex run_mutex_;
+
+public:
+  /// Default number of spin-wait iterations.
+  static constexpr int default_spin_count = 1 << 14;
+
+  /// Constructs a thread pool.
+  /// @param n_threads Number of threads executing loops, including the
+  /// thread calling @ref run(). A non-positive value stands for
+  /// `std::thread::hardware_concurrency()`.
+  /// @param spin_count Number of iterations a worker spends polling for new
+  /// work before it falls asleep. Threads of a pool that has more threads than
+  /// there are hardware cores never spin.
+  explicit thread_pool(int n_threads = 0, int spin_count = default_spin_count)
+      : spin_count_(spin_count),
+        next_index_(0),
+        busy_workers_(0),
+        generation_(0),
+        stop_(false),
+        sleeping_(0) {
+    int const n_cores = int(std::thread::hardware_concurrency());
+    if(n_threads <= 0) n_threads = n_cores;
+    // Spinning threads would take cores away from busy ones
+    if(n_cores > 0 && n_threads > n_cores) spin_count_ = 0;
+    for(int t = 1; t < n_threads; ++t)
+      workers_.emplace_back([this] { worker_loop(); });
+  }
+
+  thread_pool(thread_pool const&) = delete;
+  thread_pool& operator=(thread_pool const&) = delete;
+
+  /// Stops and joins all worker threads.
+  ~thread_pool() {
+    stop_.store(true);
+    generation_.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      wake_up_.notify_all();
+    }
+    for(auto& w : workers_)
+      w.join();
+  }
+
+  /// Number of threads executing loops, including the calling thread.
+  int size() const { return int(workers_.size()) + 1; }
+
+  /// @brief Calls `f(i)` for all `i` in `[0; n)`.
+  ///
+  /// The calls are distributed among the calling thread and the workers.
+  /// Loops with a single iteration and loops started from within another loop
+  /// running on the pool are executed sequentially in the calling thread. If
+  /// some of the calls throw, the first caught exception is rethrown after
+  /// all calls have completed.
+  ///
+  /// @tparam F Type of the callable object.
+  /// @param n Number of calls.
+  /// @param f Callable object. It must be safe to call it concurrently.
+  template<typename F> void run(int n, F&& f) {
+    if(n <= 0) return;
+    if(workers_.empty() || n == 1 || in_task()) {
+      run_sequentially(n, f);
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(run_mutex_);
+
+    using body_t = typename std::remove_reference<F>::type;
+    job_ = [](void* data, int i) { (*static_cast<body_t*>(data))(i); };
+    job_data_ = const_cast<void*>(static_cast<void const*>(std::addressof(f)));
+    job_size_ = n;
+    error_ = nullptr;
+    next_index_.store(0, std::memory_order_relaxed);
+    busy_workers_.store(int(workers_.size()), std::memory_order_relaxed);
+
+    // Publish the loop and wake up sleeping workers
+    generation_.fetch_add(1);
+    if(sleeping_.load() > 0) {
+      std::lock_guard<std::mutex> sleep_lock(sleep_mutex_);
+      wake_up_.notify_all();
+    }
+
+    // The calling thread takes part in the loop
+    in_task() = true;
+    execute();
+    in_task() = false;
+
+    for(int s = 0; busy_workers_.load(std::memory_order_acquire) != 0; ++s) {
+      if(s < spin_count_)
+        spin_pause();
+      else
+        std::this_thread::yield();
+    }
+
+    if(error_) std::rethrow_exception(error_);
+  }
+
+  /// Thread pool installed in the calling thread by the innermost active
+  /// @ref parallel_context, or `nullptr`.
+  static thread_pool* current() { return current_ref(); }
+
+private:
+  friend class parallel_context;
+
+  /// @internal Thread-local pointer to the current thread pool.
+  static thread_pool*& current_ref() {
+    static thread_local thread_pool* pool = nullptr;
+    return pool;
+  }
+
+  /// @internal Is the calling thread executing an iteration of a loop?
+  static bool& in_task() {
+    static thread_local bool flag = false;
+    return flag;
+  }
+
+  /// @internal Hint the processor that the thread is spin-waiting.
+  static void spin_pause() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#endif
+  }
+
+  /// @internal Execute a loop in the calling thread.
+  template<typename F> static void run_sequentially(int n, F& f) {
+    std::exception_ptr error;
+    for(int i = 0; i < n; ++i) {
+      try {
+        f(i);
+      } catch(...) {
+        if(!error) error = std::current_exception();
+      }
+    }
+    if(error) std::rethrow_exception(error);
+  }
+
+  /// @internal Claim and execute iterations of the current loop.
+  void execute() {
+    int i;
+    while((i = next_index_.fetch_add(1, std::memory_order_relaxed)) <
+          job_size_) {
+      try {
+        job_(job_data_, i);
+      } catch(...) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if(!error_) error_ = std::current_exception();
+      }
+    }
+  }
+
+  /// @internal Main loop of a worker thread.
+  void worker_loop() {
+    current_ref() = this;
+    in_task() = true;
+    unsigned int seen = 0;
+    while(true) {
+      seen = wait_for_job(seen);
+      if(stop_.load()) return;
+      execute();
+      busy_workers_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  /// @internal Wait until the generation counter differs from `seen`.
+  unsigned int wait_for_job(unsigned int seen) {
+    for(int s = 0; s < spin_count_; ++s) {
+      unsigned int g = generation_.load(std::memory_order_acquire);
+      if(g != seen) return g;
+      spin_pause();
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleeping_.fetch_add(1);
+    wake_up_.wait(lock, [&] { return generation_.load() != seen; });
+    sleeping_.fetch_sub(1);
+    return generation_.load();
+  }
+};
+
+/// @brief Installs a thread pool as the executor of parallel_for() in the
+/// calling thread for the lifetime of this object.
+///
+/// Contexts can be nested, and the previously installed pool is restored upon
+/// destruction. Installing `nullptr` leaves the current pool unchanged.
+class parallel_context {
+  thread_pool* previous_;
+
+public:
+  /// Installs a thread pool.
+  /// @param pool Thread pool to install, or `nullptr`.
+  explicit parallel_context(thread_pool* pool)
+      : previous_(thread_pool::current_ref()) {
+    if(pool) thread_pool::current_ref() = pool;
+  }
+
+  parallel_context(parallel_context const&) = delete;
+  parallel_context& operator=(parallel_context const&) = delete;
+
+  /// Restores the previously installed thread pool.
+  ~parallel_context() { thread_pool::current_ref() = previous_; }
+};
+
+} // namespace ezarpack
@@ -0,0 +1,65 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/timing.hpp
+/// @brief Wall time spent by solvers in different phases of a run.
+#pragma once
+
+#include <chrono>
+
+namespace ezarpack {
+
+/// @brief Breakdown of the wall time spent in a run of `arpack_solver`.
+///
+/// All times are measured in seconds with `std::chrono::steady_clock`.
+/// In step-wise runs (see `arpack_solver::begin()`), the time elapsed between
+/// two calls to `arpack_solver::step()` is attributed to the request returned
+/// by the first of them.
+struct phase_timings {
+  /// Time spent in the ARPACK-NG iteration routine (`*aupd()`). This includes
+  /// orthogonalization of the Krylov basis and the implicit restarts.
+  double aupd = 0;
+  /// Time spent in applications of @f$ \hat A @f$ or @f$ \hat O @f$.
+  double op = 0;
+  /// Time spent in applications of @f$ \hat B @f$.
+  double b = 0;
+  /// Time spent in the shift selection functor.
+  double shifts = 0;
+  /// Time spent in the ARPACK-NG post-processing routine (`*eupd()`).
+  double eupd = 0;
+
+  /// Total time of the run.
+  double total() const { return aupd + op + b + shifts + eupd; }
+};
+
+/// @internal Measures wall time elapsed between consecutive events.
+class stopwatch {
+  using clock = std::chrono::steady_clock;
+
+  clock::time_point last_;
+
+public:
+  stopwatch() : last_(clock::now()) {}
+
+  /// Starts measuring from now.
+  void restart() { last_ = clock::now(); }
+
+  /// Adds the time elapsed since the previous lap (or since construction or
+  /// restart) to a given accumulator, and starts measuring from now.
+  void lap(double& acc) {
+    clock::time_point now = clock::now();
+    acc += std::chrono::duration<double>(now - last_).count();
+    last_ = now;
+  }
+};
+
+} // namespace ezarpack
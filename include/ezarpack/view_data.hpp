@@ -0,0 +1,64 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+/// @file ezarpack/view_data.hpp
+/// @brief Access to data arrays referenced by vector views.
+#pragma once
+
+#include <memory>
+#include <type_traits>
+
+namespace ezarpack {
+
+/// @internal Tag types ranking overloads of view_data_impl().
+template<int Rank> struct view_data_rank : view_data_rank<Rank - 1> {};
+template<> struct view_data_rank<0> {};
+
+/// @internal Views with a data() method returning a pointer.
+template<typename V>
+auto view_data_impl(V& v, view_data_rank<2>) -> typename std::enable_if<
+    std::is_pointer<decltype(v.data())>::value,
+    decltype(v.data())>::type {
+  return v.data();
+}
+
+/// @internal Address of the first element, subscript operator version.
+template<typename V>
+auto view_data_impl(V& v, view_data_rank<1>)
+    -> decltype(std::addressof(v[0])) {
+  return std::addressof(v[0]);
+}
+
+/// @internal Address of the first element, function call operator version.
+template<typename V>
+auto view_data_impl(V& v, view_data_rank<0>)
+    -> decltype(std::addressof(v(0))) {
+  return std::addressof(v(0));
+}
+
+/// @brief Returns a pointer to the first element of a vector view.
+///
+/// Vector views exposed by all storage backends reference contiguous data
+/// arrays. This function returns a pointer to the first element of a view.
+/// The pointer is obtained from the `data()` method of the view if there is
+/// one, or as the address of the first element accessed via the subscript
+/// operator or the function call operator. This makes it possible to implement
+/// linear operators working on plain arrays independently from the storage
+/// backend.
+///
+/// @param v Vector view of a non-zero size.
+template<typename V>
+auto view_data(V&& v) -> decltype(view_data_impl(v, view_data_rank<2>())) {
+  return view_data_impl(v, view_data_rank<2>());
+}
+
+} // namespace ezarpack
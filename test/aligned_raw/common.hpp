@@ -0,0 +1,180 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+#pragma once
+
+#include <cstdint>
+
+#include "ezarpack/storages/aligned_raw.hpp"
+
+#include "../raw/common.hpp"
+
+// Is 'ptr' aligned to a cache line boundary?
+template<typename T> bool is_aligned(T const* ptr) {
+  return reinterpret_cast<std::uintptr_t>(ptr) %
+             aligned_array<T>::alignment() ==
+         0;
+}
+
+template<typename T> T const* get_ptr(aligned_array<T> const& x) {
+  return x.data();
+}
+
+// Pointer to the j-th column of a matrix
+template<typename T> T const* get_col(aligned_array<T> const& m, int j) {
+  return m.data() + j * m.col_spacing();
+}
+template<typename T>
+T const* get_col(aligned_matrix_const_view<T> const& m, int j) {
+  return m.col(j);
+}
+
+namespace ezarpack { // To make ADL for the following functions work
+
+// Check that 'ar' contains the correct solution of a standard eigenproblem
+template<operator_kind MKind, typename M>
+void check_eigenvectors(arpack_solver<MKind, aligned_raw_storage> const& ar,
+                        M&& m) {
+  using scalar_t =
+      typename std::conditional<MKind == Symmetric, double, dcomplex>::type;
+
+  auto eigenvalues = ar.eigenvalues();
+  auto eigenvectors = ar.eigenvectors();
+
+  int const N = ar.dim();
+  int const nev = ar.nconv();
+  for(int i = 0; i < nev; ++i) {
+    CHECK(is_aligned(get_col(eigenvectors, i)));
+    // RHS
+    auto rhs = make_buffer<scalar_t>(N);
+    scale(get_col(eigenvectors, i), eigenvalues[i], rhs.get(), N);
+    // LHS
+    auto lhs = make_buffer<scalar_t>(N);
+    mv_prod(get_ptr(m), get_col(eigenvectors, i), lhs.get(), N);
+
+    CHECK_THAT(rhs.get(), IsCloseTo(lhs.get(), N));
+  }
+}
+
+// Check that 'ar' contains the correct solution of a generalized eigenproblem
+template<operator_kind MKind, typename M>
+void check_eigenvectors(arpack_solver<MKind, aligned_raw_storage> const& ar,
+                        M&& a,
+                        M&& m) {
+  using scalar_t =
+      typename std::conditional<MKind == Symmetric, double, dcomplex>::type;
+
+  auto eigenvalues = ar.eigenvalues();
+  auto eigenvectors = ar.eigenvectors();
+
+  int const N = ar.dim();
+  int const nev = ar.nconv();
+  for(int i = 0; i < nev; ++i) {
+    // RHS
+    auto rhs = make_buffer<scalar_t>(N);
+    mv_prod(get_ptr(m), get_col(eigenvectors, i), rhs.get(), N);
+    scale(rhs.get(), eigenvalues[i], rhs.get(), N);
+    // LHS
+    auto lhs = make_buffer<scalar_t>(N);
+    mv_prod(get_ptr(a), get_col(eigenvectors, i), lhs.get(), N);
+
+    CHECK_THAT(rhs.get(), IsCloseTo(lhs.get(), N));
+  }
+}
+
+// Check that 'ar' contains the correct solution of a generalized eigenproblem
+// (Asymmetric Shift-and-Invert modes)
+template<typename M>
+void check_eigenvectors_shift_and_invert(
+    arpack_solver<Asymmetric, aligned_raw_storage> const& ar,
+    M&& a,
+    M&& m) {
+  using solver_t = arpack_solver<Asymmetric, aligned_raw_storage>;
+  using vv_t = solver_t::vector_view_t;
+  using vcv_t = solver_t::vector_const_view_t;
+
+  int const N = ar.dim();
+  auto Aop = [&](vcv_t in, vv_t out) { mv_prod(get_ptr(a), in, out, N); };
+
+  auto eigenvalues = ar.eigenvalues(Aop);
+  auto eigenvectors = ar.eigenvectors();
+
+  int const nev = ar.nconv();
+  for(int i = 0; i < nev; ++i) {
+    // RHS
+    auto rhs = make_buffer<dcomplex>(N);
+    mv_prod(get_ptr(m), get_col(eigenvectors, i), rhs.get(), N);
+    scale(rhs.get(), eigenvalues[i], rhs.get(), N);
+    // LHS
+    auto lhs = make_buffer<dcomplex>(N);
+    mv_prod(get_ptr(a), get_col(eigenvectors, i), lhs.get(), N);
+
+    CHECK_THAT(rhs.get(), IsCloseTo(lhs.get(), N));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// In the real symmetric case, eigenvectors form an orthonormal basis
+auto get_basis_vectors(arpack_solver<Symmetric, aligned_raw_storage> const& ar)
+    -> decltype(ar.eigenvectors()) {
+  return ar.eigenvectors();
+}
+// In the other two cases we must call schur_vectors()
+template<operator_kind MKind>
+auto get_basis_vectors(arpack_solver<MKind, aligned_raw_storage> const& ar)
+    -> decltype(ar.schur_vectors()) {
+  return ar.schur_vectors();
+}
+
+// Check orthogonality of basis vectors (standard eigenproblem)
+template<operator_kind MKind>
+void check_basis_vectors(arpack_solver<MKind, aligned_raw_storage> const& ar) {
+  auto vecs = get_basis_vectors(ar);
+
+  int const N = ar.dim();
+  int const nev = ar.nconv();
+  for(int i = 0; i < nev; ++i) {
+    auto iptr = get_col(vecs, i);
+    CHECK(is_aligned(iptr));
+    for(int j = 0; j < nev; ++j) {
+      auto jptr = get_col(vecs, j);
+      scalar_t<MKind> prod = {};
+      for(int k = 0; k < N; ++k)
+        prod += conj(*(iptr + k)) * *(jptr + k);
+      CHECK(std::abs(prod - double(i == j)) < 1e-10);
+    }
+  }
+}
+// Check orthogonality of basis vectors (generalized eigenproblem)
+template<operator_kind MKind, typename M>
+void check_basis_vectors(arpack_solver<MKind, aligned_raw_storage> const& ar,
+                         M&& b) {
+  auto vecs = get_basis_vectors(ar);
+
+  int const N = ar.dim();
+  int const nev = ar.nconv();
+  auto bx = make_buffer<scalar_t<MKind>>(N);
+  for(int i = 0; i < nev; ++i) {
+    auto iptr = get_col(vecs, i);
+    for(int j = 0; j < nev; ++j) {
+      auto jptr = get_col(vecs, j);
+      mv_prod(get_ptr(b), jptr, bx.get(), N);
+      scalar_t<MKind> prod = {};
+      for(int k = 0; k < N; ++k)
+        prod += conj(*(iptr + k)) * *(bx.get() + k);
+      CHECK(std::abs(prod - double(i == j)) < 1e-10);
+    }
+  }
+}
+
+} // namespace ezarpack
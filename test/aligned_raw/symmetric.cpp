@@ -0,0 +1,197 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+
+#include "common.hpp"
+
+////////////////////////////////////////////////
+// Eigenproblems with real symmetric matrices //
+////////////////////////////////////////////////
+
+TEST_CASE("Symmetric eigenproblem is solved", "[solver_symmetric]") {
+
+  using solver_t = arpack_solver<ezarpack::Symmetric, aligned_raw_storage>;
+
+  const int N = 100;
+  const double diag_coeff_mean = 1.0;
+  const int offdiag_offset = 3;
+  const double offdiag_coeff_mean = -0.1;
+  const double offdiag_coeff_diff = 0;
+  const int nev = 8;
+
+  const double sigma = 0.102;
+
+  // Symmetric matrix A
+  auto A = make_sparse_matrix<ezarpack::Symmetric>(
+      N, diag_coeff_mean, offdiag_offset, offdiag_coeff_mean,
+      offdiag_coeff_diff);
+  // Inner product matrix
+  auto M = make_inner_prod_matrix<ezarpack::Symmetric>(N);
+
+  // Testing helper
+  auto testing = make_testing_helper<solver_t>(A, M, N, nev);
+
+  using vv_t = solver_t::vector_view_t;
+  using vcv_t = solver_t::vector_const_view_t;
+
+  SECTION("Standard eigenproblem") {
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, Aop);
+  }
+
+  SECTION("Generalized eigenproblem: invert mode") {
+    auto invM = make_buffer<double>(N * N);
+    invert(M.get(), invM.get(), N);
+    auto tmp = make_buffer<double>(N);
+    auto op = [&](vv_t in, vv_t out) {
+      mv_prod(A.get(), in, tmp.get(), N);
+      std::copy(tmp.get(), tmp.get() + N, in);
+      mv_prod(invM.get(), in, out, N);
+    };
+    auto Bop = [&](vcv_t in, vv_t out) { mv_prod(M.get(), in, out, N); };
+
+    solver_t ar(N);
+    testing.generalized_eigenproblems(ar, solver_t::Inverse, op, Bop);
+  }
+
+  SECTION("Generalized eigenproblem: Shift-and-Invert mode") {
+
+    auto AmM = make_buffer<double>(N * N);
+    for(int i = 0; i < N; ++i) {
+      for(int j = 0; j < N; ++j) {
+        AmM[i + j * N] = A[i + j * N] - sigma * M[i + j * N];
+      }
+    }
+    auto invAmM = make_buffer<double>(N * N);
+    invert(AmM.get(), invAmM.get(), N);
+    auto op_mat = make_buffer<double>(N * N);
+    mm_prod(invAmM.get(), M.get(), op_mat.get(), N);
+
+    auto op = [&](vv_t in, vv_t out) { mv_prod(op_mat.get(), in, out, N); };
+    auto Bop = [&](vcv_t in, vv_t out) { mv_prod(M.get(), in, out, N); };
+
+    solver_t ar(N);
+    testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvert, op, Bop,
+                                      sigma);
+  }
+
+  SECTION("Generalized eigenproblem: Buckling mode") {
+
+    auto MmA = make_buffer<double>(N * N);
+    for(int i = 0; i < N; ++i) {
+      for(int j = 0; j < N; ++j) {
+        MmA[i + j * N] = M[i + j * N] - sigma * A[i + j * N];
+      }
+    }
+    auto invMmA = make_buffer<double>(N * N);
+    invert(MmA.get(), invMmA.get(), N);
+    auto op_mat = make_buffer<double>(N * N);
+    mm_prod(invMmA.get(), M.get(), op_mat.get(), N);
+
+    auto op = [&](vv_t in, vv_t out) { mv_prod(op_mat.get(), in, out, N); };
+    auto Bop = [&](vcv_t in, vv_t out) { mv_prod(M.get(), in, out, N); };
+
+    solver_t ar(N);
+    const int ncv = 30;
+    testing.generalized_eigenproblems(ar, solver_t::Buckling, op, Bop, sigma,
+                                      ncv);
+  }
+
+  SECTION("Generalized eigenproblem: Cayley transformed mode") {
+
+    auto AmM = make_buffer<double>(N * N);
+    auto ApM = make_buffer<double>(N * N);
+    for(int i = 0; i < N; ++i) {
+      for(int j = 0; j < N; ++j) {
+        AmM[i + j * N] = A[i + j * N] - sigma * M[i + j * N];
+        ApM[i + j * N] = A[i + j * N] + sigma * M[i + j * N];
+      }
+    }
+    auto invAmM = make_buffer<double>(N * N);
+    invert(AmM.get(), invAmM.get(), N);
+    auto op_mat = make_buffer<double>(N * N);
+    mm_prod(invAmM.get(), ApM.get(), op_mat.get(), N);
+
+    auto op = [&](vv_t in, vv_t out) { mv_prod(op_mat.get(), in, out, N); };
+    auto Bop = [&](vcv_t in, vv_t out) { mv_prod(M.get(), in, out, N); };
+
+    solver_t ar(N);
+    testing.generalized_eigenproblems(ar, solver_t::Cayley, op, Bop, sigma);
+  }
+
+  SECTION("Alignment of vector views") {
+    using params_t = solver_t::params_t;
+
+    // Dimension is a multiple of aligned_array<T>::col_alignment()
+    const int N_a = 64;
+    auto A_a = make_sparse_matrix<ezarpack::Symmetric>(
+        N_a, diag_coeff_mean, offdiag_offset, offdiag_coeff_mean,
+        offdiag_coeff_diff);
+
+    bool views_aligned = true;
+    auto Aop = [&](vcv_t in, vv_t out) {
+      views_aligned = views_aligned && is_aligned(in) && is_aligned(out);
+      mv_prod(A_a.get(), in, out, N_a);
+    };
+
+    solver_t ar(N_a);
+    CHECK(is_aligned(ar.residual_vector()));
+
+    ar(Aop, params_t(nev, params_t::Largest, true));
+    CHECK(views_aligned);
+    auto vecs = ar.eigenvectors();
+    CHECK(vecs.col_spacing() == N_a);
+    for(int i = 0; i < int(ar.nconv()); ++i)
+      CHECK(is_aligned(vecs.col(i)));
+  }
+
+  SECTION("Indirect access to workspace vectors") {
+    solver_t ar(N);
+
+    auto Aop = [&](vcv_t, vv_t) {
+      auto in = ar.workspace_vector(ar.in_vector_n());
+      auto out = ar.workspace_vector(ar.out_vector_n());
+      mv_prod(A.get(), in, out, N);
+    };
+
+    testing.standard_eigenproblems(ar, Aop);
+
+    CHECK_THROWS(ar.workspace_vector(-1));
+    CHECK_THROWS(ar.workspace_vector(3));
+  }
+
+  SECTION("Skip computation of eigenvectors") {
+    solver_t ar(N);
+
+    SECTION("Standard eigenproblem") {
+      auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+      testing.standard_skip_eigenvectors(ar, Aop);
+    }
+
+    SECTION("Generalized eigenproblem: invert mode") {
+      auto invM = make_buffer<double>(N * N);
+      invert(M.get(), invM.get(), N);
+      auto tmp = make_buffer<double>(N);
+      auto op = [&](vv_t in, vv_t out) {
+        mv_prod(A.get(), in, tmp.get(), N);
+        std::copy(tmp.get(), tmp.get() + N, in);
+        mv_prod(invM.get(), in, out, N);
+      };
+      auto Bop = [&](vcv_t in, vv_t out) { mv_prod(M.get(), in, out, N); };
+
+      testing.generalized_skip_eigenvectors(ar, op, Bop);
+    }
+  }
+}
@@ -96,6 +96,31 @@ TEST_CASE("Asymmetric eigenproblem is solved", "[solver_asymmetric]") {
                                       sigma);
   }
 
+  SECTION("Generalized eigenproblem: sparse direct shift-and-invert") {
+    using si_t = sparse_shift_invert<ezarpack::Asymmetric>;
+    si_t::matrix_type A_sp = A.sparseView();
+    si_t::matrix_type M_sp = M.sparseView();
+
+    solver_t ar(A.rows());
+
+    SECTION("Invert mode") {
+      si_t si(A_sp, M_sp, solver_t::Inverse);
+      testing.generalized_eigenproblems(ar, solver_t::Inverse, si.op(), si.b());
+    }
+    SECTION("Shift-and-Invert mode (real part)") {
+      si_t si(A_sp, M_sp, solver_t::ShiftAndInvertReal, sigma);
+      testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvertReal,
+                                        si.op(), si.b(), sigma);
+    }
+    SECTION("Shift-and-Invert mode (imaginary part)") {
+      si_t si(A_sp, M_sp, solver_t::ShiftAndInvertImag, sigma);
+      testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvertImag,
+                                        si.op(), si.b(), sigma);
+    }
+
+    CHECK_THROWS(si_t(A_sp, M_sp, solver_t::ShiftAndInvertImag, 0));
+  }
+
   SECTION("Indirect access to workspace vectors") {
     solver_t ar(A.rows());
 
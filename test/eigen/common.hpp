@@ -19,6 +19,8 @@
 #include <vector>
 
 #include "ezarpack/arpack_solver.hpp"
+#include "ezarpack/sparse_shift_invert.hpp"
+#include "ezarpack/spectrum_slicing.hpp"
 #include "ezarpack/storages/eigen.hpp"
 
 #include <Eigen/LU>
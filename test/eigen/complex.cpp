@@ -71,6 +71,24 @@ TEST_CASE("Complex eigenproblem is solved", "[solver_complex]") {
                                       sigma);
   }
 
+  SECTION("Generalized eigenproblem: sparse direct shift-and-invert") {
+    using si_t = sparse_shift_invert<ezarpack::Complex>;
+    si_t::matrix_type A_sp = A.sparseView();
+    si_t::matrix_type M_sp = M.sparseView();
+
+    solver_t ar(A.rows());
+
+    SECTION("Invert mode") {
+      si_t si(A_sp, M_sp, solver_t::Inverse);
+      testing.generalized_eigenproblems(ar, solver_t::Inverse, si.op(), si.b());
+    }
+    SECTION("Shift-and-Invert mode") {
+      si_t si(A_sp, M_sp, solver_t::ShiftAndInvert, sigma);
+      testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvert, si.op(),
+                                        si.b(), sigma);
+    }
+  }
+
   SECTION("Indirect access to workspace vectors") {
     solver_t ar(A.rows());
 
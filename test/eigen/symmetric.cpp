@@ -96,6 +96,95 @@ TEST_CASE("Symmetric eigenproblem is solved", "[solver_symmetric]") {
     testing.generalized_eigenproblems(ar, solver_t::Cayley, op, Bop, sigma);
   }
 
+  SECTION("Generalized eigenproblem: sparse direct shift-and-invert") {
+    using si_t = sparse_shift_invert<ezarpack::Symmetric>;
+    si_t::matrix_type A_sp = A.sparseView();
+    si_t::matrix_type M_sp = M.sparseView();
+
+    solver_t ar(A.rows());
+
+    SECTION("Invert mode") {
+      si_t si(A_sp, M_sp, solver_t::Inverse);
+      testing.generalized_eigenproblems(ar, solver_t::Inverse, si.op(), si.b());
+    }
+    SECTION("Shift-and-Invert mode") {
+      si_t si(A_sp, M_sp, solver_t::ShiftAndInvert, sigma);
+      testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvert, si.op(),
+                                        si.b(), sigma);
+    }
+    SECTION("Buckling mode") {
+      si_t si(M_sp, A_sp, solver_t::Buckling, sigma);
+      const int ncv = 30;
+      testing.generalized_eigenproblems(ar, solver_t::Buckling, si.op(),
+                                        si.b(), sigma, ncv);
+    }
+    SECTION("Cayley transformed mode") {
+      si_t si(A_sp, M_sp, solver_t::Cayley, sigma);
+      testing.generalized_eigenproblems(ar, solver_t::Cayley, si.op(), si.b(),
+                                        sigma);
+    }
+    SECTION("Change of the shift") {
+      si_t si(A_sp, M_sp, solver_t::ShiftAndInvert, 0);
+      si.set_sigma(sigma);
+      CHECK(si.sigma() == sigma);
+      testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvert, si.op(),
+                                        si.b(), sigma);
+    }
+
+    CHECK_THROWS(si_t(A_sp, M_sp, 1));
+    CHECK_THROWS(si_t(A_sp, si_t::matrix_type(N + 1, N + 1), 3, sigma));
+  }
+
+  SECTION("Spectrum slicing") {
+    using params_t = solver_t::params_t;
+    using si_t = sparse_shift_invert<ezarpack::Symmetric>;
+    using slicer_t = spectrum_slicer<eigen_storage>;
+
+    // Lift degeneracy of the eigenvalues
+    matrix<double> A_p = A;
+    for(int i = 0; i < N; ++i)
+      A_p(i, i) += 0.01 * i / N;
+    si_t::matrix_type A_sp = A_p.sparseView();
+    si_t::matrix_type M_sp = M.sparseView();
+
+    si_t counter(A_sp, M_sp, solver_t::ShiftAndInvert, 0);
+    auto count = [&](double x) {
+      counter.set_sigma(x);
+      return double(counter.n_eigenvalues_below_sigma());
+    };
+
+    auto Aop = [&](vcv_t in, vv_t out) { out = A_p * in; };
+    slicer_t slicer(N, Aop, 2);
+    slicer.set_count_function(count);
+
+    slicing_params params;
+    params.n_slices = 3;
+    params.n_eigenvalues = 12;
+    spectral_interval const interval = {0.9, 1.1};
+    auto result = slicer(
+        interval,
+        [&](spectral_slice const&, params_t const& p, solver_t& ar) {
+          si_t si(A_sp, M_sp, solver_t::ShiftAndInvert, p.sigma);
+          ar(si.op(), si.b(), solver_t::ShiftAndInvert, p);
+        },
+        params);
+
+    CHECK(result.complete());
+    CHECK(result.size() == count(interval.upper) - count(interval.lower));
+    for(auto const& slice : result.slices) {
+      CHECK(slice.n_expected <= params.n_eigenvalues);
+      CHECK(slice.n_found == slice.n_expected);
+    }
+    for(int i = 0; i < result.size(); ++i) {
+      Eigen::Map<const vector<double>> vec(
+          result.eigenvectors.data() + i * N, N);
+      CHECK_THAT(A_p * vec, IsCloseTo(result.eigenvalues[i] * M * vec, 1e-9));
+    }
+
+    si_t buckling(M_sp, A_sp, solver_t::Buckling, 0.5);
+    CHECK_THROWS(buckling.n_eigenvalues_below_sigma());
+  }
+
   SECTION("Indirect access to workspace vectors") {
     solver_t ar(A.rows());
 
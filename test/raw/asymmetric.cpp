@@ -153,6 +153,269 @@ TEST_CASE("Asymmetric eigenproblem is solved", "[solver_asymmetric]") {
                                       sigma);
   }
 
+  SECTION("Reuse of workspace in subsequent runs") {
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, Aop, 40);
+    auto workd = ar.workspace_vector(0);
+    auto v = ar.schur_vectors();
+
+    // Runs with a non-increasing ncv do not reallocate the workspace
+    testing.standard_eigenproblems(ar, Aop, 30);
+    CHECK(ar.workspace_vector(0) == workd);
+    CHECK(ar.schur_vectors() == v);
+    testing.standard_eigenproblems(ar, Aop);
+    CHECK(ar.workspace_vector(0) == workd);
+    CHECK(ar.schur_vectors() == v);
+
+    testing.standard_eigenproblems(ar, Aop, 50);
+  }
+
+  SECTION("Memory footprint and preallocation") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+
+    params_t params(nev, params_t::LargestMagnitude, params_t::Ritz);
+    auto f = ar.memory_footprint(params);
+    const std::size_t ncv = 2 * nev + 2;
+    CHECK(f.resid == N * sizeof(double));
+    CHECK(f.workd == 3 * N * sizeof(double));
+    CHECK(f.v == N * ncv * sizeof(double));
+    CHECK(f.dr == ncv * sizeof(double));
+    CHECK(f.di == ncv * sizeof(double));
+    CHECK(f.z == N * (nev + 1) * sizeof(double));
+    CHECK(f.workl == (3 * ncv * ncv + 6 * ncv) * sizeof(double));
+    CHECK(f.workev == 3 * ncv * sizeof(double));
+    CHECK(f.select == ncv * sizeof(int));
+    CHECK(f.total() == f.resid + f.workd + f.v + f.dr + f.di + f.z + f.workl +
+                           f.workev + f.select);
+
+    params.compute_vectors = params_t::None;
+    CHECK(ar.memory_footprint(params).z == sizeof(double));
+
+    params.ncv = N + 1;
+    CHECK_THROWS(ar.memory_footprint(params));
+
+    CHECK_THROWS(ar.reserve(0));
+    CHECK_THROWS(ar.reserve(N + 1));
+    ar.reserve(params_t(nev, params_t::LargestMagnitude, params_t::Ritz));
+    testing.standard_eigenproblems(ar, Aop);
+  }
+
+  SECTION("User-supplied buffer for Arnoldi basis vectors") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+
+    const int ncv = 30;
+    const int ld = N + 4;
+    auto buffer = make_buffer<double>(ld * ncv);
+    CHECK_THROWS(ar.set_basis_buffer(nullptr, ncv));
+    CHECK_THROWS(ar.set_basis_buffer(buffer.get(), ncv, N - 1));
+    ar.set_basis_buffer(buffer.get(), ncv, ld);
+
+    params_t params(nev, params_t::LargestMagnitude, params_t::Ritz);
+    params.random_residual_vector = false;
+    params.ncv = ncv;
+    CHECK(ar.memory_footprint(params).v == 0);
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    CHECK(ar.nconv() >= nev);
+    check_eigenvectors(ar, A);
+    CHECK_THROWS(ar.schur_vectors());
+
+    params.ncv = ncv + 1;
+    CHECK_THROWS(ar(Aop, params));
+
+    ar.reset_basis_buffer();
+    // Vectors written into the basis buffer are not served after a reset
+    CHECK_THROWS(ar.eigenvectors());
+    CHECK_THROWS(ar.schur_vectors());
+    testing.standard_eigenproblems(ar, Aop);
+  }
+
+  SECTION("CSR operator") {
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, make_csr_operator(A.get(), N));
+    testing.standard_eigenproblems(
+        ar, make_csr_operator(A.get(), N, CSRGeneral, 1));
+  }
+
+  SECTION("Iterative shift-and-invert") {
+    using si_t = iterative_shift_invert<ezarpack::Asymmetric>;
+    auto Aop = [&](double const* x, double* y) { mv_prod(A.get(), x, y, N); };
+    auto Mop = [&](double const* x, double* y) { mv_prod(M.get(), x, y, N); };
+
+    inner_solver_params params;
+    params.gmres_restart = N;
+
+    solver_t ar(N);
+
+    SECTION("Shift-and-Invert mode (real part)") {
+      si_t si(N, Aop, Mop, solver_t::ShiftAndInvertReal, sigma, params);
+      testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvertReal,
+                                        si.op(), si.b(), sigma);
+      CHECK(si.inner_stats().n_unconverged == 0);
+    }
+
+    SECTION("Shift-and-Invert mode (imaginary part)") {
+      si_t si(N, Aop, Mop, solver_t::ShiftAndInvertImag, sigma, params);
+      testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvertImag,
+                                        si.op(), si.b(), sigma);
+      CHECK(si.inner_stats().n_unconverged == 0);
+    }
+
+    params.method = InnerCG;
+    CHECK_THROWS(si_t(N, Aop, Mop, solver_t::ShiftAndInvertReal, sigma,
+                      params));
+  }
+
+  SECTION("Memory placement policy") {
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+    CHECK(ar.placement().is_default());
+
+    ezarpack::placement_policy policy(true, ezarpack::NUMAInterleave);
+    ar.set_placement(policy);
+    CHECK(ar.placement().huge_pages);
+    CHECK(ar.placement().numa == ezarpack::NUMAInterleave);
+    testing.standard_eigenproblems(ar, Aop);
+
+    ar.set_placement(
+        ezarpack::placement_policy(false, ezarpack::NUMAFirstTouch));
+    testing.standard_eigenproblems(ar, Aop, 40);
+  }
+
+  SECTION("Block operator") {
+    int n_block_calls = 0;
+    auto Ablock = [&](vcv_t in, vv_t out, int k) {
+      for(int j = 0; j < k; ++j)
+        mv_prod(A.get(), in + j * N, out + j * N, N);
+      if(k > 1) ++n_block_calls;
+    };
+    auto Aop = ezarpack::make_block_operator(Ablock);
+
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, Aop);
+    CHECK(n_block_calls == 0);
+
+    // Rayleigh quotients are computed in a single call of Ablock
+    auto lambda = ar.eigenvalues(Aop);
+    CHECK(n_block_calls == 1);
+    auto lambda_ref = ar.eigenvalues();
+    CHECK_THAT(lambda.get(), IsCloseTo(lambda_ref.get(), ar.nconv()));
+  }
+
+  SECTION("Thread-safe operator") {
+    auto Aop = ezarpack::make_thread_safe_operator(
+        [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); });
+
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, Aop);
+
+    // Rayleigh quotients are computed concurrently
+    auto lambda = ar.eigenvalues(Aop);
+    auto lambda_ref = ar.eigenvalues();
+    CHECK_THAT(lambda.get(), IsCloseTo(lambda_ref.get(), ar.nconv()));
+  }
+
+  SECTION("Thread pool") {
+    ezarpack::thread_pool pool(4);
+    // Records whether all calls to parallel_for() use the pool
+    std::atomic<bool> pool_used(true);
+    auto Aop = ezarpack::make_thread_safe_operator([&](vcv_t in, vv_t out) {
+      if(ezarpack::thread_pool::current() != &pool) pool_used = false;
+      mv_prod(A.get(), in, out, N);
+    });
+
+    solver_t ar(N);
+    CHECK(ar.executor() == nullptr);
+    ar.set_executor(&pool);
+    CHECK(ar.executor() == &pool);
+    testing.standard_eigenproblems(ar, Aop);
+    CHECK(pool_used);
+    CHECK(ezarpack::thread_pool::current() == nullptr);
+
+    // Rayleigh quotients are computed on the pool
+    auto lambda = ar.eigenvalues(Aop);
+    CHECK(pool_used);
+    auto lambda_ref = ar.eigenvalues();
+    CHECK_THAT(lambda.get(), IsCloseTo(lambda_ref.get(), ar.nconv()));
+
+    // Pool installed by the caller
+    ar.set_executor(nullptr);
+    ezarpack::parallel_context context(&pool);
+    testing.standard_eigenproblems(ar, Aop);
+    CHECK(pool_used);
+  }
+
+  SECTION("Step-wise interface") {
+    using params_t = solver_t::params_t;
+    params_t params(nev, params_t::LargestMagnitude, params_t::Ritz);
+    params.random_residual_vector = false;
+
+    solver_t ar(N);
+    CHECK_THROWS(ar.step());
+    CHECK_THROWS(ar.finish());
+
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    unsigned int nconv_ref = ar.nconv();
+    auto lambda_ref = ar.eigenvalues();
+
+    set_init_residual_vector(ar);
+    ar.begin(params);
+    while(true) {
+      auto s = ar.step();
+      if(s.request == ezarpack::Done) break;
+      REQUIRE(s.request != ezarpack::ApplyB);
+      CHECK_THROWS(ar.finish());
+      mv_prod(A.get(), s.in, s.out, N);
+    }
+    CHECK_THROWS(ar.step());
+    ar.finish();
+    CHECK_THROWS(ar.finish());
+
+    REQUIRE(ar.nconv() == nconv_ref);
+    auto lambda = ar.eigenvalues();
+    CHECK_THAT(lambda.get(), IsCloseTo(lambda_ref.get(), nconv_ref));
+    check_eigenvectors(ar, A);
+    check_basis_vectors(ar);
+  }
+
+  SECTION("Lazy and in-place access to eigenvectors") {
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+    CHECK_THROWS(ar.eigenvector_view(0));
+    testing.standard_eigenproblems(ar, Aop);
+
+    int nconv = ar.nconv();
+    auto vecs_ref = ar.eigenvectors();
+    auto vecs = make_buffer<dcomplex>((N + 1) * nconv);
+    ar.eigenvectors_into(vecs.get(), N + 1);
+    for(int i = 0; i < nconv; ++i) {
+      auto view = ar.eigenvector_view(i);
+      auto vec = ar.eigenvector(i);
+      auto vec_ref = vecs_ref.get() + i * N;
+      CHECK(view.size() == N);
+      for(int k = 0; k < N; ++k)
+        CHECK(view[k] == vec_ref[k]);
+      CHECK_THAT(vec.get(), IsCloseTo(vec_ref, N));
+      CHECK_THAT(vecs.get() + i * (N + 1), IsCloseTo(vec_ref, N));
+    }
+
+    CHECK_THROWS(ar.eigenvector_view(nconv));
+    CHECK_THROWS(ar.eigenvector(nconv));
+    CHECK_THROWS(ar.eigenvectors_into(vecs.get(), N - 1));
+  }
+
   SECTION("Indirect access to workspace vectors") {
     solver_t ar(N);
 
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <numeric>
 #include <type_traits>
@@ -20,6 +21,15 @@
 #include <vector>
 
 #include "ezarpack/arpack_solver.hpp"
+#include "ezarpack/batch_solver.hpp"
+#include "ezarpack/csr_operator.hpp"
+#include "ezarpack/dia_operator.hpp"
+#include "ezarpack/interleaved_solver.hpp"
+#include "ezarpack/iterative_shift_invert.hpp"
+#include "ezarpack/polynomial_filter.hpp"
+#include "ezarpack/spectral_density.hpp"
+#include "ezarpack/spectrum_slicing.hpp"
+#include "ezarpack/stencil_operator.hpp"
 #include "ezarpack/storages/raw.hpp"
 
 #include "../common.hpp"
@@ -71,6 +81,44 @@ std::unique_ptr<T[]> make_inner_prod_matrix(int N) {
   return M;
 }
 
+// Make a CSR operator out of a dense matrix
+template<typename T>
+csr_operator<T> make_csr_operator(T const* m,
+                                  int N,
+                                  csr_structure structure = CSRGeneral,
+                                  int n_parts = 0) {
+  std::vector<int> row_ptr(1, 0);
+  std::vector<int> col_ind;
+  std::vector<T> values;
+  for(int i = 0; i < N; ++i) {
+    for(int j = (structure == CSRGeneral ? 0 : i); j < N; ++j) {
+      if(m[i + j * N] == T(0)) continue;
+      col_ind.push_back(j);
+      values.push_back(m[i + j * N]);
+    }
+    row_ptr.push_back(int(col_ind.size()));
+  }
+  return csr_operator<T>(N, row_ptr, col_ind, values, structure, n_parts);
+}
+
+// Make a DIA operator out of a dense matrix
+template<typename T> dia_operator<T> make_dia_operator(T const* m, int N) {
+  std::vector<int> offsets;
+  std::vector<T> values;
+  for(int offset = -N + 1; offset < N; ++offset) {
+    std::vector<T> diag(N, T(0));
+    bool nonzero = false;
+    for(int i = std::max(0, -offset); i < std::min(N, N - offset); ++i) {
+      diag[i] = m[i + (i + offset) * N];
+      nonzero = nonzero || (diag[i] != T(0));
+    }
+    if(!nonzero) continue;
+    offsets.push_back(offset);
+    values.insert(values.end(), diag.begin(), diag.end());
+  }
+  return dia_operator<T>(N, offsets, values);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 // Matrix-vector product m * v
@@ -120,6 +120,225 @@ TEST_CASE("Complex eigenproblem is solved", "[solver_complex]") {
                                       sigma);
   }
 
+  SECTION("Reuse of workspace in subsequent runs") {
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, Aop, 40);
+    auto workd = ar.workspace_vector(0);
+    auto v = ar.schur_vectors();
+
+    // Runs with a non-increasing ncv do not reallocate the workspace
+    testing.standard_eigenproblems(ar, Aop, 30);
+    CHECK(ar.workspace_vector(0) == workd);
+    CHECK(ar.schur_vectors() == v);
+    testing.standard_eigenproblems(ar, Aop);
+    CHECK(ar.workspace_vector(0) == workd);
+    CHECK(ar.schur_vectors() == v);
+
+    testing.standard_eigenproblems(ar, Aop, 50);
+  }
+
+  SECTION("Memory footprint and preallocation") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+
+    params_t params(nev, params_t::LargestMagnitude, params_t::Ritz);
+    auto f = ar.memory_footprint(params);
+    const std::size_t ncv = 2 * nev + 2;
+    CHECK(f.resid == N * sizeof(dcomplex));
+    CHECK(f.workd == 3 * N * sizeof(dcomplex));
+    CHECK(f.v == N * ncv * sizeof(dcomplex));
+    CHECK(f.d == ncv * sizeof(dcomplex));
+    CHECK(f.z == N * (nev + 1) * sizeof(dcomplex));
+    CHECK(f.workl == (3 * ncv * ncv + 5 * ncv) * sizeof(dcomplex));
+    CHECK(f.workev == 2 * ncv * sizeof(dcomplex));
+    CHECK(f.rwork == ncv * sizeof(double));
+    CHECK(f.select == ncv * sizeof(int));
+    CHECK(f.total() == f.resid + f.workd + f.v + f.d + f.z + f.workl +
+                           f.workev + f.rwork + f.select);
+
+    params.compute_vectors = params_t::None;
+    CHECK(ar.memory_footprint(params).z == sizeof(dcomplex));
+
+    params.ncv = N + 1;
+    CHECK_THROWS(ar.memory_footprint(params));
+
+    CHECK_THROWS(ar.reserve(0));
+    CHECK_THROWS(ar.reserve(N + 1));
+    ar.reserve(params_t(nev, params_t::LargestMagnitude, params_t::Ritz));
+    testing.standard_eigenproblems(ar, Aop);
+  }
+
+  SECTION("User-supplied buffer for Arnoldi basis vectors") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+
+    const int ncv = 30;
+    const int ld = N + 4;
+    auto buffer = make_buffer<dcomplex>(ld * ncv);
+    CHECK_THROWS(ar.set_basis_buffer(nullptr, ncv));
+    CHECK_THROWS(ar.set_basis_buffer(buffer.get(), ncv, N - 1));
+    ar.set_basis_buffer(buffer.get(), ncv, ld);
+
+    params_t params(nev, params_t::LargestMagnitude, params_t::Ritz);
+    params.random_residual_vector = false;
+    params.ncv = ncv;
+    CHECK(ar.memory_footprint(params).v == 0);
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    CHECK(ar.nconv() >= nev);
+    check_eigenvectors(ar, A);
+    CHECK_THROWS(ar.schur_vectors());
+
+    params.ncv = ncv + 1;
+    CHECK_THROWS(ar(Aop, params));
+
+    ar.reset_basis_buffer();
+    // Vectors written into the basis buffer are not served after a reset
+    CHECK_THROWS(ar.eigenvectors());
+    CHECK_THROWS(ar.schur_vectors());
+    testing.standard_eigenproblems(ar, Aop);
+  }
+
+  SECTION("User-supplied buffer for Ritz vectors") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+
+    const int ld = N + 4;
+    auto buffer = make_buffer<dcomplex>(ld * nev);
+    CHECK_THROWS(ar.set_eigenvectors_buffer(nullptr, nev));
+    CHECK_THROWS(ar.set_eigenvectors_buffer(buffer.get(), nev, N - 1));
+    ar.set_eigenvectors_buffer(buffer.get(), nev, ld);
+
+    params_t params(nev, params_t::LargestMagnitude, params_t::Ritz);
+    params.random_residual_vector = false;
+    CHECK(ar.memory_footprint(params).z == 0);
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    CHECK(ar.nconv() >= nev);
+    CHECK_THROWS(ar.eigenvectors());
+
+    auto eigenvalues = ar.eigenvalues();
+    for(int i = 0; i < nev; ++i) {
+      auto rhs = make_buffer<dcomplex>(N);
+      scale(buffer.get() + i * ld, eigenvalues[i], rhs.get(), N);
+      auto lhs = make_buffer<dcomplex>(N);
+      mv_prod(A.get(), buffer.get() + i * ld, lhs.get(), N);
+      CHECK_THAT(rhs.get(), IsCloseTo(lhs.get(), N));
+    }
+
+    params.n_eigenvalues = nev + 1;
+    CHECK_THROWS(ar(Aop, params));
+
+    ar.reset_eigenvectors_buffer();
+    // Vectors written into the eigenvector buffer are not served after a reset
+    CHECK_THROWS(ar.eigenvectors());
+    CHECK_THROWS(ar.schur_vectors());
+    testing.standard_eigenproblems(ar, Aop);
+  }
+
+  SECTION("CSR operator") {
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, make_csr_operator(A.get(), N));
+
+    // Hermitian matrix H = A + A^\dagger
+    auto H = make_buffer<dcomplex>(N * N);
+    for(int i = 0; i < N; ++i) {
+      for(int j = 0; j < N; ++j)
+        H[i + j * N] = A[i + j * N] + std::conj(A[j + i * N]);
+    }
+
+    for(int n_parts = 1; n_parts <= 4; ++n_parts) {
+      auto Hop = make_csr_operator(H.get(), N, CSRUpperHermitian, n_parts);
+      auto x = make_buffer<dcomplex>(N);
+      for(int i = 0; i < N; ++i)
+        x[i] = dcomplex(std::cos(i), std::sin(2 * i));
+      auto y = make_buffer<dcomplex>(N);
+      auto y_ref = make_buffer<dcomplex>(N);
+      Hop(x.get(), y.get());
+      mv_prod(H.get(), x.get(), y_ref.get(), N);
+      CHECK_THAT(y.get(), IsCloseTo(y_ref.get(), N));
+    }
+  }
+
+  SECTION("Iterative shift-and-invert") {
+    using si_t = iterative_shift_invert<ezarpack::Complex>;
+    auto Aop = [&](dcomplex const* x, dcomplex* y) {
+      mv_prod(A.get(), x, y, N);
+    };
+    auto Mop = [&](dcomplex const* x, dcomplex* y) {
+      mv_prod(M.get(), x, y, N);
+    };
+
+    inner_solver_params params;
+    params.gmres_restart = N;
+    si_t si(N, Aop, Mop, solver_t::ShiftAndInvert, sigma, params);
+
+    solver_t ar(N);
+    testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvert, si.op(),
+                                      si.b(), sigma);
+    CHECK(si.inner_stats().n_unconverged == 0);
+  }
+
+  SECTION("Memory placement policy") {
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+    CHECK(ar.placement().is_default());
+
+    ezarpack::placement_policy policy(true, ezarpack::NUMAInterleave);
+    ar.set_placement(policy);
+    CHECK(ar.placement().huge_pages);
+    CHECK(ar.placement().numa == ezarpack::NUMAInterleave);
+    testing.standard_eigenproblems(ar, Aop);
+
+    ar.set_placement(
+        ezarpack::placement_policy(false, ezarpack::NUMAFirstTouch));
+    testing.standard_eigenproblems(ar, Aop, 40);
+  }
+
+  SECTION("Step-wise interface") {
+    using params_t = solver_t::params_t;
+    params_t params(nev, params_t::LargestMagnitude, params_t::Ritz);
+    params.random_residual_vector = false;
+
+    solver_t ar(N);
+    CHECK_THROWS(ar.step());
+    CHECK_THROWS(ar.finish());
+
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    std::vector<dcomplex> lambda_ref(ar.eigenvalues(),
+                                     ar.eigenvalues() + ar.nconv());
+
+    set_init_residual_vector(ar);
+    ar.begin(params);
+    while(true) {
+      auto s = ar.step();
+      if(s.request == ezarpack::Done) break;
+      REQUIRE(s.request != ezarpack::ApplyB);
+      CHECK_THROWS(ar.finish());
+      mv_prod(A.get(), s.in, s.out, N);
+    }
+    CHECK_THROWS(ar.step());
+    ar.finish();
+    CHECK_THROWS(ar.finish());
+
+    REQUIRE(ar.nconv() == lambda_ref.size());
+    for(std::size_t k = 0; k < lambda_ref.size(); ++k)
+      CHECK(std::abs(ar.eigenvalues()[k] - lambda_ref[k]) < 1e-10);
+    check_eigenvectors(ar, A);
+    check_basis_vectors(ar);
+  }
+
   SECTION("Indirect access to workspace vectors") {
     solver_t ar(N);
 
@@ -0,0 +1,240 @@
+/*******************************************************************************
+ *
+ * This file is part of ezARPACK, an easy-to-use C++ wrapper for
+ * the ARPACK-NG FORTRAN library.
+ *
+ * Copyright (C) 2016-2023 Igor Krivenko <igor.s.krivenko@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ ******************************************************************************/
+
+#include <deque>
+
+#include "common.hpp"
+
+#include "ezarpack/coroutine.hpp"
+
+// Queue of coroutines whose linear operator applications are in flight
+std::deque<std::coroutine_handle<>> in_flight;
+
+// Awaitable computing a matrix-vector product upon resumption
+struct deferred_mv_prod {
+  double const* A;
+  double const* in;
+  double* out;
+  int N;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> h) { in_flight.push_back(h); }
+  void await_resume() const { mv_prod(A, in, out, N); }
+};
+
+// Resume suspended coroutines until there are none left
+void run_event_loop() {
+  while(!in_flight.empty()) {
+    auto h = in_flight.front();
+    in_flight.pop_front();
+    h.resume();
+  }
+}
+
+ezarpack::solve_task await_solve(ezarpack::solve_task task, bool& resumed) {
+  co_await task;
+  resumed = true;
+}
+
+// Coroutine suspended outside of the event loop
+std::coroutine_handle<> parked;
+
+// Awaitable parking the awaiting coroutine
+struct park {
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> h) { parked = h; }
+  void await_resume() const noexcept {}
+};
+
+ezarpack::solve_task await_solve_and_park(ezarpack::solve_task task,
+                                          std::vector<int>& events) {
+  co_await task;
+  events.push_back(0);
+  co_await park{};
+}
+
+TEST_CASE("Solves are run in coroutines", "[coroutine]") {
+
+  using solver_t = arpack_solver<ezarpack::Symmetric, raw_storage>;
+  using params_t = solver_t::params_t;
+  using vv_t = solver_t::vector_view_t;
+  using vcv_t = solver_t::vector_const_view_t;
+
+  const int N = 100;
+  const int nev = 8;
+  const double sigma = 0.102;
+
+  auto A = make_sparse_matrix<ezarpack::Symmetric>(N, 1.0, 3, -0.1, 0.0);
+  auto M = make_inner_prod_matrix<ezarpack::Symmetric>(N);
+
+  params_t params(nev, params_t::Largest, true);
+  params.random_residual_vector = false;
+
+  // Reference solution
+  solver_t ar_ref(N);
+  set_init_residual_vector(ar_ref);
+  ar_ref([&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); }, params);
+  std::vector<double> lambda_ref(ar_ref.eigenvalues(),
+                                 ar_ref.eigenvalues() + ar_ref.nconv());
+
+  auto Aop = [&](vv_t in, vv_t out) {
+    return deferred_mv_prod{A.get(), in, out, N};
+  };
+
+  SECTION("Standard eigenproblem") {
+    const int n_solves = 3;
+    std::vector<std::unique_ptr<solver_t>> solvers;
+    std::vector<ezarpack::solve_task> tasks;
+    for(int i = 0; i < n_solves; ++i) {
+      solvers.emplace_back(new solver_t(N));
+      set_init_residual_vector(*solvers.back());
+      tasks.push_back(ezarpack::async_solve(*solvers.back(), Aop, params));
+    }
+
+    for(auto& t : tasks) {
+      CHECK_FALSE(t.done());
+      t.start();
+    }
+    CHECK_THROWS(tasks[0].start());
+    CHECK_THROWS(tasks[0].get());
+    run_event_loop();
+
+    for(int i = 0; i < n_solves; ++i) {
+      REQUIRE(tasks[i].done());
+      tasks[i].get();
+      REQUIRE(solvers[i]->nconv() == lambda_ref.size());
+      for(std::size_t k = 0; k < lambda_ref.size(); ++k)
+        CHECK(solvers[i]->eigenvalues()[k] == Approx(lambda_ref[k]));
+      check_eigenvectors(*solvers[i], A);
+    }
+  }
+
+  SECTION("Generalized eigenproblem: Shift-and-Invert mode") {
+    auto AmM = make_buffer<double>(N * N);
+    for(int i = 0; i < N * N; ++i)
+      AmM[i] = A[i] - sigma * M[i];
+    auto invAmM = make_buffer<double>(N * N);
+    invert(AmM.get(), invAmM.get(), N);
+    auto op_mat = make_buffer<double>(N * N);
+    mm_prod(invAmM.get(), M.get(), op_mat.get(), N);
+
+    auto op = [&](vv_t in, vv_t out) {
+      return deferred_mv_prod{op_mat.get(), in, out, N};
+    };
+    // A synchronous operator
+    auto Bop = [&](vv_t in, vv_t out) { mv_prod(M.get(), in, out, N); };
+
+    params.eigenvalues_select = params_t::LargestMagnitude;
+    params.sigma = sigma;
+
+    solver_t ar(N);
+    set_init_residual_vector(ar);
+    bool resumed = false;
+    auto task = await_solve(
+        ezarpack::async_solve(ar, op, Bop, solver_t::ShiftAndInvert, params),
+        resumed);
+    task.start();
+    run_event_loop();
+
+    REQUIRE(task.done());
+    task.get();
+    CHECK(resumed);
+    CHECK(ar.nconv() >= nev);
+    check_eigenvectors(ar, A, M);
+    check_basis_vectors(ar, M);
+  }
+
+  SECTION("Hand-over of the turn") {
+    std::vector<int> events;
+    auto Aop_sync = [&](vcv_t in, vv_t out) {
+      if(events.empty() || events.back() != 1) events.push_back(1);
+      mv_prod(A.get(), in, out, N);
+    };
+
+    solver_t ar0(N), ar1(N);
+    set_init_residual_vector(ar0);
+    set_init_residual_vector(ar1);
+    bool resumed = false;
+    auto t0 =
+        await_solve_and_park(ezarpack::async_solve(ar0, Aop, params), events);
+    auto t1 =
+        await_solve(ezarpack::async_solve(ar1, Aop_sync, params), resumed);
+    t0.start();
+    t1.start();
+    run_event_loop();
+
+    // The awaiting coroutine is resumed before the next solve
+    CHECK(events == std::vector<int>{0});
+    CHECK_FALSE(t1.done());
+
+    ezarpack::resume_waiting_solves();
+    REQUIRE(t1.done());
+    t1.get();
+    CHECK(resumed);
+    CHECK(events == std::vector<int>{0, 1});
+    CHECK(ar1.nconv() == lambda_ref.size());
+
+    parked.resume();
+    REQUIRE(t0.done());
+    t0.get();
+    CHECK(ar0.nconv() == lambda_ref.size());
+  }
+
+  SECTION("Destruction of a waiting task") {
+    solver_t ar0(N), ar1(N), ar2(N);
+    set_init_residual_vector(ar0);
+    set_init_residual_vector(ar2);
+    auto t0 = ezarpack::async_solve(ar0, Aop, params);
+    auto t2 = ezarpack::async_solve(ar2, Aop, params);
+    t0.start();
+    {
+      // The task leaves the queue without taking the turn
+      auto t1 = ezarpack::async_solve(ar1, Aop, params);
+      t1.start();
+    }
+    t2.start();
+    run_event_loop();
+
+    REQUIRE(t0.done());
+    t0.get();
+    REQUIRE(t2.done());
+    t2.get();
+    CHECK(ar2.nconv() == lambda_ref.size());
+
+    // The gate is free again
+    set_init_residual_vector(ar0);
+    auto t3 = ezarpack::async_solve(ar0, Aop, params);
+    t3.start();
+    run_event_loop();
+    REQUIRE(t3.done());
+    t3.get();
+  }
+
+  SECTION("Exceptions") {
+    solver_t ar(N);
+    auto failing_op = [](vv_t, vv_t) { throw std::logic_error("Failure"); };
+    auto task = ezarpack::async_solve(ar, failing_op, params);
+    task.start();
+    REQUIRE(task.done());
+    CHECK_THROWS_AS(task.get(), std::logic_error);
+
+    // The next solve is not blocked by the failed one
+    set_init_residual_vector(ar);
+    task = ezarpack::async_solve(ar, Aop, params);
+    task.start();
+    run_event_loop();
+    REQUIRE(task.done());
+    task.get();
+    CHECK(ar.nconv() == lambda_ref.size());
+  }
+}
@@ -13,6 +13,7 @@
 #pragma once
 
 #include "ezarpack/mpi/arpack_solver.hpp"
+#include "ezarpack/mpi/halo_operator.hpp"
 
 #include "../../common_mpi.hpp"
 #include "../common.hpp"
@@ -171,6 +171,16 @@ TEST_CASE("Symmetric eigenproblem is solved", "[solver_symmetric]") {
     testing.generalized_eigenproblems(ar, solver_t::Cayley, op, Bop, sigma);
   }
 
+  SECTION("DIA operator with halo exchange") {
+    auto Aop = mpi::make_halo_operator(make_dia_operator(A.get(), N),
+                                       MPI_COMM_WORLD);
+
+    solver_t ar(N, MPI_COMM_WORLD);
+    CHECK(Aop.local_block_start() == ar.local_block_start());
+    CHECK(Aop.local_block_size() == ar.local_block_size());
+    testing.standard_eigenproblems(ar, Aop);
+  }
+
   SECTION("Indirect access to workspace vectors") {
     solver_t ar(N, MPI_COMM_WORLD);
 
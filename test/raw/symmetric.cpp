@@ -11,6 +11,9 @@
  *
  ******************************************************************************/
 
+#include <sstream>
+#include <string>
+
 #include "common.hpp"
 
 ///////////////////
@@ -53,6 +56,35 @@ TEST_CASE("Symmetric matrix is inverted", "[invert_symmetric]") {
 // Eigenproblems with real symmetric matrices //
 ////////////////////////////////////////////////
 
+// Exposes the lockstep machinery of interleaved_solver, which can only be
+// used by the solver objects with a reentrant ARPACK-NG library
+using interleaved_t = interleaved_solver<ezarpack::Symmetric, raw_storage>;
+struct lockstep_probe : interleaved_t {
+  using interleaved_t::interleaved_t;
+  using interleaved_t::solve_in_lockstep;
+};
+
+// Imitates a solve of the i-th eigenproblem that applies the linear operator
+// A + i * 1 to 4 + i vectors and counts wrong results
+struct imitated_solve {
+  double const* A;
+  int N;
+  std::atomic<int>* n_wrong;
+
+  template<typename Op> void operator()(int i, Op& op) const {
+    std::vector<double> in(N), out(N), ref(N);
+    for(int step = 0; step < 4 + i; ++step) {
+      for(int k = 0; k < N; ++k)
+        in[k] = std::sin(i + 0.1 * step + 0.01 * k);
+      op(in.data(), out.data());
+      mv_prod(A, in.data(), ref.data(), N);
+      for(int k = 0; k < N; ++k) {
+        if(std::abs(out[k] - ref[k] - i * in[k]) > 1e-10) ++*n_wrong;
+      }
+    }
+  }
+};
+
 TEST_CASE("Symmetric eigenproblem is solved", "[solver_symmetric]") {
 
   using solver_t = arpack_solver<ezarpack::Symmetric, raw_storage>;
@@ -166,6 +198,817 @@ TEST_CASE("Symmetric eigenproblem is solved", "[solver_symmetric]") {
     testing.generalized_eigenproblems(ar, solver_t::Cayley, op, Bop, sigma);
   }
 
+  SECTION("Reuse of workspace in subsequent runs") {
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, Aop, 40);
+    auto workd = ar.workspace_vector(0);
+    auto v = ar.eigenvectors();
+
+    // Runs with a non-increasing ncv do not reallocate the workspace
+    testing.standard_eigenproblems(ar, Aop, 30);
+    CHECK(ar.workspace_vector(0) == workd);
+    CHECK(ar.eigenvectors() == v);
+    testing.standard_eigenproblems(ar, Aop);
+    CHECK(ar.workspace_vector(0) == workd);
+    CHECK(ar.eigenvectors() == v);
+
+    testing.standard_eigenproblems(ar, Aop, 50);
+  }
+
+  SECTION("Memory footprint and preallocation") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+
+    params_t params(nev, params_t::Largest, true);
+    auto f = ar.memory_footprint(params);
+    const std::size_t ncv = 2 * nev + 2;
+    CHECK(f.resid == N * sizeof(double));
+    CHECK(f.workd == 3 * N * sizeof(double));
+    CHECK(f.v == N * ncv * sizeof(double));
+    CHECK(f.d == ncv * sizeof(double));
+    CHECK(f.workl == (ncv * ncv + 8 * ncv) * sizeof(double));
+    CHECK(f.select == ncv * sizeof(int));
+    CHECK(f.total() == f.resid + f.workd + f.v + f.d + f.workl + f.select);
+
+    params.ncv = N + 1;
+    CHECK_THROWS(ar.memory_footprint(params));
+
+    CHECK_THROWS(ar.reserve(0));
+    CHECK_THROWS(ar.reserve(N + 1));
+    ar.reserve(40);
+    testing.standard_eigenproblems(ar, Aop, 40);
+  }
+
+  SECTION("User-supplied buffer for Lanczos basis vectors") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+
+    const int ncv = 30;
+    const int ld = N + 4;
+    auto buffer = make_buffer<double>(ld * ncv);
+    CHECK_THROWS(ar.set_basis_buffer(nullptr, ncv));
+    CHECK_THROWS(ar.set_basis_buffer(buffer.get(), ncv, N - 1));
+    ar.set_basis_buffer(buffer.get(), ncv, ld);
+
+    params_t params(nev, params_t::Largest, true);
+    params.random_residual_vector = false;
+    params.ncv = ncv;
+    CHECK(ar.memory_footprint(params).v == 0);
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    CHECK(ar.nconv() >= nev);
+    CHECK_THROWS(ar.eigenvectors());
+
+    auto eigenvalues = ar.eigenvalues();
+    for(int i = 0; i < int(ar.nconv()); ++i) {
+      auto rhs = make_buffer<double>(N);
+      scale(buffer.get() + i * ld, eigenvalues[i], rhs.get(), N);
+      auto lhs = make_buffer<double>(N);
+      mv_prod(A.get(), buffer.get() + i * ld, lhs.get(), N);
+      CHECK_THAT(rhs.get(), IsCloseTo(lhs.get(), N));
+    }
+
+    params.ncv = ncv + 1;
+    CHECK_THROWS(ar(Aop, params));
+
+    ar.reset_basis_buffer();
+    // Vectors written into the basis buffer are not served after a reset
+    CHECK_THROWS(ar.eigenvectors());
+    CHECK_THROWS(ar.eigenvalues(Aop));
+    testing.standard_eigenproblems(ar, Aop);
+  }
+
+  SECTION("User-supplied buffer for Ritz vectors") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+
+    const int ld = N + 4;
+    auto buffer = make_buffer<double>(ld * nev);
+    CHECK_THROWS(ar.set_eigenvectors_buffer(nullptr, nev));
+    CHECK_THROWS(ar.set_eigenvectors_buffer(buffer.get(), nev, N - 1));
+    ar.set_eigenvectors_buffer(buffer.get(), nev, ld);
+
+    params_t params(nev, params_t::Largest, true);
+    params.random_residual_vector = false;
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    CHECK(ar.nconv() >= nev);
+    CHECK_THROWS(ar.eigenvectors());
+
+    auto eigenvalues = ar.eigenvalues();
+    for(int i = 0; i < nev; ++i) {
+      auto rhs = make_buffer<double>(N);
+      scale(buffer.get() + i * ld, eigenvalues[i], rhs.get(), N);
+      auto lhs = make_buffer<double>(N);
+      mv_prod(A.get(), buffer.get() + i * ld, lhs.get(), N);
+      CHECK_THAT(rhs.get(), IsCloseTo(lhs.get(), N));
+    }
+
+    params.n_eigenvalues = nev + 1;
+    CHECK_THROWS(ar(Aop, params));
+
+    ar.reset_eigenvectors_buffer();
+    // Vectors written into the eigenvector buffer are not served after a reset
+    CHECK_THROWS(ar.eigenvectors());
+    CHECK_THROWS(ar.eigenvalues(Aop));
+    testing.standard_eigenproblems(ar, Aop);
+  }
+
+  SECTION("CSR operator") {
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, make_csr_operator(A.get(), N));
+    testing.standard_eigenproblems(
+        ar, make_csr_operator(A.get(), N, CSRUpperSymmetric, 3));
+
+    for(int n_parts = 1; n_parts <= 4; ++n_parts) {
+      auto Aop = make_csr_operator(A.get(), N, CSRUpperSymmetric, n_parts);
+      CHECK(Aop.dim() == N);
+      CHECK(Aop.n_parts() == n_parts);
+
+      auto x = make_buffer<double>(N);
+      for(int i = 0; i < N; ++i)
+        x[i] = std::cos(i);
+      auto y = make_buffer<double>(N);
+      auto y_ref = make_buffer<double>(N);
+      Aop(x.get(), y.get());
+      mv_prod(A.get(), x.get(), y_ref.get(), N);
+      CHECK_THAT(y.get(), IsCloseTo(y_ref.get(), N));
+    }
+
+    // The default number of parts follows the executor running the product
+    {
+      ezarpack::thread_pool pool(3);
+      ezarpack::parallel_context context(&pool);
+      auto Aop = make_csr_operator(A.get(), N, CSRUpperSymmetric);
+      CHECK(Aop.n_parts() == 3);
+      testing.standard_eigenproblems(ar, Aop);
+    }
+
+    CHECK_THROWS(csr_operator<double>(2, {0, 1}, {0}, {1.0}));
+    CHECK_THROWS(csr_operator<double>(2, {0, 1, 2}, {0, 2}, {1.0, 1.0}));
+    CHECK_THROWS(csr_operator<double>(2, {0, 1, 2}, {1, 0}, {1.0, 1.0},
+                                      CSRUpperSymmetric));
+  }
+
+  SECTION("DIA operator") {
+    auto Aop = make_dia_operator(A.get(), N);
+    CHECK(Aop.n_diagonals() == 3);
+    CHECK(Aop.lower_bandwidth() == offdiag_offset);
+    CHECK(Aop.upper_bandwidth() == offdiag_offset);
+
+    solver_t ar(N);
+    testing.standard_eigenproblems(ar, Aop);
+
+    CHECK_THROWS(dia_operator<double>(2, {0, 0}, {1, 1, 1, 1}));
+    CHECK_THROWS(dia_operator<double>(2, {0, 2}, {1, 1, 1, 1}));
+    CHECK_THROWS(dia_operator<double>(2, {0}, {1, 1, 1}));
+  }
+
+  SECTION("Stencil operator") {
+    using params_t = solver_t::params_t;
+
+    // 7-point Laplacian stencil
+    std::vector<stencil_point> points = {{0, 0, 0},  {-1, 0, 0}, {1, 0, 0},
+                                         {0, -1, 0}, {0, 1, 0},  {0, 0, -1},
+                                         {0, 0, 1}};
+    std::vector<double> coeffs = {6, -1, -1, -1, -1, -1, -1};
+
+    for(auto shape : std::vector<std::array<int, 3>>{
+            {100, 1, 1}, {10, 10, 1}, {5, 4, 5}}) {
+      // Dense matrix of the operator
+      auto L = make_buffer<double>(N * N);
+      std::fill(L.get(), L.get() + N * N, 0);
+      for(int iz = 0; iz < shape[2]; ++iz) {
+        for(int iy = 0; iy < shape[1]; ++iy) {
+          for(int ix = 0; ix < shape[0]; ++ix) {
+            int i = ix + shape[0] * (iy + shape[1] * iz);
+            for(int p = 0; p < int(points.size()); ++p) {
+              int jx = ix + points[p].dx;
+              int jy = iy + points[p].dy;
+              int jz = iz + points[p].dz;
+              if(jx < 0 || jx >= shape[0] || jy < 0 || jy >= shape[1] ||
+                 jz < 0 || jz >= shape[2])
+                continue;
+              int j = jx + shape[0] * (jy + shape[1] * jz);
+              L[i + j * N] = coeffs[p] * (1 + 0.01 * i);
+            }
+          }
+        }
+      }
+
+      // Site-dependent coefficients
+      std::vector<double> var_coeffs(points.size() * N);
+      for(int p = 0; p < int(points.size()); ++p) {
+        for(int i = 0; i < N; ++i)
+          var_coeffs[p * N + i] = coeffs[p] * (1 + 0.01 * i);
+      }
+      stencil_operator<double> Lop(shape, points, var_coeffs);
+      CHECK(Lop.dim() == N);
+      CHECK(Lop.variable_coefficients());
+
+      auto x = make_buffer<double>(N);
+      for(int i = 0; i < N; ++i)
+        x[i] = std::cos(i);
+      auto y = make_buffer<double>(N);
+      auto y_ref = make_buffer<double>(N);
+      Lop(x.get(), y.get());
+      mv_prod(L.get(), x.get(), y_ref.get(), N);
+      CHECK_THAT(y.get(), IsCloseTo(y_ref.get(), N));
+
+      // Components [30; 70) of the product
+      Lop.apply_rows(x.get() + 30, y.get(), 30, 70);
+      CHECK_THAT(y.get(), IsCloseTo(y_ref.get() + 30, 40));
+    }
+
+    // Constant coefficients
+    stencil_operator<double> Lop({10, 10, 1}, points, coeffs);
+    CHECK(!Lop.variable_coefficients());
+    CHECK(Lop.lower_bandwidth() == 10);
+    CHECK(Lop.upper_bandwidth() == 10);
+
+    solver_t ar(N);
+    ar(Lop, params_t(nev, params_t::Smallest, true));
+    CHECK(ar.nconv() >= nev);
+    // Smallest eigenvalue of the 2D Laplacian on a 10x10 grid
+    double lambda_min = 6 - 4 * std::cos(std::acos(-1.0) / 11);
+    CHECK(ar.eigenvalues()[0] == Approx(lambda_min));
+
+    CHECK_THROWS(stencil_operator<double>({0, 1, 1}, points, coeffs));
+    CHECK_THROWS(stencil_operator<double>({10, 10, 1}, points, {1, 2}));
+  }
+
+  SECTION("Batch solver") {
+    using params_t = solver_t::params_t;
+    params_t params(nev, params_t::Largest, true);
+
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+    solver_t ar(N);
+    ar(Aop, params);
+    std::vector<double> lambda_ref(ar.eigenvalues(),
+                                   ar.eigenvalues() + ar.nconv());
+
+    // Eigenproblems for matrices A + i * 1
+    const int n_problems = 5;
+    std::vector<std::vector<double>> lambda(n_problems);
+    auto solve = [&](int i, solver_t& solver) {
+      auto Aop_i = [&](vcv_t in, vv_t out) {
+        mv_prod(A.get(), in, out, N);
+        for(int k = 0; k < N; ++k)
+          out[k] += i * in[k];
+      };
+      solver(Aop_i, params);
+    };
+    auto result = [&](int i, solver_t const& solver) {
+      lambda[i].assign(solver.eigenvalues(),
+                       solver.eigenvalues() + solver.nconv());
+    };
+
+    batch_solver<ezarpack::Symmetric, raw_storage> batch(N, 2);
+    CHECK(batch.dim() == N);
+    CHECK(batch.n_threads() == 2);
+    batch(n_problems, solve, result);
+    // ARPACK-NG is not reentrant, so a single solver object is recycled
+    CHECK(batch.n_solvers() == 1);
+    for(int i = 0; i < n_problems; ++i) {
+      REQUIRE(lambda[i].size() == lambda_ref.size());
+      for(std::size_t k = 0; k < lambda_ref.size(); ++k)
+        CHECK(lambda[i][k] == Approx(lambda_ref[k] + i));
+    }
+
+    // Failure to solve one of the eigenproblems
+    int n_results = 0;
+    auto solve_or_throw = [&](int i, solver_t& solver) {
+      if(i == 2) throw std::runtime_error("Eigenproblem 2 failed");
+      solve(i, solver);
+    };
+    auto count = [&](int, solver_t const&) { ++n_results; };
+    CHECK_THROWS_AS(batch(n_problems, solve_or_throw, count),
+                    std::runtime_error);
+    CHECK(n_results == n_problems - 1);
+    CHECK(batch.n_solvers() == 1);
+  }
+
+  SECTION("Interleaved solver") {
+    using params_t = solver_t::params_t;
+    params_t params(nev, params_t::Largest, true);
+
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+    solver_t ar(N);
+    ar(Aop, params);
+    std::vector<double> lambda_ref(ar.eigenvalues(),
+                                   ar.eigenvalues() + ar.nconv());
+
+    // Eigenproblems for matrices A + i * 1
+    const int n_problems = 3;
+    interleaved_solver<ezarpack::Symmetric, raw_storage> is(N, n_problems);
+    CHECK(is.dim() == N);
+    CHECK(is.size() == n_problems);
+
+    int n_columns = 0;
+    auto Ablock = [&](vcv_t in, vv_t out, std::vector<int> const& problems) {
+      n_columns += problems.size();
+      for(int j = 0; j < int(problems.size()); ++j) {
+        mv_prod(A.get(), in + j * N, out + j * N, N);
+        for(int k = 0; k < N; ++k)
+          out[j * N + k] += problems[j] * in[j * N + k];
+      }
+    };
+    is(Ablock, std::vector<params_t>(n_problems, params));
+
+    for(int i = 0; i < n_problems; ++i) {
+      auto const& solver = is.solver(i);
+      REQUIRE(solver.nconv() == lambda_ref.size());
+      for(std::size_t k = 0; k < lambda_ref.size(); ++k)
+        CHECK(solver.eigenvalues()[k] == Approx(lambda_ref[k] + i));
+    }
+    // ARPACK-NG is not reentrant, so the eigenproblems are solved one after
+    // another
+    CHECK(is.n_block_applications() == n_columns);
+
+    CHECK_THROWS(is(Ablock, std::vector<params_t>(1, params)));
+
+    // Lockstep execution of 5 imitated solves in groups of 3
+    lockstep_probe probe(N, 5, 3);
+    CHECK(probe.n_threads() == 3);
+    std::vector<int> widths;
+    auto Ablock_widths = [&](vcv_t in, vv_t out,
+                             std::vector<int> const& problems) {
+      widths.push_back(int(problems.size()));
+      Ablock(in, out, problems);
+    };
+    std::atomic<int> n_wrong(0);
+    probe.solve_in_lockstep(Ablock_widths, probe.n_threads(),
+                            imitated_solve{A.get(), N, &n_wrong});
+    CHECK(n_wrong == 0);
+    CHECK(widths ==
+          std::vector<int>{3, 3, 3, 3, 2, 1, 2, 2, 2, 2, 2, 2, 2, 1});
+    CHECK(probe.n_block_applications() == int(widths.size()));
+  }
+
+  SECTION("Step-wise interface") {
+    using params_t = solver_t::params_t;
+    params_t params(nev, params_t::Largest, true);
+    params.random_residual_vector = false;
+
+    solver_t ar(N);
+    CHECK_THROWS(ar.step());
+    CHECK_THROWS(ar.finish());
+
+    // Standard eigenproblem
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    std::vector<double> lambda_ref(ar.eigenvalues(),
+                                   ar.eigenvalues() + ar.nconv());
+
+    set_init_residual_vector(ar);
+    ar.begin(params);
+    while(true) {
+      auto s = ar.step();
+      if(s.request == ezarpack::Done) break;
+      REQUIRE(s.request != ezarpack::ApplyB);
+      CHECK_THROWS(ar.finish());
+      mv_prod(A.get(), s.in, s.out, N);
+    }
+    CHECK_THROWS(ar.step());
+    ar.finish();
+    CHECK_THROWS(ar.finish());
+
+    REQUIRE(ar.nconv() == lambda_ref.size());
+    for(std::size_t k = 0; k < lambda_ref.size(); ++k)
+      CHECK(ar.eigenvalues()[k] == Approx(lambda_ref[k]));
+    check_eigenvectors(ar, A);
+
+    // Generalized eigenproblem: Shift-and-Invert mode
+    auto AmM = make_buffer<double>(N * N);
+    for(int i = 0; i < N * N; ++i)
+      AmM[i] = A[i] - sigma * M[i];
+    auto invAmM = make_buffer<double>(N * N);
+    invert(AmM.get(), invAmM.get(), N);
+    auto op_mat = make_buffer<double>(N * N);
+    mm_prod(invAmM.get(), M.get(), op_mat.get(), N);
+
+    params.eigenvalues_select = params_t::LargestMagnitude;
+    params.sigma = sigma;
+    set_init_residual_vector(ar);
+    ar.begin(solver_t::ShiftAndInvert, params);
+    while(true) {
+      auto s = ar.step();
+      if(s.request == ezarpack::Done) break;
+      if(s.request == ezarpack::ApplyB)
+        mv_prod(M.get(), s.in, s.out, N);
+      else
+        mv_prod(op_mat.get(), s.in, s.out, N);
+    }
+    ar.finish();
+    CHECK(ar.nconv() >= nev);
+    check_eigenvectors(ar, A, M);
+    check_basis_vectors(ar, M);
+  }
+
+  SECTION("Interruption") {
+    using params_t = solver_t::params_t;
+    params_t params(nev, params_t::Largest, true);
+    params.random_residual_vector = false;
+    const int ncv = 2 * nev + 2;
+
+    ezarpack::interruption_policy policy;
+    int n_ops = 0;
+    int cancel_at = -1;
+    auto Aop = [&](vcv_t in, vv_t out) {
+      if(++n_ops == cancel_at) policy.token.cancel();
+      mv_prod(A.get(), in, out, N);
+    };
+
+    solver_t ar(N);
+    CHECK(ar.interruption().mode == ezarpack::PartialResults);
+    ar.set_interruption(policy);
+
+    // Cancellation
+    cancel_at = 2 * nev;
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    CHECK(ar.interrupted());
+    CHECK(n_ops <= cancel_at + ncv);
+    CHECK(ar.nconv() <= nev);
+    check_eigenvectors(ar, A);
+
+    policy.mode = ezarpack::ThrowOnInterruption;
+    ar.set_interruption(policy);
+    CHECK_THROWS_AS(ar(Aop, params), ezarpack::solve_interrupted);
+    CHECK(ar.interrupted());
+
+    // A thrown interruption abandons a step-wise run
+    ar.begin(params);
+    CHECK_THROWS_AS(ar.step(), ezarpack::solve_interrupted);
+    CHECK_THROWS(ar.step());
+    CHECK_THROWS(ar.finish());
+
+    ar.set_interruption(ezarpack::interruption_policy());
+    set_init_residual_vector(ar);
+    ar.begin(params);
+    while(true) {
+      auto s = ar.step();
+      if(s.request == ezarpack::Done) break;
+      mv_prod(A.get(), s.in, s.out, N);
+    }
+    ar.finish();
+    CHECK_FALSE(ar.interrupted());
+    CHECK(ar.nconv() >= nev);
+    check_eigenvectors(ar, A);
+
+    // Time limit
+    policy.token.reset();
+    policy.mode = ezarpack::PartialResults;
+    policy.time_limit = std::chrono::seconds(0);
+    ar.set_interruption(policy);
+    n_ops = 0;
+    cancel_at = -1;
+    set_init_residual_vector(ar);
+    ar(Aop, params);
+    CHECK(ar.interrupted());
+    CHECK(n_ops <= ncv + 1);
+    CHECK(ar.nconv() <= nev);
+    check_eigenvectors(ar, A);
+
+    // No interruption
+    ar.set_interruption(ezarpack::interruption_policy());
+    ar(Aop, params);
+    CHECK_FALSE(ar.interrupted());
+    CHECK(ar.nconv() >= nev);
+    check_eigenvectors(ar, A);
+  }
+
+  SECTION("Phase timings") {
+    using params_t = solver_t::params_t;
+    params_t params(nev, params_t::Largest, true);
+
+    using clock = std::chrono::steady_clock;
+    double t_op = 0, t_b = 0;
+    auto timed = [](double& t, double const* mat, vcv_t in, vv_t out) {
+      auto start = clock::now();
+      mv_prod(mat, in, out, N);
+      t += std::chrono::duration<double>(clock::now() - start).count();
+    };
+
+    solver_t ar(N);
+
+    // Standard eigenproblem
+    ar([&](vcv_t in, vv_t out) { timed(t_op, A.get(), in, out); }, params);
+    auto timings = ar.stats().timings;
+    CHECK(timings.aupd > 0);
+    CHECK(timings.op >= t_op);
+    CHECK(timings.b == 0);
+    CHECK(timings.shifts == 0);
+    CHECK(timings.eupd > 0);
+    CHECK(timings.total() ==
+          Approx(timings.aupd + timings.op + timings.eupd));
+
+    // Generalized eigenproblem: Shift-and-Invert mode
+    auto AmM = make_buffer<double>(N * N);
+    for(int i = 0; i < N * N; ++i)
+      AmM[i] = A[i] - sigma * M[i];
+    auto invAmM = make_buffer<double>(N * N);
+    invert(AmM.get(), invAmM.get(), N);
+    auto op_mat = make_buffer<double>(N * N);
+    mm_prod(invAmM.get(), M.get(), op_mat.get(), N);
+
+    params.eigenvalues_select = params_t::LargestMagnitude;
+    params.sigma = sigma;
+    t_op = 0;
+    ar([&](vv_t in, vv_t out) { timed(t_op, op_mat.get(), in, out); },
+       [&](vcv_t in, vv_t out) { timed(t_b, M.get(), in, out); },
+       solver_t::ShiftAndInvert, params);
+    timings = ar.stats().timings;
+    CHECK(timings.op >= t_op);
+    CHECK(timings.b >= t_b);
+    CHECK(timings.b > 0);
+  }
+
+  SECTION("Convergence trace") {
+    using params_t = solver_t::params_t;
+    params_t params(nev, params_t::Largest, true);
+    params.ncv = 2 * nev + 2;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    ezarpack::convergence_trace trace;
+    solver_t ar(N);
+    CHECK(ar.trace() == nullptr);
+    ar.set_trace(&trace);
+    CHECK(ar.trace() == &trace);
+
+    ar(Aop, params);
+    REQUIRE_FALSE(trace.empty());
+    for(std::size_t n = 0; n < trace.size(); ++n) {
+      auto const& r = trace.records()[n];
+      CHECK(r.iteration == int(n + 1));
+      CHECK(r.ritz_values.size() == std::size_t(params.ncv));
+      CHECK(r.ritz_estimates.size() == std::size_t(params.ncv));
+      if(n > 0)
+        CHECK(r.n_op_x_operations > trace.records()[n - 1].n_op_x_operations);
+    }
+    auto const& last = trace.records().back();
+    CHECK(last.nconv == int(ar.nconv()));
+    CHECK(last.n_op_x_operations > 0);
+
+    std::ostringstream csv;
+    trace.write_csv(csv);
+    std::string const csv_str = csv.str();
+    CHECK(std::count(csv_str.begin(), csv_str.end(), '\n') ==
+          int(trace.size() * params.ncv + 1));
+    std::ostringstream json;
+    trace.write_json(json);
+    std::string const json_str = json.str();
+    CHECK(json_str.front() == '[');
+    CHECK(std::count(json_str.begin(), json_str.end(), '{') ==
+          int(trace.size()));
+
+    // A new run discards the previous records
+    std::size_t size = trace.size();
+    ar(Aop, params);
+    CHECK(trace.size() == size);
+
+    ar.set_trace(nullptr);
+    trace.clear();
+    ar(Aop, params);
+    CHECK(trace.empty());
+  }
+
+  SECTION("Iterative shift-and-invert") {
+    using si_t = iterative_shift_invert<ezarpack::Symmetric>;
+    auto Aop = [&](double const* x, double* y) { mv_prod(A.get(), x, y, N); };
+    auto Mop = [&](double const* x, double* y) { mv_prod(M.get(), x, y, N); };
+
+    solver_t ar(N);
+
+    SECTION("MINRES") {
+      inner_solver_params params;
+      params.method = InnerMINRES;
+      si_t si(N, Aop, Mop, solver_t::ShiftAndInvert, sigma, params);
+      testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvert, si.op(),
+                                        si.b(), sigma);
+      CHECK(si.inner_stats().n_solves > 0);
+      CHECK(si.inner_stats().n_unconverged == 0);
+    }
+
+    SECTION("GMRES, Cayley transformed mode") {
+      inner_solver_params params;
+      params.gmres_restart = N;
+      si_t si(N, Aop, Mop, solver_t::Cayley, sigma, params);
+      testing.generalized_eigenproblems(ar, solver_t::Cayley, si.op(), si.b(),
+                                        sigma);
+      CHECK(si.inner_stats().n_unconverged == 0);
+    }
+
+    SECTION("Inner tolerance tied to the outer iteration") {
+      inner_solver_params params;
+      params.method = InnerMINRES;
+      params.tol = 1e-13;
+      params.max_tol = 1e-11;
+      si_t si(N, Aop, Mop, solver_t::ShiftAndInvert, sigma, params);
+
+      ezarpack::convergence_trace trace;
+      ar.set_trace(&trace);
+      si.set_trace(&trace);
+      CHECK(si.inner_tol() == params.max_tol);
+      testing.generalized_eigenproblems(ar, solver_t::ShiftAndInvert, si.op(),
+                                        si.b(), sigma);
+      CHECK(si.inner_tol() < params.max_tol);
+
+      si.set_trace(nullptr);
+      CHECK(si.inner_tol() == params.tol);
+    }
+
+    CHECK_THROWS(si_t(N, Aop, Mop, 1, sigma));
+    inner_solver_params bad_params;
+    bad_params.max_tol = bad_params.tol / 2;
+    CHECK_THROWS(si_t(N, Aop, Mop, solver_t::ShiftAndInvert, sigma,
+                      bad_params));
+  }
+
+  SECTION("Chebyshev filter") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    auto bounds = estimate_spectral_bounds<raw_storage>(Aop, N);
+    CHECK(bounds.lower < diag_coeff_mean + 2 * offdiag_coeff_mean);
+    CHECK(bounds.upper > diag_coeff_mean - 2 * offdiag_coeff_mean);
+
+    spectral_interval const window = {0.95, 1.05};
+    chebyshev_filter<raw_storage> filter(N, Aop, window, 60, JacksonDamping,
+                                         bounds);
+    CHECK(filter.dim() == N);
+    CHECK(filter.degree() == 60);
+    CHECK(filter.coefficients().size() == 61);
+
+    solver_t ar(N);
+    params_t params(nev, params_t::Largest, true);
+    set_init_residual_vector(ar);
+    ar(filter, params);
+
+    auto eigenvalues = ar.eigenvalues(Aop);
+    auto eigenvectors = ar.eigenvectors();
+    for(int i = 0; i < nev; ++i) {
+      CHECK(filter.contains(eigenvalues[i]));
+      auto lhs = make_buffer<double>(N);
+      mv_prod(A.get(), eigenvectors + i * N, lhs.get(), N);
+      auto rhs = make_buffer<double>(N);
+      scale(eigenvectors + i * N, eigenvalues[i], rhs.get(), N);
+      CHECK_THAT(lhs.get(), IsCloseTo(rhs.get(), N));
+    }
+
+    CHECK_THROWS(chebyshev_filter<raw_storage>(N, Aop, {1.05, 0.95}, 60));
+    CHECK_THROWS(chebyshev_filter<raw_storage>(N, Aop, {2.0, 3.0}, 60));
+    CHECK_THROWS(chebyshev_filter<raw_storage>(N, Aop, window, 0));
+  }
+
+  SECTION("Spectrum slicing") {
+    using params_t = solver_t::params_t;
+    using slicer_t = spectrum_slicer<raw_storage>;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+    auto bounds = estimate_spectral_bounds<raw_storage>(Aop, N);
+
+    slicer_t slicer(N, Aop, 2);
+    CHECK(slicer.dim() == N);
+    CHECK(slicer.n_threads() == 2);
+
+    slicing_params params;
+    params.n_slices = 3;
+    params.n_eigenvalues = nev;
+    spectral_interval const interval = {0.92, 1.08};
+    auto result = slicer(
+        interval,
+        [&](spectral_slice const& slice, params_t const& p, solver_t& ar) {
+          chebyshev_filter<raw_storage> filter(N, Aop, slice.interval, 60,
+                                               JacksonDamping, bounds);
+          params_t run_params = p;
+          run_params.random_residual_vector = false;
+          set_init_residual_vector(ar);
+          ar(filter, run_params);
+        },
+        params);
+
+    CHECK(result.complete());
+    CHECK(result.slices.front().interval.lower == interval.lower);
+    CHECK(result.slices.back().interval.upper == interval.upper);
+    int n_found = 0;
+    for(std::size_t s = 0; s < result.slices.size(); ++s) {
+      if(s > 0) {
+        CHECK(result.slices[s].interval.lower ==
+              result.slices[s - 1].interval.upper);
+      }
+      n_found += result.slices[s].n_found;
+    }
+    CHECK(n_found == result.size());
+
+    for(int i = 0; i < result.size(); ++i) {
+      double const lambda = result.eigenvalues[i];
+      CHECK(lambda >= interval.lower);
+      CHECK(lambda < interval.upper);
+      if(i > 0) CHECK(lambda >= result.eigenvalues[i - 1]);
+      double const* x = result.eigenvectors.data() + i * N;
+      auto lhs = make_buffer<double>(N);
+      mv_prod(A.get(), x, lhs.get(), N);
+      auto rhs = make_buffer<double>(N);
+      scale(x, lambda, rhs.get(), N);
+      CHECK_THAT(lhs.get(), IsCloseTo(rhs.get(), N));
+    }
+
+    auto no_run = [](spectral_slice const&, params_t const&, solver_t&) {};
+    CHECK_THROWS(slicer({1.0, 1.0}, no_run));
+  }
+
+  SECTION("Spectral density") {
+    using params_t = solver_t::params_t;
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    kpm_params kpm;
+    auto dos = estimate_spectral_density<raw_storage>(Aop, N, kpm);
+    CHECK(dos.dim() == N);
+    CHECK(dos.degree() == kpm.degree);
+    CHECK(dos.n_probes() == kpm.n_probes);
+    CHECK(std::abs(dos.moments()[0] - 1) < 1e-10);
+    CHECK(std::abs(dos.count(dos.bounds()) - N) < 1e-8);
+    CHECK(dos.count_below(dos.bounds().lower) == 0);
+    CHECK(dos.count_below(dos.bounds().upper) == N);
+
+    // A consists of 3 decoupled tridiagonal blocks with known spectra
+    spectral_interval const window = {0.9, 1.1};
+    double const pi = std::acos(-1.0);
+    int n_exact = 0;
+    for(int b = 0; b < offdiag_offset; ++b) {
+      int const n = (N - b + offdiag_offset - 1) / offdiag_offset;
+      for(int k = 1; k <= n; ++k) {
+        double const lambda =
+            diag_coeff_mean +
+            2 * offdiag_coeff_mean * std::cos(k * pi / (n + 1));
+        n_exact += lambda >= window.lower && lambda < window.upper;
+      }
+    }
+    double const count = dos.count(window);
+    double const error = dos.count_error(window);
+    CHECK(error > 0);
+    CHECK(std::abs(count - n_exact) < 4 * error + 1);
+
+    params_t params(1, params_t::Largest, true);
+    dos.tune_params(params, window, 4);
+    CHECK(int(params.n_eigenvalues) >= n_exact);
+    CHECK(int(params.n_eigenvalues) < N);
+    CHECK(params.ncv > int(params.n_eigenvalues));
+    CHECK(params.ncv <= N);
+
+    // Block operators and smaller blocks of probe vectors
+    auto Aop_block = make_block_operator([&](vcv_t in, vv_t out, int k) {
+      for(int i = 0; i < k; ++i)
+        mv_prod(A.get(), in + i * N, out + i * N, N);
+    });
+    kpm.block_size = 3;
+    auto dos_block =
+        estimate_spectral_density<raw_storage>(Aop_block, N, dos.bounds(), kpm);
+    CHECK_THAT(dos_block.moments().data(),
+               IsCloseTo(dos.moments().data(), kpm.degree + 1));
+
+    CHECK_THROWS(dos.count({1.0, 1.0}));
+    kpm.degree = 0;
+    CHECK_THROWS(estimate_spectral_density<raw_storage>(Aop, N, kpm));
+  }
+
+  SECTION("Memory placement policy") {
+    auto Aop = [&](vcv_t in, vv_t out) { mv_prod(A.get(), in, out, N); };
+
+    solver_t ar(N);
+    CHECK(ar.placement().is_default());
+
+    ezarpack::placement_policy policy(true, ezarpack::NUMAInterleave);
+    ar.set_placement(policy);
+    CHECK(ar.placement().huge_pages);
+    CHECK(ar.placement().numa == ezarpack::NUMAInterleave);
+    testing.standard_eigenproblems(ar, Aop);
+
+    ar.set_placement(
+        ezarpack::placement_policy(false, ezarpack::NUMAFirstTouch));
+    testing.standard_eigenproblems(ar, Aop, 40);
+
+    // Placement advice must not alter contents of the affected memory
+    const int size = 1 << 20;
+    auto buffer = make_buffer<double>(size);
+    for(int i = 0; i < size; ++i)
+      buffer[i] = i;
+    ezarpack::apply_placement(buffer.get(), size, policy);
+    bool intact = true;
+    for(int i = 0; i < size; ++i)
+      intact = intact && (buffer[i] == i);
+    CHECK(intact);
+  }
+
   SECTION("Indirect access to workspace vectors") {
     solver_t ar(N);
 